@@ -0,0 +1,41 @@
+#include "default-config.toml.h"
+unsigned char RESOURCES_CONFIG_DEFAULT_CONFIG_TOML[] = {
+  0x5b, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x5d, 0x0a, 0x20, 0x20, 0x64,
+  0x61, 0x65, 0x6d, 0x6f, 0x6e, 0x20, 0x3d, 0x20, 0x66, 0x61, 0x6c, 0x73,
+  0x65, 0x0a, 0x0a, 0x5b, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x73, 0x5d,
+  0x0a, 0x20, 0x20, 0x5b, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x73, 0x2e,
+  0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x5d, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x64, 0x6f, 0x6d, 0x61, 0x69, 0x6e, 0x20, 0x3d, 0x20, 0x22, 0x6c,
+  0x6f, 0x63, 0x61, 0x6c, 0x68, 0x6f, 0x73, 0x74, 0x22, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x44, 0x69, 0x72, 0x65, 0x63, 0x74,
+  0x6f, 0x72, 0x79, 0x20, 0x3d, 0x20, 0x22, 0x77, 0x77, 0x77, 0x22, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x70, 0x6f, 0x72, 0x74, 0x20, 0x3d, 0x20, 0x38,
+  0x30, 0x38, 0x30, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x69, 0x72, 0x65,
+  0x63, 0x74, 0x6f, 0x72, 0x79, 0x49, 0x6e, 0x64, 0x65, 0x78, 0x20, 0x3d,
+  0x20, 0x5b, 0x22, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d,
+  0x6c, 0x22, 0x2c, 0x20, 0x22, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x2e, 0x73,
+  0x68, 0x22, 0x5d, 0x0a, 0x20, 0x20, 0x5b, 0x73, 0x65, 0x72, 0x76, 0x65,
+  0x72, 0x73, 0x2e, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x54, 0x4c,
+  0x53, 0x5d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x6f, 0x6d, 0x61, 0x69,
+  0x6e, 0x20, 0x3d, 0x20, 0x22, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x68, 0x6f,
+  0x73, 0x74, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x6f, 0x6f, 0x74,
+  0x44, 0x69, 0x72, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x79, 0x20, 0x3d, 0x20,
+  0x22, 0x77, 0x77, 0x77, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x6f,
+  0x72, 0x74, 0x20, 0x3d, 0x20, 0x38, 0x34, 0x34, 0x33, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x79, 0x49,
+  0x6e, 0x64, 0x65, 0x78, 0x20, 0x3d, 0x20, 0x5b, 0x22, 0x69, 0x6e, 0x64,
+  0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x2c, 0x20, 0x22, 0x69,
+  0x6e, 0x64, 0x65, 0x78, 0x2e, 0x73, 0x68, 0x22, 0x5d, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x63, 0x65, 0x72, 0x74, 0x69, 0x66, 0x69, 0x63, 0x61, 0x74,
+  0x65, 0x20, 0x3d, 0x20, 0x22, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x2e,
+  0x63, 0x65, 0x72, 0x74, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x72,
+  0x69, 0x76, 0x61, 0x74, 0x65, 0x4b, 0x65, 0x79, 0x20, 0x3d, 0x20, 0x22,
+  0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x2e, 0x6b, 0x65, 0x79, 0x22, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x6c, 0x69, 0x70, 0x74, 0x69, 0x63,
+  0x43, 0x75, 0x72, 0x76, 0x65, 0x73, 0x20, 0x3d, 0x20, 0x22, 0x50, 0x2d,
+  0x33, 0x38, 0x34, 0x3a, 0x50, 0x2d, 0x35, 0x32, 0x31, 0x22, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x76, 0x61, 0x6c, 0x69, 0x64, 0x61, 0x74, 0x65, 0x43,
+  0x65, 0x72, 0x74, 0x69, 0x66, 0x69, 0x63, 0x61, 0x74, 0x65, 0x20, 0x3d,
+  0x20, 0x66, 0x61, 0x6c, 0x73, 0x65, 0x0a, 0x00
+};
+unsigned int RESOURCES_CONFIG_DEFAULT_CONFIG_TOML_LENGTH = 439;
@@ -0,0 +1,5 @@
+#ifndef buildresourcesconfigdefaultconfigtomlh
+#define buildresourcesconfigdefaultconfigtomlh
+extern unsigned char RESOURCES_CONFIG_DEFAULT_CONFIG_TOML[];
+extern unsigned int RESOURCES_CONFIG_DEFAULT_CONFIG_TOML_LENGTH;
+#endif
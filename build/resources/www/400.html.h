@@ -0,0 +1,5 @@
+#ifndef buildresourceswww400htmlh
+#define buildresourceswww400htmlh
+extern unsigned char RESOURCES_WWW_400_HTML[];
+extern unsigned int RESOURCES_WWW_400_HTML_LENGTH;
+#endif
@@ -0,0 +1,8 @@
+#include "403.html.h"
+unsigned char RESOURCES_WWW_403_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x34, 0x30, 0x33, 0x20, 0x2d, 0x20, 0x46, 0x6f, 0x72,
+  0x62, 0x69, 0x64, 0x64, 0x65, 0x6e, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x0a,
+  0x3c, 0x2f, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_403_HTML_LENGTH = 46;
@@ -0,0 +1,5 @@
+#ifndef buildresourceswww403htmlh
+#define buildresourceswww403htmlh
+extern unsigned char RESOURCES_WWW_403_HTML[];
+extern unsigned int RESOURCES_WWW_403_HTML_LENGTH;
+#endif
@@ -0,0 +1,14 @@
+#include "404.html.h"
+unsigned char RESOURCES_WWW_404_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x34, 0x30, 0x34, 0x20, 0x2d, 0x20, 0x50, 0x61, 0x67,
+  0x65, 0x20, 0x4e, 0x6f, 0x74, 0x20, 0x46, 0x6f, 0x75, 0x6e, 0x64, 0x3c,
+  0x2f, 0x68, 0x31, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x70, 0x3e, 0x54, 0x68,
+  0x65, 0x20, 0x72, 0x65, 0x71, 0x75, 0x65, 0x73, 0x74, 0x65, 0x64, 0x20,
+  0x70, 0x61, 0x67, 0x65, 0x20, 0x3c, 0x69, 0x3e, 0x7b, 0x7b, 0x70, 0x61,
+  0x74, 0x68, 0x7d, 0x7d, 0x3c, 0x2f, 0x69, 0x3e, 0x20, 0x63, 0x6f, 0x75,
+  0x6c, 0x64, 0x20, 0x6e, 0x6f, 0x74, 0x20, 0x62, 0x65, 0x20, 0x66, 0x6f,
+  0x75, 0x6e, 0x64, 0x2e, 0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x3c, 0x2f, 0x63,
+  0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_404_HTML_LENGTH = 115;
@@ -0,0 +1,5 @@
+#ifndef buildresourceswww404htmlh
+#define buildresourceswww404htmlh
+extern unsigned char RESOURCES_WWW_404_HTML[];
+extern unsigned int RESOURCES_WWW_404_HTML_LENGTH;
+#endif
@@ -0,0 +1,9 @@
+#include "413.html.h"
+unsigned char RESOURCES_WWW_413_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x34, 0x31, 0x33, 0x20, 0x2d, 0x20, 0x50, 0x61, 0x79,
+  0x6c, 0x6f, 0x61, 0x64, 0x20, 0x74, 0x6f, 0x6f, 0x20, 0x6c, 0x61, 0x72,
+  0x67, 0x65, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x0a, 0x3c, 0x2f, 0x63, 0x65,
+  0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_413_HTML_LENGTH = 54;
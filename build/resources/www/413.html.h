@@ -0,0 +1,5 @@
+#ifndef buildresourceswww413htmlh
+#define buildresourceswww413htmlh
+extern unsigned char RESOURCES_WWW_413_HTML[];
+extern unsigned int RESOURCES_WWW_413_HTML_LENGTH;
+#endif
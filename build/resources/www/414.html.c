@@ -0,0 +1,9 @@
+#include "414.html.h"
+unsigned char RESOURCES_WWW_414_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x34, 0x31, 0x34, 0x20, 0x2d, 0x20, 0x55, 0x52, 0x49,
+  0x20, 0x54, 0x6f, 0x6f, 0x20, 0x4c, 0x6f, 0x6e, 0x67, 0x3c, 0x2f, 0x68,
+  0x31, 0x3e, 0x0a, 0x3c, 0x2f, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e,
+  0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_414_HTML_LENGTH = 49;
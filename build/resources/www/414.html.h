@@ -0,0 +1,5 @@
+#ifndef buildresourceswww414htmlh
+#define buildresourceswww414htmlh
+extern unsigned char RESOURCES_WWW_414_HTML[];
+extern unsigned int RESOURCES_WWW_414_HTML_LENGTH;
+#endif
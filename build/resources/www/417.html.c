@@ -0,0 +1,9 @@
+#include "417.html.h"
+unsigned char RESOURCES_WWW_417_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x34, 0x31, 0x37, 0x20, 0x2d, 0x20, 0x45, 0x78, 0x70,
+  0x65, 0x63, 0x74, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x46, 0x61, 0x69,
+  0x6c, 0x65, 0x64, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x0a, 0x3c, 0x2f, 0x63,
+  0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_417_HTML_LENGTH = 55;
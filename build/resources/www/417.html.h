@@ -0,0 +1,5 @@
+#ifndef buildresourceswww417htmlh
+#define buildresourceswww417htmlh
+extern unsigned char RESOURCES_WWW_417_HTML[];
+extern unsigned int RESOURCES_WWW_417_HTML_LENGTH;
+#endif
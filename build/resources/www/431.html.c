@@ -0,0 +1,10 @@
+#include "431.html.h"
+unsigned char RESOURCES_WWW_431_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x34, 0x33, 0x31, 0x20, 0x2d, 0x20, 0x52, 0x65, 0x71,
+  0x75, 0x65, 0x73, 0x74, 0x20, 0x48, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20,
+  0x46, 0x69, 0x65, 0x6c, 0x64, 0x73, 0x20, 0x54, 0x6f, 0x6f, 0x20, 0x4c,
+  0x61, 0x72, 0x67, 0x65, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x0a, 0x3c, 0x2f,
+  0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_431_HTML_LENGTH = 68;
@@ -0,0 +1,5 @@
+#ifndef buildresourceswww431htmlh
+#define buildresourceswww431htmlh
+extern unsigned char RESOURCES_WWW_431_HTML[];
+extern unsigned int RESOURCES_WWW_431_HTML_LENGTH;
+#endif
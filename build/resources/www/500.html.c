@@ -0,0 +1,11 @@
+#include "500.html.h"
+unsigned char RESOURCES_WWW_500_HTML[] = {
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+  0x68, 0x31, 0x3e, 0x35, 0x30, 0x30, 0x20, 0x2d, 0x20, 0x49, 0x6e, 0x74,
+  0x65, 0x72, 0x6e, 0x61, 0x6c, 0x20, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72,
+  0x20, 0x45, 0x72, 0x72, 0x6f, 0x72, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x0a,
+  0x20, 0x20, 0x3c, 0x70, 0x3e, 0x7b, 0x7b, 0x64, 0x65, 0x73, 0x63, 0x72,
+  0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x7d, 0x7d, 0x3c, 0x2f, 0x70, 0x3e,
+  0x0a, 0x3c, 0x2f, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_500_HTML_LENGTH = 83;
@@ -0,0 +1,5 @@
+#ifndef buildresourceswww500htmlh
+#define buildresourceswww500htmlh
+extern unsigned char RESOURCES_WWW_500_HTML[];
+extern unsigned int RESOURCES_WWW_500_HTML_LENGTH;
+#endif
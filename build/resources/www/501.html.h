@@ -0,0 +1,5 @@
+#ifndef buildresourceswww501htmlh
+#define buildresourceswww501htmlh
+extern unsigned char RESOURCES_WWW_501_HTML[];
+extern unsigned int RESOURCES_WWW_501_HTML_LENGTH;
+#endif
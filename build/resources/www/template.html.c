@@ -0,0 +1,55 @@
+#include "template.html.h"
+unsigned char RESOURCES_WWW_TEMPLATE_HTML[] = {
+  0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x68, 0x74,
+  0x6d, 0x6c, 0x3e, 0x0a, 0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x20, 0x6c, 0x61,
+  0x6e, 0x67, 0x3d, 0x22, 0x65, 0x6e, 0x22, 0x20, 0x64, 0x69, 0x72, 0x3d,
+  0x22, 0x6c, 0x74, 0x72, 0x22, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x68, 0x65,
+  0x61, 0x64, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x6d, 0x65, 0x74,
+  0x61, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65, 0x74, 0x3d, 0x22, 0x75,
+  0x74, 0x66, 0x2d, 0x38, 0x22, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c,
+  0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x57, 0x53, 0x49, 0x43, 0x3c, 0x2f,
+  0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c,
+  0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x68, 0x31, 0x2c, 0x20, 0x70, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x66, 0x61,
+  0x6d, 0x69, 0x6c, 0x79, 0x3a, 0x20, 0x2d, 0x61, 0x70, 0x70, 0x6c, 0x65,
+  0x2d, 0x73, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x2c, 0x20, 0x42, 0x6c, 0x69,
+  0x6e, 0x6b, 0x4d, 0x61, 0x63, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x46,
+  0x6f, 0x6e, 0x74, 0x2c, 0x20, 0x22, 0x53, 0x65, 0x67, 0x6f, 0x65, 0x20,
+  0x55, 0x49, 0x22, 0x2c, 0x20, 0x52, 0x6f, 0x62, 0x6f, 0x74, 0x6f, 0x2c,
+  0x20, 0x4f, 0x78, 0x79, 0x67, 0x65, 0x6e, 0x2c, 0x20, 0x55, 0x62, 0x75,
+  0x6e, 0x74, 0x75, 0x2c, 0x20, 0x43, 0x61, 0x6e, 0x74, 0x61, 0x72, 0x65,
+  0x6c, 0x6c, 0x2c, 0x20, 0x22, 0x46, 0x69, 0x72, 0x61, 0x20, 0x53, 0x61,
+  0x6e, 0x73, 0x22, 0x2c, 0x20, 0x22, 0x44, 0x72, 0x6f, 0x69, 0x64, 0x20,
+  0x53, 0x61, 0x6e, 0x73, 0x22, 0x2c, 0x20, 0x22, 0x48, 0x65, 0x6c, 0x76,
+  0x65, 0x74, 0x69, 0x63, 0x61, 0x20, 0x4e, 0x65, 0x75, 0x65, 0x22, 0x2c,
+  0x20, 0x41, 0x72, 0x69, 0x61, 0x6c, 0x2c, 0x20, 0x73, 0x61, 0x6e, 0x73,
+  0x2d, 0x73, 0x65, 0x72, 0x69, 0x66, 0x2c, 0x20, 0x22, 0x41, 0x70, 0x70,
+  0x6c, 0x65, 0x20, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x45, 0x6d, 0x6f,
+  0x6a, 0x69, 0x22, 0x2c, 0x20, 0x22, 0x53, 0x65, 0x67, 0x6f, 0x65, 0x20,
+  0x55, 0x49, 0x20, 0x45, 0x6d, 0x6f, 0x6a, 0x69, 0x22, 0x2c, 0x20, 0x22,
+  0x53, 0x65, 0x67, 0x6f, 0x65, 0x20, 0x55, 0x49, 0x20, 0x53, 0x79, 0x6d,
+  0x62, 0x6f, 0x6c, 0x22, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x7d, 0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x6f,
+  0x74, 0x65, 0x72, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x74, 0x6f, 0x70,
+  0x3a, 0x20, 0x31, 0x70, 0x78, 0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20,
+  0x23, 0x44, 0x43, 0x44, 0x43, 0x44, 0x43, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x2f, 0x73,
+  0x74, 0x79, 0x6c, 0x65, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x68, 0x65,
+  0x61, 0x64, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x7b, 0x63, 0x6f, 0x6e, 0x74, 0x65,
+  0x6e, 0x74, 0x7d, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x66, 0x6f,
+  0x6f, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x3c, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x70, 0x3e, 0x57, 0x53, 0x49, 0x43,
+  0x20, 0x7b, 0x7b, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x7d, 0x7d,
+  0x20, 0x2d, 0x20, 0x41, 0x20, 0x57, 0x65, 0x62, 0x20, 0x53, 0x65, 0x72,
+  0x76, 0x65, 0x72, 0x20, 0x77, 0x72, 0x69, 0x74, 0x74, 0x65, 0x6e, 0x20,
+  0x69, 0x6e, 0x20, 0x43, 0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x3c, 0x2f, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3e,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x2f, 0x66, 0x6f, 0x6f, 0x74, 0x65,
+  0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e,
+  0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x00
+};
+unsigned int RESOURCES_WWW_TEMPLATE_HTML_LENGTH = 609;
@@ -0,0 +1,5 @@
+#ifndef buildresourceswwwtemplatehtmlh
+#define buildresourceswwwtemplatehtmlh
+extern unsigned char RESOURCES_WWW_TEMPLATE_HTML[];
+extern unsigned int RESOURCES_WWW_TEMPLATE_HTML_LENGTH;
+#endif
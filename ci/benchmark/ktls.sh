@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+
+# Compare the throughput of large static files served over TLS (port 8443)
+# with and without kernel TLS (kTLS). Requires the kernel's tls module to be
+# loaded (modprobe tls) and an OpenSSL version with kTLS support (3.0+)
+
+# The first parameter is the path to a build of wsic
+wsic="$1"
+
+if [[ -z "$wsic" ]]; then
+  echo -e "\e[31mRequired path to WSIC missing\e[0m"
+  exit 1
+fi
+
+# The size of the file to download in megabytes
+fileSize="${FILE_SIZE:-512}"
+# The number of downloads to perform per test
+downloads="${DOWNLOADS:-10}"
+
+# Clean up on exit
+function cleanup {
+  if [[ ! -z "$wsicPID" ]]; then
+    echo "Killing WSIC"
+    kill "$wsicPID" > /dev/null 2>&1
+  fi
+  rm -f www/ktls-benchmark.bin
+}
+trap cleanup EXIT
+
+# Create report directory
+mkdir -p build/reports/benchmark/ktls
+
+# Create the file to download
+dd if=/dev/urandom of=www/ktls-benchmark.bin bs=1M count="$fileSize" > /dev/null 2>&1
+
+function benchmark {
+  test="$1"
+  kernelTLS="$2"
+
+  echo "Performing test: $test"
+  echo "--------------------------------------"
+
+  # Use the default config with kTLS enabled or disabled for the TLS server
+  sed "s/validateCertificate = false/validateCertificate = false\n    kernelTLS = $kernelTLS/" src/resources/config/default-config.toml > "build/reports/benchmark/ktls/$test.toml"
+
+  # Start wsic in the background
+  $wsic start --config "build/reports/benchmark/ktls/$test.toml" > "build/reports/benchmark/ktls/$test-log.txt" 2>&1 &
+  wsicPID="$!"
+
+  # Wait for WSIC to start
+  echo "Waiting for WSIC to start"
+  sleep 5
+
+  # Download the file and record the average speed in bytes per second for each download
+  rm -f "build/reports/benchmark/ktls/$test.txt"
+  for i in $(seq 1 "$downloads"); do
+    curl --insecure -s -o /dev/null -w '%{speed_download}\n' https://localhost:8443/ktls-benchmark.bin >> "build/reports/benchmark/ktls/$test.txt"
+  done
+
+  # Kill WSIC
+  kill "$wsicPID" > /dev/null 2>&1
+  wsicPID=""
+  sleep 1
+
+  throughput="$(awk '{ sum += $1 } END { if (NR > 0) printf "%.2f", sum / NR / 1048576 }' "build/reports/benchmark/ktls/$test.txt")"
+  echo "Average throughput: $throughput MB/s"
+  echo "--------------------------------------"
+}
+
+benchmark userspace false
+userspaceThroughput="$throughput"
+
+benchmark kernel true
+kernelThroughput="$throughput"
+
+if [[ -z "$userspaceThroughput" ]] || [[ -z "$kernelThroughput" ]]; then
+  echo -e "\e[31mBenchmark failed\e[0m: The downloads did not complete"
+  exit 1
+fi
+
+echo "User-space TLS: $userspaceThroughput MB/s"
+echo "Kernel TLS: $kernelThroughput MB/s"
+echo "User-space TLS: $userspaceThroughput MB/s" > build/reports/benchmark/ktls/report.txt
+echo "Kernel TLS: $kernelThroughput MB/s" >> build/reports/benchmark/ktls/report.txt
@@ -8,6 +8,7 @@
 #include <sys/wait.h>
 
 #include "../logging/logging.h"
+#include "../time/time.h"
 
 #include "cgi.h"
 
@@ -53,6 +54,11 @@ cgi_process_t *cgi_spawn(const char *command, list_t *arguments, hash_table_t *e
   } else if (process->pid == 0) {
     // This is run by the new child process
 
+    // Don't let the script inherit the signals blocked by the worker
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigprocmask(SIG_SETMASK, &signals, 0);
+
     // Try to redirect STDIN
     if (dup2(process->stdin[PIPE_READ], STDIN_FILENO) < 0)
       exit(errno);
@@ -135,8 +141,15 @@ string_t *cgi_read(const cgi_process_t *process, size_t timeout) {
     return 0;
   }
 
-  uint8_t timeouts = 0;
+  uint64_t deadline = time_getMilliseconds() + timeout;
   while (true) {
+    uint64_t now = time_getMilliseconds();
+    if (now >= deadline) {
+      log(LOG_ERROR, "Timed out waiting for the CGI process to respond");
+      string_free(content);
+      return 0;
+    }
+
     // Set up structures necessary for polling
     struct pollfd descriptors[1];
     memset(descriptors, 0, sizeof(struct pollfd));
@@ -146,15 +159,16 @@ string_t *cgi_read(const cgi_process_t *process, size_t timeout) {
     log(LOG_DEBUG, "Waiting for data to be readable");
 
     // Wait for the pipe to be ready to read
-    int status = poll(descriptors, 1, timeout);
+    int status = poll(descriptors, 1, deadline - now);
     if (status <= -1) {
+      // Try again if interrupted by a signal
+      if (errno == EINTR)
+        continue;
       log(LOG_ERROR, "Could not wait for CGI pipe to write data");
       string_free(content);
       return 0;
     } else if (status == 0) {
-      // Try again if the poll timed out
-      if (timeouts++ > 5)
-        return 0;
+      // The deadline has passed
       continue;
     }
 
@@ -17,7 +17,7 @@ typedef struct {
 // Spawn a CGI process. Owns arguments and environment.
 cgi_process_t *cgi_spawn(const char *command, list_t *arguments, hash_table_t *environment) __attribute__((nonnull(1)));
 
-// NOTE: This will the read all available bytes. Will block until the pipe has data to read
+// NOTE: This will the read all available bytes. Will block until the pipe is closed or timeout milliseconds have passed
 string_t *cgi_read(const cgi_process_t *process, size_t timeout) __attribute__((nonnull(1)));
 size_t cgi_write(const cgi_process_t *process, const char *buffer, size_t bufferSize) __attribute__((nonnull(1, 2)));
 // Flush the input to the process (no more writes can occur after this point)
@@ -0,0 +1,286 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#include "../datastructures/hash-table/hash-table.h"
+#include "../logging/logging.h"
+
+#include "client-limits.h"
+
+// The prefix of IPv4 addresses mapped to IPv6 (see client_limits_getAddress)
+static const uint8_t client_limits_mappedIPv4Prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+// Copy the address of a peer as IPv6, mapping IPv4 addresses. Returns false if not an IP address
+bool client_limits_getAddress(const struct sockaddr *address, uint8_t *buffer);
+// Find a client in a locked shard. Returns 0 if not tracked
+client_limits_client_t *client_limits_findClient(client_limits_shard_t *shard, size_t bucket, const uint8_t *address);
+// Forget the least recently seen client without connections of a locked shard. Returns false if all hold connections
+bool client_limits_evictClient(client_limits_shard_t *shard);
+
+client_limits_t *client_limits_create() {
+  client_limits_t *limits = malloc(sizeof(client_limits_t));
+  if (limits == 0) {
+    log(LOG_ERROR, "Failed to allocate client limits");
+    return 0;
+  }
+  memset(limits, 0, sizeof(client_limits_t));
+
+  for (size_t i = 0; i < CLIENT_LIMITS_SHARDS; i++)
+    pthread_mutex_init(&limits->shards[i].mutex, NULL);
+
+  return limits;
+}
+
+bool client_limits_acquireConnection(client_limits_t *limits, const struct sockaddr *address, size_t maxConnections, uint64_t now, client_limits_client_t **client) {
+  *client = 0;
+
+  uint8_t key[CLIENT_LIMITS_ADDRESS_LENGTH];
+  if (!client_limits_getAddress(address, key))
+    return true;
+
+  // A client owning a whole IPv6 prefix could otherwise connect from as many addresses as it likes, each with its own limits
+  if (memcmp(key, client_limits_mappedIPv4Prefix, sizeof(client_limits_mappedIPv4Prefix)) != 0)
+    memset(key + CLIENT_LIMITS_IPV6_PREFIX_LENGTH, 0, CLIENT_LIMITS_ADDRESS_LENGTH - CLIENT_LIMITS_IPV6_PREFIX_LENGTH);
+
+  // The low bits pick the shard, the remaining bits the bucket within it
+  uint32_t hash = hash_table_hashWithLength((const char *)key, CLIENT_LIMITS_ADDRESS_LENGTH);
+  size_t shardIndex = hash & (CLIENT_LIMITS_SHARDS - 1);
+  size_t bucket = (hash / CLIENT_LIMITS_SHARDS) % CLIENT_LIMITS_SHARD_BUCKETS;
+  client_limits_shard_t *shard = &limits->shards[shardIndex];
+
+  pthread_mutex_lock(&shard->mutex);
+  client_limits_client_t *entry = client_limits_findClient(shard, bucket, key);
+  if (entry == 0) {
+    // Letting the client through unlimited would let anyone able to fill a shard switch off the limits of its other clients
+    if (shard->clients >= CLIENT_LIMITS_MAX_CLIENTS_PER_SHARD && !client_limits_evictClient(shard)) {
+      pthread_mutex_unlock(&shard->mutex);
+      __atomic_add_fetch(&limits->rejectedConnections, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+
+    entry = malloc(sizeof(client_limits_client_t));
+    if (entry == 0) {
+      pthread_mutex_unlock(&shard->mutex);
+      __atomic_add_fetch(&limits->untrackedConnections, 1, __ATOMIC_RELAXED);
+      return true;
+    }
+
+    memset(entry, 0, sizeof(client_limits_client_t));
+    memcpy(entry->address, key, CLIENT_LIMITS_ADDRESS_LENGTH);
+    // New clients start with a full bucket (see client_limits_consumeRequest)
+    entry->tokens = -1;
+    entry->lastRefill = now;
+    entry->limits = limits;
+    entry->shard = shardIndex;
+    entry->next = shard->buckets[bucket];
+    shard->buckets[bucket] = entry;
+    shard->clients++;
+  }
+
+  entry->lastSeen = now;
+  if (maxConnections > 0 && entry->connections >= maxConnections) {
+    pthread_mutex_unlock(&shard->mutex);
+    __atomic_add_fetch(&limits->rejectedConnections, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  entry->connections++;
+  pthread_mutex_unlock(&shard->mutex);
+
+  *client = entry;
+  return true;
+}
+
+void client_limits_releaseConnection(client_limits_client_t *client) {
+  client_limits_shard_t *shard = &client->limits->shards[client->shard];
+  pthread_mutex_lock(&shard->mutex);
+  if (client->connections > 0)
+    client->connections--;
+  pthread_mutex_unlock(&shard->mutex);
+}
+
+bool client_limits_consumeRequest(client_limits_client_t *client, size_t rate, size_t burst, uint64_t now) {
+  if (rate == 0)
+    return true;
+  if (burst == 0)
+    burst = rate;
+
+  client_limits_shard_t *shard = &client->limits->shards[client->shard];
+  pthread_mutex_lock(&shard->mutex);
+  if (client->tokens < 0) {
+    client->tokens = (double)burst;
+  } else if (now > client->lastRefill) {
+    client->tokens += (double)(now - client->lastRefill) * (double)rate / 1000.0;
+    if (client->tokens > (double)burst)
+      client->tokens = (double)burst;
+  }
+  client->lastRefill = now;
+  client->lastSeen = now;
+
+  bool hasToken = client->tokens >= 1.0;
+  if (hasToken)
+    client->tokens -= 1.0;
+  pthread_mutex_unlock(&shard->mutex);
+
+  if (!hasToken)
+    __atomic_add_fetch(&client->limits->rejectedRequests, 1, __ATOMIC_RELAXED);
+  return hasToken;
+}
+
+size_t client_limits_expire(client_limits_t *limits, uint64_t now) {
+  size_t expiredClients = 0;
+  for (size_t i = 0; i < CLIENT_LIMITS_SHARDS; i++) {
+    client_limits_shard_t *shard = &limits->shards[i];
+    pthread_mutex_lock(&shard->mutex);
+    for (size_t j = 0; j < CLIENT_LIMITS_SHARD_BUCKETS && shard->clients > 0; j++) {
+      client_limits_client_t **link = &shard->buckets[j];
+      while (*link != 0) {
+        client_limits_client_t *client = *link;
+        if (client->connections == 0 && now - client->lastSeen >= CLIENT_LIMITS_IDLE_TIME) {
+          *link = client->next;
+          free(client);
+          shard->clients--;
+          expiredClients++;
+        } else {
+          link = &client->next;
+        }
+      }
+    }
+    pthread_mutex_unlock(&shard->mutex);
+  }
+
+  return expiredClients;
+}
+
+size_t client_limits_getClients(client_limits_t *limits) {
+  size_t clients = 0;
+  for (size_t i = 0; i < CLIENT_LIMITS_SHARDS; i++) {
+    pthread_mutex_lock(&limits->shards[i].mutex);
+    clients += limits->shards[i].clients;
+    pthread_mutex_unlock(&limits->shards[i].mutex);
+  }
+
+  return clients;
+}
+
+void client_limits_free(client_limits_t *limits) {
+  for (size_t i = 0; i < CLIENT_LIMITS_SHARDS; i++) {
+    client_limits_shard_t *shard = &limits->shards[i];
+    for (size_t j = 0; j < CLIENT_LIMITS_SHARD_BUCKETS; j++) {
+      client_limits_client_t *client = shard->buckets[j];
+      while (client != 0) {
+        client_limits_client_t *next = client->next;
+        free(client);
+        client = next;
+      }
+    }
+    pthread_mutex_destroy(&shard->mutex);
+  }
+
+  free(limits);
+}
+
+bool client_limits_parseNetwork(const char *string, client_limits_network_t *network) {
+  char address[INET6_ADDRSTRLEN];
+  const char *slash = strchr(string, '/');
+  size_t addressLength = slash == 0 ? strlen(string) : (size_t)(slash - string);
+  if (addressLength == 0 || addressLength >= sizeof(address))
+    return false;
+  memcpy(address, string, addressLength);
+  address[addressLength] = 0;
+
+  memset(network, 0, sizeof(client_limits_network_t));
+  size_t maxPrefixLength = 128;
+  struct in_addr ipv4;
+  if (inet_pton(AF_INET, address, &ipv4) == 1) {
+    network->address[10] = 0xff;
+    network->address[11] = 0xff;
+    memcpy(network->address + 12, &ipv4, sizeof(ipv4));
+    maxPrefixLength = 32;
+  } else if (inet_pton(AF_INET6, address, network->address) != 1) {
+    return false;
+  }
+
+  size_t prefixLength = maxPrefixLength;
+  if (slash != 0) {
+    const char *digits = slash + 1;
+    if (*digits == 0)
+      return false;
+    prefixLength = 0;
+    for (; *digits != 0; digits++) {
+      if (*digits < '0' || *digits > '9')
+        return false;
+      prefixLength = prefixLength * 10 + (size_t)(*digits - '0');
+      if (prefixLength > maxPrefixLength)
+        return false;
+    }
+  }
+
+  // IPv4 prefixes are relative to the mapped address
+  network->prefixLength = (uint8_t)(prefixLength + 128 - maxPrefixLength);
+  return true;
+}
+
+bool client_limits_isAllowed(const client_limits_network_t *networks, size_t count, const struct sockaddr *address) {
+  uint8_t key[CLIENT_LIMITS_ADDRESS_LENGTH];
+  if (count == 0 || !client_limits_getAddress(address, key))
+    return false;
+
+  for (size_t i = 0; i < count; i++) {
+    size_t bytes = networks[i].prefixLength / 8;
+    size_t bits = networks[i].prefixLength % 8;
+    if (memcmp(networks[i].address, key, bytes) != 0)
+      continue;
+    if (bits > 0) {
+      uint8_t mask = (uint8_t)(0xff << (8 - bits));
+      if ((networks[i].address[bytes] & mask) != (key[bytes] & mask))
+        continue;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+bool client_limits_getAddress(const struct sockaddr *address, uint8_t *buffer) {
+  if (address->sa_family == AF_INET) {
+    memset(buffer, 0, CLIENT_LIMITS_ADDRESS_LENGTH);
+    buffer[10] = 0xff;
+    buffer[11] = 0xff;
+    memcpy(buffer + 12, &((const struct sockaddr_in *)address)->sin_addr, 4);
+    return true;
+  } else if (address->sa_family == AF_INET6) {
+    memcpy(buffer, &((const struct sockaddr_in6 *)address)->sin6_addr, CLIENT_LIMITS_ADDRESS_LENGTH);
+    return true;
+  }
+
+  return false;
+}
+
+client_limits_client_t *client_limits_findClient(client_limits_shard_t *shard, size_t bucket, const uint8_t *address) {
+  for (client_limits_client_t *client = shard->buckets[bucket]; client != 0; client = client->next) {
+    if (memcmp(client->address, address, CLIENT_LIMITS_ADDRESS_LENGTH) == 0)
+      return client;
+  }
+
+  return 0;
+}
+
+bool client_limits_evictClient(client_limits_shard_t *shard) {
+  client_limits_client_t **evictedLink = 0;
+  for (size_t i = 0; i < CLIENT_LIMITS_SHARD_BUCKETS; i++) {
+    for (client_limits_client_t **link = &shard->buckets[i]; *link != 0; link = &(*link)->next) {
+      if ((*link)->connections == 0 && (evictedLink == 0 || (*link)->lastSeen < (*evictedLink)->lastSeen))
+        evictedLink = link;
+    }
+  }
+
+  if (evictedLink == 0)
+    return false;
+
+  client_limits_client_t *client = *evictedLink;
+  *evictedLink = client->next;
+  free(client);
+  shard->clients--;
+  return true;
+}
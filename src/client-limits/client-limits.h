@@ -0,0 +1,91 @@
+#ifndef CLIENT_LIMITS_H
+#define CLIENT_LIMITS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+
+/**
+* Per-client accounting of a server instance, keyed by the peer's IPv4 address or the /64 prefix of its IPv6 address.
+* The table is split into shards, each with its own lock, so that the main thread accepting connections
+* and the workers handling requests rarely contend. Every operation is a single bucket lookup.
+* A client tracks its number of open connections and a token bucket limiting its rate of requests.
+*/
+
+// The number of shards (a power of two) and the number of buckets of each shard
+#define CLIENT_LIMITS_SHARDS 64
+#define CLIENT_LIMITS_SHARD_BUCKETS 256
+// The maximum number of clients tracked by each shard. Once full, the least recently seen client without connections
+// is forgotten to make room for a new one. If every client holds connections, new clients are refused
+#define CLIENT_LIMITS_MAX_CLIENTS_PER_SHARD 1024
+// The time in milliseconds a client without connections is remembered (see client_limits_expire)
+#define CLIENT_LIMITS_IDLE_TIME 60000
+// IPv4 addresses are stored mapped to IPv6 (::ffff:0:0/96)
+#define CLIENT_LIMITS_ADDRESS_LENGTH 16
+// The number of leading bytes of an IPv6 address identifying a client. A single client is usually assigned a whole /64
+#define CLIENT_LIMITS_IPV6_PREFIX_LENGTH 8
+
+// An address and the number of leading bits to match, such as 10.0.0.0/8 (see client_limits_parseNetwork)
+typedef struct {
+  uint8_t address[CLIENT_LIMITS_ADDRESS_LENGTH];
+  uint8_t prefixLength;
+} client_limits_network_t;
+
+typedef struct client_limits_client_t {
+  uint8_t address[CLIENT_LIMITS_ADDRESS_LENGTH];
+  // The number of open connections
+  size_t connections;
+  // The number of requests the client may make right away, refilled over time
+  double tokens;
+  // The time in milliseconds tokens were last added
+  uint64_t lastRefill;
+  // The time in milliseconds the client last connected or made a request
+  uint64_t lastSeen;
+  struct client_limits_t *limits;
+  size_t shard;
+  struct client_limits_client_t *next;
+} client_limits_client_t;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  client_limits_client_t *buckets[CLIENT_LIMITS_SHARD_BUCKETS];
+  size_t clients;
+} client_limits_shard_t;
+
+typedef struct client_limits_t {
+  client_limits_shard_t shards[CLIENT_LIMITS_SHARDS];
+
+  // Metrics, updated atomically
+  // The number of connections refused as the client had too many open connections
+  size_t rejectedConnections;
+  // The number of requests refused as the client made requests too quickly
+  size_t rejectedRequests;
+  // The number of connections not limited as the client could not be tracked
+  size_t untrackedConnections;
+} client_limits_t;
+
+client_limits_t *client_limits_create();
+// Account a new connection of a client, refusing it if the client already has maxConnections open connections
+// (0 if not limited) or if its shard is full of clients holding connections. Sets client to the accounting to release once the connection is closed, or 0 if the client
+// is not tracked. Returns false if the connection is refused
+bool client_limits_acquireConnection(client_limits_t *limits, const struct sockaddr *address, size_t maxConnections, uint64_t now, client_limits_client_t **client) __attribute__((nonnull(1, 2, 5)));
+// Account a closed connection of a client
+void client_limits_releaseConnection(client_limits_client_t *client) __attribute__((nonnull(1)));
+// Take a token for a request from the client's bucket, which holds at most burst tokens and is refilled with rate
+// tokens per second. Returns false if the bucket is empty, in which case the request should be refused
+bool client_limits_consumeRequest(client_limits_client_t *client, size_t rate, size_t burst, uint64_t now) __attribute__((nonnull(1)));
+// Forget clients without connections that have not been seen for CLIENT_LIMITS_IDLE_TIME. Returns the number of clients forgotten
+size_t client_limits_expire(client_limits_t *limits, uint64_t now) __attribute__((nonnull(1)));
+// Get the number of tracked clients
+size_t client_limits_getClients(client_limits_t *limits) __attribute__((nonnull(1)));
+// Free the table. Any remaining accountings must not be released afterwards
+void client_limits_free(client_limits_t *limits) __attribute__((nonnull(1)));
+
+// Parse an IPv4 or IPv6 address with an optional prefix length, such as "10.0.0.0/8" or "::1". Returns false if invalid
+bool client_limits_parseNetwork(const char *string, client_limits_network_t *network) __attribute__((nonnull(1, 2)));
+// Whether or not the address is part of any of the networks
+bool client_limits_isAllowed(const client_limits_network_t *networks, size_t count, const struct sockaddr *address) __attribute__((nonnull(3)));
+
+#endif
@@ -0,0 +1,248 @@
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "../logging/logging.h"
+
+#include "compression.h"
+
+static compression_cache_t *compression_globalCache = 0;
+static pthread_once_t compression_globalCacheOnce = PTHREAD_ONCE_INIT;
+
+// Create the global cache (see pthread_once)
+void compression_createGlobalCache();
+// Find a cached entry matching the file. The cache must be locked
+compression_entry_t *compression_findEntry(compression_cache_t *cache, const struct stat *info);
+// Remove an entry from the list of entries. The cache must be locked
+void compression_unlinkEntry(compression_cache_t *cache, compression_entry_t *entry);
+// Read and compress a file. Returns 0 if failed
+compression_entry_t *compression_createEntry(const char *filePath, const struct stat *info);
+
+compression_cache_t *compression_createCache(size_t capacity) {
+  compression_cache_t *cache = malloc(sizeof(compression_cache_t));
+  if (cache == 0) {
+    log(LOG_ERROR, "Failed to allocate compression cache");
+    return 0;
+  }
+
+  memset(cache, 0, sizeof(compression_cache_t));
+  cache->capacity = capacity;
+
+  if (pthread_mutex_init(&cache->mutex, NULL) != 0) {
+    log(LOG_ERROR, "Failed to create mutex for compression cache");
+    free(cache);
+    return 0;
+  }
+
+  return cache;
+}
+
+compression_entry_t *compression_getGzip(compression_cache_t *cache, const char *filePath, const struct stat *info) {
+  compression_entry_t *entry = compression_getCachedGzip(cache, info);
+  if (entry != 0)
+    return entry;
+
+  pthread_mutex_lock(&cache->mutex);
+  cache->misses++;
+  pthread_mutex_unlock(&cache->mutex);
+
+  // Compress without holding the lock. Threads racing for the same file may compress it more than once
+  entry = compression_createEntry(filePath, info);
+  if (entry == 0)
+    return 0;
+
+  // Copies too large for the cache are only used by the caller
+  entry->references = 1;
+  if (entry->length > cache->capacity)
+    return entry;
+
+  pthread_mutex_lock(&cache->mutex);
+  compression_entry_t *existingEntry = compression_findEntry(cache, info);
+  if (existingEntry != 0) {
+    // Another thread compressed the file first
+    pthread_mutex_unlock(&cache->mutex);
+    return entry;
+  }
+
+  // Evict the least recently used copies to make room
+  while (cache->last != 0 && cache->size + entry->length > cache->capacity) {
+    compression_entry_t *evictedEntry = cache->last;
+    compression_unlinkEntry(cache, evictedEntry);
+    cache->size -= evictedEntry->length;
+    compression_releaseEntry(evictedEntry);
+  }
+
+  entry->next = cache->first;
+  if (cache->first != 0)
+    cache->first->previous = entry;
+  cache->first = entry;
+  if (cache->last == 0)
+    cache->last = entry;
+  cache->size += entry->length;
+  // Held by both the cache and the caller
+  entry->references = 2;
+  pthread_mutex_unlock(&cache->mutex);
+
+  return entry;
+}
+
+compression_entry_t *compression_getCachedGzip(compression_cache_t *cache, const struct stat *info) {
+  pthread_mutex_lock(&cache->mutex);
+  compression_entry_t *entry = compression_findEntry(cache, info);
+  if (entry != 0) {
+    // Move the entry to the front as it's the most recently used
+    compression_unlinkEntry(cache, entry);
+    entry->next = cache->first;
+    if (cache->first != 0)
+      cache->first->previous = entry;
+    cache->first = entry;
+    if (cache->last == 0)
+      cache->last = entry;
+    __atomic_add_fetch(&entry->references, 1, __ATOMIC_ACQ_REL);
+    cache->hits++;
+  }
+  pthread_mutex_unlock(&cache->mutex);
+
+  return entry;
+}
+
+void compression_releaseEntry(compression_entry_t *entry) {
+  if (__atomic_sub_fetch(&entry->references, 1, __ATOMIC_ACQ_REL) > 0)
+    return;
+
+  free(entry->data);
+  free(entry);
+}
+
+void compression_freeCache(compression_cache_t *cache) {
+  compression_entry_t *entry = cache->first;
+  while (entry != 0) {
+    compression_entry_t *next = entry->next;
+    compression_releaseEntry(entry);
+    entry = next;
+  }
+
+  pthread_mutex_destroy(&cache->mutex);
+  free(cache);
+}
+
+compression_cache_t *compression_getGlobalCache() {
+  pthread_once(&compression_globalCacheOnce, compression_createGlobalCache);
+  return compression_globalCache;
+}
+
+char *compression_gzip(const char *buffer, size_t size, size_t *compressedSize) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  // 15 bits of window, + 16 for a gzip header and trailer
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    log(LOG_ERROR, "Failed to initialize gzip compression");
+    return 0;
+  }
+
+  size_t bound = deflateBound(&stream, size);
+  char *compressed = malloc(bound);
+  if (compressed == 0) {
+    log(LOG_ERROR, "Failed to allocate buffer for compression");
+    deflateEnd(&stream);
+    return 0;
+  }
+
+  stream.next_in = (Bytef *)buffer;
+  stream.avail_in = size;
+  stream.next_out = (Bytef *)compressed;
+  stream.avail_out = bound;
+  int status = deflate(&stream, Z_FINISH);
+  *compressedSize = stream.total_out;
+  deflateEnd(&stream);
+
+  if (status != Z_STREAM_END) {
+    log(LOG_ERROR, "Failed to compress buffer - got status %d", status);
+    free(compressed);
+    return 0;
+  }
+
+  return compressed;
+}
+
+void compression_createGlobalCache() {
+  compression_globalCache = compression_createCache(COMPRESSION_CACHE_SIZE);
+}
+
+compression_entry_t *compression_findEntry(compression_cache_t *cache, const struct stat *info) {
+  for (compression_entry_t *entry = cache->first; entry != 0; entry = entry->next) {
+    if (entry->inode == info->st_ino && entry->device == info->st_dev && entry->size == info->st_size && entry->modificationTime == info->st_mtime)
+      return entry;
+  }
+
+  return 0;
+}
+
+void compression_unlinkEntry(compression_cache_t *cache, compression_entry_t *entry) {
+  if (entry->previous != 0)
+    entry->previous->next = entry->next;
+  else
+    cache->first = entry->next;
+
+  if (entry->next != 0)
+    entry->next->previous = entry->previous;
+  else
+    cache->last = entry->previous;
+
+  entry->previous = 0;
+  entry->next = 0;
+}
+
+compression_entry_t *compression_createEntry(const char *filePath, const struct stat *info) {
+  int file = open(filePath, O_RDONLY);
+  if (file == -1) {
+    log(LOG_ERROR, "Could not open file '%s' for compression", filePath);
+    return 0;
+  }
+
+  size_t size = info->st_size;
+  char *buffer = malloc(size == 0 ? 1 : size);
+  if (buffer == 0) {
+    log(LOG_ERROR, "Failed to allocate buffer for file '%s'", filePath);
+    close(file);
+    return 0;
+  }
+
+  size_t bytesRead = 0;
+  while (bytesRead < size) {
+    ssize_t chunkSize = pread(file, buffer + bytesRead, size - bytesRead, bytesRead);
+    if (chunkSize <= 0)
+      break;
+    bytesRead += chunkSize;
+  }
+  close(file);
+
+  // The file changed while reading it
+  if (bytesRead != size) {
+    log(LOG_ERROR, "Could only read %zu (out of %zu) bytes of file '%s' for compression", bytesRead, size, filePath);
+    free(buffer);
+    return 0;
+  }
+
+  compression_entry_t *entry = malloc(sizeof(compression_entry_t));
+  if (entry == 0) {
+    free(buffer);
+    return 0;
+  }
+  memset(entry, 0, sizeof(compression_entry_t));
+
+  entry->data = compression_gzip(buffer, size, &entry->length);
+  free(buffer);
+  if (entry->data == 0) {
+    free(entry);
+    return 0;
+  }
+
+  entry->device = info->st_dev;
+  entry->inode = info->st_ino;
+  entry->size = info->st_size;
+  entry->modificationTime = info->st_mtime;
+  log(LOG_DEBUG, "Compressed '%s' from %zu to %zu bytes", filePath, size, entry->length);
+  return entry;
+}
@@ -0,0 +1,63 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+/**
+* Compresses static files with gzip and keeps the compressed copies in a cache bounded by size.
+* Copies are keyed by the identity of the file (device and inode) and its size and modification time,
+* so a changed file is compressed anew. The cache is shared by all threads of the process.
+*/
+
+// The maximum number of bytes of compressed copies kept
+#define COMPRESSION_CACHE_SIZE 33554432
+// Files smaller than this are not worth compressing
+#define COMPRESSION_MIN_FILE_SIZE 256
+// Files larger than this are not compressed on the fly
+#define COMPRESSION_MAX_FILE_SIZE 4194304
+
+typedef struct compression_entry_t {
+  dev_t device;
+  ino_t inode;
+  off_t size;
+  time_t modificationTime;
+  char *data;
+  size_t length;
+  // The number of holders of the entry, including the cache. Freed when it reaches 0
+  size_t references;
+  struct compression_entry_t *previous;
+  struct compression_entry_t *next;
+} compression_entry_t;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  // Most recently used first
+  compression_entry_t *first;
+  compression_entry_t *last;
+  size_t capacity;
+  size_t size;
+  // Statistics, for debugging purposes
+  size_t hits;
+  size_t misses;
+} compression_cache_t;
+
+compression_cache_t *compression_createCache(size_t capacity);
+// Get the gzip compressed copy of a file, compressing it if it's not cached. The info must be that of the file.
+// Returns 0 if the file could not be compressed. The entry must be released (see compression_releaseEntry)
+compression_entry_t *compression_getGzip(compression_cache_t *cache, const char *filePath, const struct stat *info) __attribute__((nonnull(1, 2, 3)));
+// Get the cached gzip compressed copy of a file without compressing it. Returns 0 if not cached.
+// The entry must be released (see compression_releaseEntry)
+compression_entry_t *compression_getCachedGzip(compression_cache_t *cache, const struct stat *info) __attribute__((nonnull(1, 2)));
+void compression_releaseEntry(compression_entry_t *entry) __attribute__((nonnull(1)));
+void compression_freeCache(compression_cache_t *cache) __attribute__((nonnull(1)));
+
+// Get the cache of the process, creating it if necessary
+compression_cache_t *compression_getGlobalCache();
+
+// Compress a buffer with gzip. Returns the compressed buffer (to be freed) or 0 if failed
+char *compression_gzip(const char *buffer, size_t size, size_t *compressedSize) __attribute__((nonnull(1, 3)));
+
+#endif
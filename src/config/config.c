@@ -1,27 +1,145 @@
+#include <ctype.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "../logging/logging.h"
+#include "../resources/mime.h"
+#include "../resources/resources.h"
 
 #include "config.h"
 
 static config_t *config_globalConfig = 0;
+// Guards the global config and the reference counts of configs
+static pthread_mutex_t config_globalConfigMutex = PTHREAD_MUTEX_INITIALIZER;
+
+config_t *config_parseWithPreviousConfig(const char *configString, const config_t *previousConfig);
+// Free a table parsed by config_parseExtensionTable
+void config_freeExtensionTable(hash_table_t *table);
+// Read the Diffie Hellman parameters file of a server, if set. Returns false if it could not be read
+bool config_parseDiffieHellmanParameters(server_config_t *config, const toml_table_t *serverTable);
+
+// The number of online processors, used as the default number of instances
+size_t config_getNumberOfProcessors() {
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  return processors < 1 ? 1 : (size_t)processors;
+}
 
 config_t *config_getGlobalConfig() {
   return config_globalConfig;
 }
 
 void config_setGlobalConfig(config_t *config) {
+  pthread_mutex_lock(&config_globalConfigMutex);
+  config_t *previousConfig = config_globalConfig;
+  config->references++;
   config_globalConfig = config;
+  pthread_mutex_unlock(&config_globalConfigMutex);
+
+  // The previous config is freed once the last holder releases it
+  if (previousConfig != 0 && previousConfig != config)
+    config_releaseConfig(previousConfig);
 }
 
 void config_freeGlobalConfig() {
-  if (config_globalConfig != 0)
-    config_free(config_globalConfig);
+  pthread_mutex_lock(&config_globalConfigMutex);
+  config_t *config = config_globalConfig;
+  config_globalConfig = 0;
+  pthread_mutex_unlock(&config_globalConfigMutex);
+
+  if (config != 0)
+    config_releaseConfig(config);
+}
+
+config_t *config_acquireGlobalConfig() {
+  pthread_mutex_lock(&config_globalConfigMutex);
+  config_t *config = config_globalConfig;
+  if (config != 0)
+    config->references++;
+  pthread_mutex_unlock(&config_globalConfigMutex);
+
+  return config;
+}
+
+void config_releaseConfig(config_t *config) {
+  pthread_mutex_lock(&config_globalConfigMutex);
+  bool isUnused = --config->references == 0;
+  pthread_mutex_unlock(&config_globalConfigMutex);
+
+  if (isUnused)
+    config_free(config);
+}
+
+bool config_reloadGlobalConfig() {
+  config_t *previousConfig = config_acquireGlobalConfig();
+  if (previousConfig == 0)
+    return false;
+
+  string_t *filePath = config_getFilePath(previousConfig);
+  if (filePath == 0) {
+    log(LOG_WARNING, "The config was not read from a file - nothing to reload");
+    config_releaseConfig(previousConfig);
+    return false;
+  }
+
+  string_t *configFile = resources_loadFile(filePath);
+  if (configFile == 0) {
+    log(LOG_ERROR, "Unable to read config file '%s' - keeping the current config", string_getBuffer(filePath));
+    config_releaseConfig(previousConfig);
+    return false;
+  }
+
+  config_t *config = config_reload(string_getBuffer(configFile), previousConfig);
+  string_free(configFile);
+  config_releaseConfig(previousConfig);
+  if (config == 0) {
+    log(LOG_ERROR, "Unable to parse config file - keeping the current config");
+    return false;
+  }
+
+  config_setGlobalConfig(config);
+  return true;
 }
 
 config_t *config_parse(const char *configString) {
+  return config_parseWithPreviousConfig(configString, 0);
+}
+
+config_t *config_reload(const char *configString, const config_t *previousConfig) {
+  config_t *config = config_parseWithPreviousConfig(configString, previousConfig);
+  if (config == 0)
+    return 0;
+
+  // The settings of the [server] table are only read at start (including overrides from arguments). Timeouts and admission limits may change
+  config->daemon = previousConfig->daemon;
+  config->loggingLevel = previousConfig->loggingLevel;
+  config->threads = previousConfig->threads;
+  config->minThreads = previousConfig->minThreads;
+  config->backlog = previousConfig->backlog;
+  config->instances = previousConfig->instances;
+  config->ioUring = previousConfig->ioUring;
+  config_setLogfile(config, previousConfig->logfile == 0 ? 0 : string_copy(previousConfig->logfile));
+  if (previousConfig->filePath != 0)
+    config_setFilePath(config, string_copy(previousConfig->filePath));
+
+  // The ports are bound at start
+  for (size_t i = 0; i < config_getServers(config); i++) {
+    server_config_t *serverConfig = config_getServerConfig(config, i);
+    bool isBound = false;
+    for (size_t j = 0; j < config_getServers(previousConfig) && !isBound; j++)
+      isBound = config_getPort(config_getServerConfig(previousConfig, j)) == config_getPort(serverConfig);
+    if (!isBound)
+      log(LOG_WARNING, "Configuration '%s' uses port %d which is not listened to. Restart the server to listen to new ports", string_getBuffer(serverConfig->name), config_getPort(serverConfig));
+  }
+
+  return config;
+}
+
+config_t *config_parseWithPreviousConfig(const char *configString, const config_t *previousConfig) {
   char parseError[200];
   toml_table_t *toml = toml_parse((char *)configString, parseError, sizeof(parseError));
   if (toml == 0) {
@@ -42,6 +160,15 @@ config_t *config_parse(const char *configString) {
     return 0;
   }
 
+  config->headerTimeout = CONFIG_DEFAULT_HEADER_TIMEOUT;
+  config->bodyTimeout = CONFIG_DEFAULT_BODY_TIMEOUT;
+  config->minBodyRate = CONFIG_DEFAULT_MIN_BODY_RATE;
+  config->writeTimeout = CONFIG_DEFAULT_WRITE_TIMEOUT;
+  config->cgiTimeout = CONFIG_DEFAULT_CGI_TIMEOUT;
+  config->queueTimeout = CONFIG_DEFAULT_QUEUE_TIMEOUT;
+  config->maxQueuedConnections = CONFIG_DEFAULT_MAX_QUEUED_CONNECTIONS;
+  config->ioUring = -1;
+
   // Parse the server table if it exists
   toml_table_t *serverTable = toml_table_in(toml, "server");
   if (serverTable != 0) {
@@ -66,6 +193,23 @@ config_t *config_parse(const char *configString) {
       config->threads = 32;
     }
 
+    if (toml_raw_in(serverTable, "minThreads") != 0) {
+      int64_t rawMinThreads = config_parseInt(serverTable, "minThreads");
+      if (rawMinThreads < 1) {
+        log(LOG_WARNING, "Too few minimum threads specified in server config - using default");
+        config->minThreads = 4;
+      } else {
+        config->minThreads = rawMinThreads;
+      }
+    } else {
+      config->minThreads = 4;
+    }
+
+    if (config->minThreads > config->threads) {
+      log(LOG_WARNING, "The minimum number of threads is larger than the maximum - using the maximum");
+      config->minThreads = config->threads;
+    }
+
     if (toml_raw_in(serverTable, "backlog") != 0) {
       int64_t rawBacklog = config_parseInt(serverTable, "backlog");
       if (rawBacklog <= 1) {
@@ -80,8 +224,51 @@ config_t *config_parse(const char *configString) {
     } else {
       config->backlog = SOMAXCONN;
     }
+
+    if (toml_raw_in(serverTable, "instances") != 0) {
+      int64_t rawInstances = config_parseInt(serverTable, "instances");
+      if (rawInstances < 1) {
+        log(LOG_WARNING, "Too few instances specified in server config - using default");
+        config->instances = config_getNumberOfProcessors();
+      } else {
+        config->instances = rawInstances;
+      }
+    } else {
+      config->instances = config_getNumberOfProcessors();
+    }
+
+    config->ioUring = config_parseBool(serverTable, "ioUring");
+
+    config->headerTimeout = config_parseTimeout(serverTable, "headerTimeout", CONFIG_DEFAULT_HEADER_TIMEOUT);
+    config->bodyTimeout = config_parseTimeout(serverTable, "bodyTimeout", CONFIG_DEFAULT_BODY_TIMEOUT);
+    config->writeTimeout = config_parseTimeout(serverTable, "writeTimeout", CONFIG_DEFAULT_WRITE_TIMEOUT);
+    config->cgiTimeout = config_parseTimeout(serverTable, "cgiTimeout", CONFIG_DEFAULT_CGI_TIMEOUT);
+    config->queueTimeout = config_parseTimeout(serverTable, "queueTimeout", CONFIG_DEFAULT_QUEUE_TIMEOUT);
+    if (toml_raw_in(serverTable, "minBodyRate") != 0)
+      config->minBodyRate = config_parseNonNegativeInt(serverTable, "minBodyRate");
+
+    if (toml_raw_in(serverTable, "maxQueuedConnections") != 0) {
+      int64_t rawMaxQueuedConnections = config_parseInt(serverTable, "maxQueuedConnections");
+      if (rawMaxQueuedConnections < 1) {
+        log(LOG_WARNING, "Too few queued connections specified in server config - using default");
+        config->maxQueuedConnections = CONFIG_DEFAULT_MAX_QUEUED_CONNECTIONS;
+      } else {
+        config->maxQueuedConnections = rawMaxQueuedConnections;
+      }
+    }
+
+    config->maxCGIRequests = config_parseNonNegativeInt(serverTable, "maxCGIRequests");
+
+    config->maxClientConnections = config_parseNonNegativeInt(serverTable, "maxClientConnections");
+    config->clientRequestRate = config_parseNonNegativeInt(serverTable, "clientRequestRate");
+    config->clientRequestBurst = config_parseNonNegativeInt(serverTable, "clientRequestBurst");
+    config->clientAllowList = config_parseNetworks(serverTable, "clientAllowList", &config->clientAllowListLength);
   }
 
+  toml_table_t *mimeTypesTable = toml_table_in(toml, "mimeTypes");
+  if (mimeTypesTable != 0)
+    config->mimeTypes = config_parseExtensionTable(mimeTypesTable);
+
   toml_table_t *serversTable = toml_table_in(toml, "servers");
   if (serversTable == 0) {
     log(LOG_WARNING, "Missing table 'servers' - no server will be enabled");
@@ -94,7 +281,7 @@ config_t *config_parse(const char *configString) {
       if (serverTable == 0) {
         log(LOG_ERROR, "Got a corrupt server table when parsing config");
       } else {
-        server_config_t *serverConfig = config_parseServerTable(serverTable);
+        server_config_t *serverConfig = config_parseServerTable(serverTable, previousConfig);
         if (serverConfig == 0) {
           log(LOG_ERROR, "Could not parse server config %d", i + 1);
           continue;
@@ -131,7 +318,7 @@ config_t *config_parse(const char *configString) {
   return config;
 }
 
-server_config_t *config_parseServerTable(const toml_table_t *serverTable) {
+server_config_t *config_parseServerTable(const toml_table_t *serverTable, const config_t *previousConfig) {
   server_config_t *config = malloc(sizeof(server_config_t));
   if (config == 0)
     return 0;
@@ -155,6 +342,8 @@ server_config_t *config_parseServerTable(const toml_table_t *serverTable) {
     free(absolutePathBuffer);
   }
   config->enabled = config_parseBool(serverTable, "enabled");
+  config->kernelTLS = config_parseBool(serverTable, "kernelTLS");
+  config->compress = config_parseBool(serverTable, "compress");
 
   if (toml_raw_in((toml_table_t *)serverTable, "port") != 0) {
     int64_t port = config_parseInt(serverTable, "port");
@@ -166,8 +355,26 @@ server_config_t *config_parseServerTable(const toml_table_t *serverTable) {
     config->port = port;
   }
 
+  config->deferAccept = config_parseNonNegativeInt(serverTable, "deferAccept");
+  config->fastOpen = config_parseNonNegativeInt(serverTable, "fastOpen");
+
   config->directoryIndex = config_parseArray(serverTable, "directoryIndex");
 
+  // Either a value for all static files or a table of values by extension
+  toml_table_t *cacheControlTable = toml_table_in((toml_table_t *)serverTable, "cacheControl");
+  if (cacheControlTable != 0) {
+    config->cacheControl = config_parseExtensionTable(cacheControlTable);
+  } else if (toml_raw_in((toml_table_t *)serverTable, "cacheControl") != 0) {
+    string_t *cacheControl = config_parseString(serverTable, "cacheControl");
+    if (cacheControl != 0) {
+      config->cacheControl = hash_table_create();
+      if (config->cacheControl != 0)
+        hash_table_setValue(config->cacheControl, string_fromBuffer("*"), cacheControl);
+      else
+        string_free(cacheControl);
+    }
+  }
+
   string_t *privateKey = config_parseString(serverTable, "privateKey");
   string_t *certificate = config_parseString(serverTable, "certificate");
 
@@ -182,6 +389,24 @@ server_config_t *config_parseServerTable(const toml_table_t *serverTable) {
   }
 
   if (privateKey != 0 && certificate != 0) {
+    config->tlsDescription = config_describeTLS(serverTable);
+
+    // Reuse the TLS context of the previous config if nothing it was built from has changed
+    server_config_t *previousServerConfig = previousConfig == 0 ? 0 : config_getServerConfigByName(previousConfig, config->name);
+    if (previousServerConfig != 0 && previousServerConfig->sslContext != 0 && previousServerConfig->tlsDescription != 0 && config->tlsDescription != 0 && string_equals(previousServerConfig->tlsDescription, config->tlsDescription)) {
+      log(LOG_DEBUG, "The TLS configuration of '%s' is unchanged - reusing the TLS context", string_getBuffer(config->name));
+      SSL_CTX_up_ref(previousServerConfig->sslContext);
+      config->sslContext = previousServerConfig->sslContext;
+      string_free(privateKey);
+      string_free(certificate);
+      // The parameters are owned by each config, the context only refers to them through its callback
+      if (!config_parseDiffieHellmanParameters(config, serverTable)) {
+        config_freeServerConfig(config);
+        return 0;
+      }
+      return config;
+    }
+
     log(LOG_DEBUG, "Setting up TLS configuration");
 
     // Setup TLS
@@ -223,6 +448,15 @@ server_config_t *config_parseServerTable(const toml_table_t *serverTable) {
       string_free(ellipticCurves);
     }
 
+    // Let OpenSSL hand the record layer to the kernel once the handshake is done (if supported)
+    if (config->kernelTLS == 1) {
+#ifdef SSL_OP_ENABLE_KTLS
+      SSL_CTX_set_options(config->sslContext, SSL_OP_ENABLE_KTLS);
+#else
+      log(LOG_WARNING, "Kernel TLS is not supported by the OpenSSL version in use. Configuration '%s' will use user-space TLS", string_getBuffer(config->name));
+#endif
+    }
+
     // Disable server certificate validation if validateCertificate is false
     int8_t verifyCertificates = config_parseBool(serverTable, "validateCertificate");
     if (verifyCertificates == 0)
@@ -241,26 +475,35 @@ server_config_t *config_parseServerTable(const toml_table_t *serverTable) {
       string_free(cipherSuite);
     }
 
-    // Setup Diffie Hellman (DH) parameters from a file
-    // Use openssl dhparam -out dh_param_1024.pem -2 1024 or the like
-    string_t *dhparams = config_parseString(serverTable, "dhparams");
-    if (dhparams != 0) {
-      FILE *file = fopen(string_getBuffer(dhparams), "r");
-      if (file) {
-        config->dhparams = PEM_read_DHparams(file, NULL, NULL, NULL);
-        fclose(file);
-      } else {
-        log(LOG_ERROR, "Unable to read Diffie Hellman parameters file '%s'", string_getBuffer(dhparams));
-        config_freeServerConfig(config);
-        return 0;
-      }
-      string_free(dhparams);
+    if (!config_parseDiffieHellmanParameters(config, serverTable)) {
+      config_freeServerConfig(config);
+      return 0;
     }
   }
 
   return config;
 }
 
+bool config_parseDiffieHellmanParameters(server_config_t *config, const toml_table_t *serverTable) {
+  // Setup Diffie Hellman (DH) parameters from a file
+  // Use openssl dhparam -out dh_param_1024.pem -2 1024 or the like
+  string_t *dhparams = config_parseString(serverTable, "dhparams");
+  if (dhparams == 0)
+    return true;
+
+  FILE *file = fopen(string_getBuffer(dhparams), "r");
+  if (file == 0) {
+    log(LOG_ERROR, "Unable to read Diffie Hellman parameters file '%s'", string_getBuffer(dhparams));
+    string_free(dhparams);
+    return false;
+  }
+
+  config->dhparams = PEM_read_DHparams(file, NULL, NULL, NULL);
+  fclose(file);
+  string_free(dhparams);
+  return true;
+}
+
 string_t *config_parseString(const toml_table_t *table, const char *key) {
   const char *rawValue = toml_raw_in((toml_table_t *)table, key);
   // The value is missing
@@ -310,6 +553,29 @@ int8_t config_parseBool(const toml_table_t *table, const char *key) {
   return value;
 }
 
+int32_t config_parseNonNegativeInt(const toml_table_t *table, const char *key) {
+  int64_t value = config_parseInt(table, key);
+  if (value < 0 || value > INT32_MAX) {
+    log(LOG_WARNING, "Bad value specified for '%s' in server config - not used", key);
+    return 0;
+  }
+
+  return (int32_t)value;
+}
+
+size_t config_parseTimeout(const toml_table_t *table, const char *key, size_t defaultTimeout) {
+  if (toml_raw_in((toml_table_t *)table, key) == 0)
+    return defaultTimeout;
+
+  int64_t timeout = config_parseInt(table, key);
+  if (timeout < 1) {
+    log(LOG_WARNING, "Too short of a timeout specified for '%s' in server config - using default", key);
+    return defaultTimeout;
+  }
+
+  return timeout;
+}
+
 list_t *config_parseArray(const toml_table_t *table, const char *key) {
   toml_array_t *array = toml_array_in((toml_table_t *)table, key);
   if (array == 0)
@@ -359,6 +625,113 @@ list_t *config_parseArray(const toml_table_t *table, const char *key) {
   return list;
 }
 
+client_limits_network_t *config_parseNetworks(const toml_table_t *table, const char *key, size_t *count) {
+  *count = 0;
+  toml_array_t *array = toml_array_in((toml_table_t *)table, key);
+  if (array == 0 || toml_array_nelem(array) == 0)
+    return 0;
+
+  client_limits_network_t *networks = malloc(sizeof(client_limits_network_t) * toml_array_nelem(array));
+  if (networks == 0)
+    return 0;
+
+  for (int i = 0; i < toml_array_nelem(array); i++) {
+    const char *rawValue = toml_raw_at(array, i);
+    char *value = 0;
+    if (rawValue == 0 || toml_rtos(rawValue, &value) != 0) {
+      log(LOG_WARNING, "Bad value specified for '%s' in server config - not used", key);
+      continue;
+    }
+
+    if (client_limits_parseNetwork(value, &networks[*count]))
+      (*count)++;
+    else
+      log(LOG_WARNING, "Bad network '%s' specified for '%s' in server config - not used", value, key);
+    free(value);
+  }
+
+  if (*count == 0) {
+    free(networks);
+    return 0;
+  }
+
+  return networks;
+}
+
+hash_table_t *config_parseExtensionTable(const toml_table_t *table) {
+  hash_table_t *mimeTypes = hash_table_create();
+  if (mimeTypes == 0)
+    return 0;
+
+  const char *key = 0;
+  for (int i = 0; (key = toml_key_in((toml_table_t *)table, i)) != 0; i++) {
+    string_t *type = config_parseString(table, key);
+    if (type == 0)
+      continue;
+
+    // Extensions are matched ignoring case, like MIME types are (see mime_getType)
+    string_t *extension = string_create();
+    if (key[0] != '.' && strcmp(key, "*") != 0)
+      string_appendChar(extension, '.');
+    for (size_t j = 0; key[j] != 0; j++)
+      string_appendChar(extension, (char)tolower((unsigned char)key[j]));
+
+    string_t *previousType = hash_table_setValue(mimeTypes, extension, type);
+    if (previousType != 0)
+      string_free(previousType);
+  }
+
+  return mimeTypes;
+}
+
+void config_freeExtensionTable(hash_table_t *table) {
+  while (hash_table_getLength(table) > 0) {
+    string_t *extension = hash_table_getKeyByIndex(table, 0);
+    string_free(hash_table_removeValue(table, extension));
+  }
+  hash_table_free(table);
+}
+
+string_t *config_describeTLS(const toml_table_t *serverTable) {
+  const char *keys[] = {"privateKey", "certificate", "ellipticCurves", "validateCertificate", "cipherSuite", "dhparams", "kernelTLS"};
+  // Files that may be replaced without changing the config (such as renewed certificates)
+  const char *fileKeys[] = {"privateKey", "certificate", "dhparams"};
+
+  string_t *description = string_create();
+  if (description == 0)
+    return 0;
+
+  for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+    const char *rawValue = toml_raw_in((toml_table_t *)serverTable, keys[i]);
+    string_appendBuffer(description, keys[i]);
+    string_appendChar(description, '=');
+    if (rawValue != 0)
+      string_appendBuffer(description, rawValue);
+    string_appendChar(description, '\n');
+  }
+
+  for (size_t i = 0; i < sizeof(fileKeys) / sizeof(fileKeys[0]); i++) {
+    string_t *filePath = config_parseString(serverTable, fileKeys[i]);
+    if (filePath == 0)
+      continue;
+
+    struct stat fileInfo;
+    char modificationTime[64];
+    if (stat(string_getBuffer(filePath), &fileInfo) == 0)
+      snprintf(modificationTime, sizeof(modificationTime), "%lld.%09ld", (long long)fileInfo.st_mtim.tv_sec, fileInfo.st_mtim.tv_nsec);
+    else
+      snprintf(modificationTime, sizeof(modificationTime), "missing");
+    string_free(filePath);
+
+    string_appendBuffer(description, fileKeys[i]);
+    string_appendBuffer(description, " modified=");
+    string_appendBuffer(description, modificationTime);
+    string_appendChar(description, '\n');
+  }
+
+  return description;
+}
+
 int8_t config_getIsDaemon(const config_t *config) {
   return config->daemon;
 }
@@ -418,6 +791,17 @@ server_config_t *config_getServerConfigByDomain(const config_t *config, const st
   return 0;
 }
 
+server_config_t *config_getServerConfigByName(const config_t *config, const string_t *name) {
+  size_t servers = list_getLength(config->serverConfigs);
+  for (size_t i = 0; i < servers; i++) {
+    server_config_t *serverConfig = config_getServerConfig(config, i);
+    if (serverConfig->name != 0 && string_equals(serverConfig->name, name))
+      return serverConfig;
+  }
+
+  return 0;
+}
+
 server_config_t *config_getServerConfigBySSLContext(const config_t *config, const SSL_CTX *sslContext) {
   size_t servers = list_getLength(config->serverConfigs);
   for (size_t i = 0; i < servers; i++) {
@@ -438,10 +822,75 @@ size_t config_getNumberOfThreads(const config_t *config) {
   return config->threads;
 }
 
+size_t config_getMinimumNumberOfThreads(const config_t *config) {
+  return config->minThreads;
+}
+
 size_t config_getBacklogSize(const config_t *config) {
   return config->backlog;
 }
 
+size_t config_getNumberOfInstances(const config_t *config) {
+  return config->instances;
+}
+
+int8_t config_getIOUring(const config_t *config) {
+  return config->ioUring;
+}
+
+size_t config_getHeaderTimeout(const config_t *config) {
+  return config->headerTimeout;
+}
+
+size_t config_getBodyTimeout(const config_t *config) {
+  return config->bodyTimeout;
+}
+
+size_t config_getMinBodyRate(const config_t *config) {
+  return config->minBodyRate;
+}
+
+size_t config_getWriteTimeout(const config_t *config) {
+  return config->writeTimeout;
+}
+
+size_t config_getQueueTimeout(const config_t *config) {
+  return config->queueTimeout;
+}
+
+size_t config_getMaxQueuedConnections(const config_t *config) {
+  return config->maxQueuedConnections;
+}
+
+size_t config_getMaxCGIRequests(const config_t *config) {
+  return config->maxCGIRequests;
+}
+
+size_t config_getMaxClientConnections(const config_t *config) {
+  return config->maxClientConnections;
+}
+
+size_t config_getClientRequestRate(const config_t *config) {
+  return config->clientRequestRate;
+}
+
+size_t config_getClientRequestBurst(const config_t *config) {
+  return config->clientRequestBurst;
+}
+
+const client_limits_network_t *config_getClientAllowList(const config_t *config, size_t *count) {
+  *count = config->clientAllowListLength;
+  return config->clientAllowList;
+}
+
+size_t config_getCGITimeout(const config_t *config) {
+  return config->cgiTimeout;
+}
+
+hash_table_t *config_getMIMETypes(const config_t *config) {
+  return config->mimeTypes;
+}
+
 string_t *config_getName(const server_config_t *config) {
   return config->name;
 }
@@ -462,6 +911,17 @@ void config_setPort(server_config_t *config, int16_t port) {
   config->port = port;
 }
 
+string_t *config_getFilePath(const config_t *config) {
+  return config->filePath;
+}
+
+void config_setFilePath(config_t *config, string_t *filePath) {
+  if (config->filePath != 0)
+    string_free(config->filePath);
+
+  config->filePath = filePath;
+}
+
 string_t *config_getLogfile(const config_t *config) {
   return config->logfile;
 }
@@ -485,6 +945,40 @@ list_t *config_getDirectoryIndex(const server_config_t *config) {
   return config->directoryIndex;
 }
 
+string_t *config_getCacheControl(const server_config_t *config, string_view_t extension) {
+  if (config->cacheControl == 0)
+    return 0;
+
+  // The extensions are stored in lower case (see config_parseExtensionTable)
+  string_t *cacheControl = 0;
+  if (extension.size > 0 && extension.size <= MIME_MAX_EXTENSION_LENGTH) {
+    char lowerCaseExtension[MIME_MAX_EXTENSION_LENGTH];
+    for (size_t i = 0; i < extension.size; i++)
+      lowerCaseExtension[i] = (char)tolower((unsigned char)extension.buffer[i]);
+    string_view_t key = {lowerCaseExtension, extension.size};
+    cacheControl = hash_table_getValueByView(config->cacheControl, key);
+  }
+  if (cacheControl == 0)
+    cacheControl = hash_table_getValueByView(config->cacheControl, string_view_fromBuffer("*"));
+  return cacheControl;
+}
+
+int8_t config_getKernelTLS(const server_config_t *config) {
+  return config->kernelTLS;
+}
+
+int8_t config_getCompress(const server_config_t *config) {
+  return config->compress;
+}
+
+int32_t config_getDeferAccept(const server_config_t *config) {
+  return config->deferAccept;
+}
+
+int32_t config_getFastOpen(const server_config_t *config) {
+  return config->fastOpen;
+}
+
 void config_freeServerConfig(server_config_t *serverConfig) {
   if (serverConfig->name != 0)
     string_free(serverConfig->name);
@@ -496,12 +990,16 @@ void config_freeServerConfig(server_config_t *serverConfig) {
     DH_free(serverConfig->dhparams);
   if (serverConfig->sslContext != 0)
     SSL_CTX_free(serverConfig->sslContext);
+  if (serverConfig->tlsDescription != 0)
+    string_free(serverConfig->tlsDescription);
   if (serverConfig->directoryIndex != 0) {
     string_t *index = 0;
     while ((index = list_removeValue(serverConfig->directoryIndex, 0)) != 0)
       string_free(index);
     list_free(serverConfig->directoryIndex);
   }
+  if (serverConfig->cacheControl != 0)
+    config_freeExtensionTable(serverConfig->cacheControl);
   free(serverConfig);
 }
 
@@ -512,5 +1010,11 @@ void config_free(config_t *config) {
   list_free(config->serverConfigs);
   if (config->logfile != 0)
     string_free(config->logfile);
+  if (config->filePath != 0)
+    string_free(config->filePath);
+  if (config->mimeTypes != 0)
+    config_freeExtensionTable(config->mimeTypes);
+  if (config->clientAllowList != 0)
+    free(config->clientAllowList);
   free(config);
 }
@@ -1,15 +1,29 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <openssl/ssl.h>
 
 #include "tomlc99/toml.h"
 
+#include "../client-limits/client-limits.h"
+#include "../datastructures/hash-table/hash-table.h"
 #include "../datastructures/list/list.h"
 #include "../string/string.h"
 
+// Default timeouts in milliseconds
+#define CONFIG_DEFAULT_HEADER_TIMEOUT 10000
+#define CONFIG_DEFAULT_BODY_TIMEOUT 30000
+#define CONFIG_DEFAULT_WRITE_TIMEOUT 60000
+#define CONFIG_DEFAULT_CGI_TIMEOUT 30000
+#define CONFIG_DEFAULT_QUEUE_TIMEOUT 10000
+// The default minimum rate in bytes per second at which a client must send the request body
+#define CONFIG_DEFAULT_MIN_BODY_RATE 240
+// The default number of connections allowed to wait for a worker
+#define CONFIG_DEFAULT_MAX_QUEUED_CONNECTIONS 1024
+
 // See:
 // https://wiki.mozilla.org/Security/Server_Side_TLS
 // https://www.openssl.org/docs/man1.1.1/man1/ciphers.html
@@ -28,6 +42,18 @@ typedef struct {
   DH *dhparams;
   SSL_CTX *sslContext;
   list_t *directoryIndex;
+  // -1 if not set, 0 or 1 otherwise
+  int8_t kernelTLS;
+  // The Cache-Control values of static files by extension, "*" for any other file (0 if not set)
+  hash_table_t *cacheControl;
+  // -1 if not set, 0 or 1 otherwise
+  int8_t compress;
+  // The time in seconds to wait for the first data of a connection before accepting it (TCP_DEFER_ACCEPT). 0 if not used
+  int32_t deferAccept;
+  // The maximum number of pending TCP Fast Open requests (TCP_FASTOPEN). 0 if not used
+  int32_t fastOpen;
+  // The settings and file modification times the TLS context was built from (0 if TLS is not used)
+  string_t *tlsDescription;
 } server_config_t;
 
 typedef struct {
@@ -36,18 +62,65 @@ typedef struct {
   list_t *serverConfigs;
   string_t *logfile;
   uint8_t loggingLevel;
+  // The maximum number of worker threads
   size_t threads;
+  // The minimum number of worker threads (the pool scales between this and threads)
+  size_t minThreads;
   size_t backlog;
+  // The number of server instances (processes) sharing the listening ports
+  size_t instances;
+  // Whether or not to accept connections using io_uring. -1 if not set (used if supported), 0 or 1 otherwise
+  int8_t ioUring;
+  // The maximum time in milliseconds for receiving the request header
+  size_t headerTimeout;
+  // The maximum time in milliseconds for receiving the request body
+  size_t bodyTimeout;
+  // The minimum rate in bytes per second for receiving the request body, shortening bodyTimeout (0 if not limited)
+  size_t minBodyRate;
+  // The maximum time in milliseconds for writing the response
+  size_t writeTimeout;
+  // The maximum time in milliseconds for a CGI process to respond
+  size_t cgiTimeout;
+  // The maximum time in milliseconds a connection waits for a worker before it's answered with 503
+  size_t queueTimeout;
+  // The maximum number of connections waiting for a worker. Further connections are answered with 503
+  size_t maxQueuedConnections;
+  // The maximum number of CGI requests handled at once by each instance (0 if not limited)
+  size_t maxCGIRequests;
+  // The maximum number of open connections of each client address in each instance (0 if not limited)
+  size_t maxClientConnections;
+  // The number of requests per second each client address may make to each instance (0 if not limited)
+  size_t clientRequestRate;
+  // The number of requests a client may make at once before being held to the rate (0 to use the rate)
+  size_t clientRequestBurst;
+  // The client networks exempt from the limits above (0 if none)
+  client_limits_network_t *clientAllowList;
+  size_t clientAllowListLength;
+  // Extra MIME types from the [mimeTypes] table, extension (such as ".wasm") to type. Only read at start
+  hash_table_t *mimeTypes;
+  // The file the config was read from (0 if not read from a file)
+  string_t *filePath;
+  // The number of holders of the config (see config_acquireGlobalConfig). Freed when it reaches 0
+  size_t references;
 } config_t;
 
 config_t *config_parse(const char *configString) __attribute__((nonnull(1)));
+// Parse a config replacing a previous one. Unchanged TLS contexts are shared with the previous config
+// and the settings in the [server] table (except for timeouts) are kept as they are only read at start
+config_t *config_reload(const char *configString, const config_t *previousConfig) __attribute__((nonnull(1, 2)));
 
-// Get and set the globally defined config
+// Get and set the globally defined config. The global config holds a reference to the config
 config_t *config_getGlobalConfig();
 void config_setGlobalConfig(config_t *config) __attribute__((nonnull(1)));
 void config_freeGlobalConfig();
+// Get the global config and keep it alive until released, even if the global config is replaced meanwhile
+config_t *config_acquireGlobalConfig();
+void config_releaseConfig(config_t *config) __attribute__((nonnull(1)));
+// Re-read the file of the global config and replace it. Returns true if successful
+bool config_reloadGlobalConfig();
 
-server_config_t *config_parseServerTable(const toml_table_t *serverTable) __attribute__((nonnull(1)));
+// previousConfig may be 0. If set, the TLS context of the server with the same name is reused if unchanged
+server_config_t *config_parseServerTable(const toml_table_t *serverTable, const config_t *previousConfig) __attribute__((nonnull(1)));
 
 int8_t config_getIsDaemon(const config_t *config) __attribute__((nonnull(1)));
 void config_setIsDaemon(config_t *config, int8_t isDaemon) __attribute__((nonnull(1)));
@@ -59,13 +132,35 @@ server_config_t *config_getServerConfig(const config_t *config, size_t index) __
 server_config_t *config_getServerConfigByHTTPSDomain(const config_t *config, const string_t *domain) __attribute__((nonnull(1, 2)));
 server_config_t *config_getServerConfigByHTTPDomain(const config_t *config, const string_t *domain) __attribute__((nonnull(1, 2)));
 server_config_t *config_getServerConfigByDomain(const config_t *config, const string_t *domain, uint16_t port) __attribute__((nonnull(1, 2)));
+server_config_t *config_getServerConfigByName(const config_t *config, const string_t *name) __attribute__((nonnull(1, 2)));
 server_config_t *config_getServerConfigBySSLContext(const config_t *config, const SSL_CTX *sslContext) __attribute__((nonnull(1, 2)));
 size_t config_getServers(const config_t *config) __attribute__((nonnull(1)));
 
 size_t config_getNumberOfThreads(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getMinimumNumberOfThreads(const config_t *config) __attribute__((nonnull(1)));
 
 size_t config_getBacklogSize(const config_t *config) __attribute__((nonnull(1)));
 
+size_t config_getNumberOfInstances(const config_t *config) __attribute__((nonnull(1)));
+int8_t config_getIOUring(const config_t *config) __attribute__((nonnull(1)));
+
+size_t config_getHeaderTimeout(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getBodyTimeout(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getMinBodyRate(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getWriteTimeout(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getCGITimeout(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getQueueTimeout(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getMaxQueuedConnections(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getMaxCGIRequests(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getMaxClientConnections(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getClientRequestRate(const config_t *config) __attribute__((nonnull(1)));
+size_t config_getClientRequestBurst(const config_t *config) __attribute__((nonnull(1)));
+// Get the client networks exempt from the limits, setting count to their number
+const client_limits_network_t *config_getClientAllowList(const config_t *config, size_t *count) __attribute__((nonnull(1, 2)));
+
+// The extra MIME types, extension to type (may be 0)
+hash_table_t *config_getMIMETypes(const config_t *config) __attribute__((nonnull(1)));
+
 string_t *config_getName(const server_config_t *config) __attribute__((nonnull(1)));
 
 string_t *config_getDomain(const server_config_t *config) __attribute__((nonnull(1)));
@@ -75,6 +170,10 @@ string_t *config_getRootDirectory(const server_config_t *config) __attribute__((
 int16_t config_getPort(const server_config_t *config) __attribute__((nonnull(1)));
 void config_setPort(server_config_t *config, int16_t port) __attribute__((nonnull(1)));
 
+string_t *config_getFilePath(const config_t *config) __attribute__((nonnull(1)));
+// Config owns filePath
+void config_setFilePath(config_t *config, string_t *filePath) __attribute__((nonnull(1)));
+
 string_t *config_getLogfile(const config_t *config) __attribute__((nonnull(1)));
 // Config owns logfile
 void config_setLogfile(config_t *config, string_t *logfile) __attribute__((nonnull(1)));
@@ -84,10 +183,32 @@ DH *config_getDiffieHellmanParameters(const server_config_t *config) __attribute
 
 list_t *config_getDirectoryIndex(const server_config_t *config) __attribute__((nonnull(1)));
 
+// Get the Cache-Control value of a static file by its extension, such as ".html" (0 if not set)
+string_t *config_getCacheControl(const server_config_t *config, string_view_t extension) __attribute__((nonnull(1)));
+
+// Whether or not kernel TLS (kTLS) should be used when supported by OpenSSL, the kernel and the cipher
+int8_t config_getKernelTLS(const server_config_t *config) __attribute__((nonnull(1)));
+
+// Whether or not compressible static files should be compressed on the fly when no precompressed file exists
+int8_t config_getCompress(const server_config_t *config) __attribute__((nonnull(1)));
+// Options of the listening socket. Servers sharing a port use the largest values. Only read at start
+int32_t config_getDeferAccept(const server_config_t *config) __attribute__((nonnull(1)));
+int32_t config_getFastOpen(const server_config_t *config) __attribute__((nonnull(1)));
+
 string_t *config_parseString(const toml_table_t *table, const char *key) __attribute__((nonnull(1, 2)));
 int64_t config_parseInt(const toml_table_t *table, const char *key) __attribute__((nonnull(1, 2)));
 int8_t config_parseBool(const toml_table_t *table, const char *key) __attribute__((nonnull(1, 2)));
+// Parse an integer from 0 to INT32_MAX. Returns 0 if missing or invalid
+int32_t config_parseNonNegativeInt(const toml_table_t *table, const char *key) __attribute__((nonnull(1, 2)));
+// Parse a timeout in milliseconds. Returns defaultTimeout if missing or invalid
+size_t config_parseTimeout(const toml_table_t *table, const char *key, size_t defaultTimeout) __attribute__((nonnull(1, 2)));
 list_t *config_parseArray(const toml_table_t *table, const char *key) __attribute__((nonnull(1, 2)));
+// Parse an array of networks such as "10.0.0.0/8", skipping invalid ones. Returns 0 if missing or empty
+client_limits_network_t *config_parseNetworks(const toml_table_t *table, const char *key, size_t *count) __attribute__((nonnull(1, 2, 3)));
+// Parse a table of file extensions to strings. The extensions are given a leading dot if missing (except for "*")
+hash_table_t *config_parseExtensionTable(const toml_table_t *table) __attribute__((nonnull(1)));
+// Describe the settings and files a TLS context is built from in order to detect changes
+string_t *config_describeTLS(const toml_table_t *serverTable) __attribute__((nonnull(1)));
 
 // NOTE: Called by config_free automatically
 void config_freeServerConfig(server_config_t *serverConfig) __attribute__((nonnull(1)));
@@ -1,12 +1,21 @@
+#include <arpa/inet.h>
 #include <errno.h>
 #include <poll.h>
+#include <pthread.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
 #include <openssl/err.h>
 
+#include "../datastructures/hash-table/hash-table.h"
+#include "../datastructures/pool/pool.h"
 #include "../logging/logging.h"
+#include "../time/time.h"
 
 #include "connection.h"
 
@@ -15,8 +24,35 @@
 #define MSG_NOSIGNAL 0
 #endif
 
+// Recycles connection objects between the thread accepting connections and the workers
+static pool_t *connection_pool = 0;
+static pthread_once_t connection_poolInitialization = PTHREAD_ONCE_INIT;
+
+void connection_handleDeadline(connection_t *connection);
+void connection_createPool();
+
+// Poll a descriptor, resuming the wait if interrupted by a signal (such as a config reload)
+int connection_poll(struct pollfd *descriptor, int timeout) {
+  uint64_t start = time_getMilliseconds();
+  int remaining = timeout;
+  while (true) {
+    int status = poll(descriptor, 1, remaining);
+    if (status >= 0 || errno != EINTR)
+      return status;
+
+    if (timeout >= 0) {
+      uint64_t elapsed = time_getMilliseconds() - start;
+      if (elapsed >= (uint64_t)timeout)
+        return 0;
+      remaining = timeout - (int)elapsed;
+    }
+  }
+}
+
 connection_t *connection_create() {
-  connection_t *connection = malloc(sizeof(connection_t));
+  pthread_once(&connection_poolInitialization, connection_createPool);
+
+  connection_t *connection = connection_pool == 0 ? malloc(sizeof(connection_t)) : pool_acquire(connection_pool);
   if (connection == 0)
     return 0;
 
@@ -37,82 +73,200 @@ void connection_setSSL(connection_t *connection, SSL *ssl) {
   connection->ssl = ssl;
 }
 
-void connection_setSourceAddress(connection_t *connection, string_t *sourceAddress) {
-  connection->sourceAddress = sourceAddress;
-}
+void connection_setSourceAddress(connection_t *connection, const struct sockaddr *address, socklen_t addressLength) {
+  if (addressLength > sizeof(struct sockaddr_storage))
+    addressLength = sizeof(struct sockaddr_storage);
+  memcpy(&connection->sourceAddress, address, addressLength);
+  connection->formattedSourceAddress[0] = 0;
+
+  // Formatted right away as both the worker and the timers (see connection_handleDeadline) read it
+  const void *binaryAddress = 0;
+  if (address->sa_family == AF_INET) {
+    connection->sourcePort = ntohs(((const struct sockaddr_in *)address)->sin_port);
+    binaryAddress = &((const struct sockaddr_in *)&connection->sourceAddress)->sin_addr;
+  } else if (address->sa_family == AF_INET6) {
+    connection->sourcePort = ntohs(((const struct sockaddr_in6 *)address)->sin6_port);
+    binaryAddress = &((const struct sockaddr_in6 *)&connection->sourceAddress)->sin6_addr;
+  }
 
-string_t *connection_getSourceAddress(const connection_t *connection) {
-  return connection->sourceAddress;
+  if (binaryAddress == 0 || inet_ntop(address->sa_family, binaryAddress, connection->formattedSourceAddress, CONNECTION_ADDRESS_LENGTH) == 0)
+    connection->formattedSourceAddress[0] = 0;
 }
 
-void connection_setSourcePort(connection_t *connection, uint16_t sourcePort) {
-  connection->sourcePort = sourcePort;
+const char *connection_getSourceAddress(const connection_t *connection) {
+  if (connection->formattedSourceAddress[0] == 0)
+    return 0;
+
+  return connection->formattedSourceAddress;
 }
 
 uint16_t connection_getSourcePort(const connection_t *connection) {
   return connection->sourcePort;
 }
 
+size_t connection_getAffinity(const connection_t *connection) {
+  if (connection->sourceAddress.ss_family == AF_INET) {
+    const struct sockaddr_in *address = (const struct sockaddr_in *)&connection->sourceAddress;
+    return hash_table_hashWithLength((const char *)&address->sin_addr, sizeof(address->sin_addr));
+  } else if (connection->sourceAddress.ss_family == AF_INET6) {
+    const struct sockaddr_in6 *address = (const struct sockaddr_in6 *)&connection->sourceAddress;
+    return hash_table_hashWithLength((const char *)&address->sin6_addr, sizeof(address->sin6_addr));
+  }
+
+  return (size_t)connection->socket;
+}
+
+void connection_setTimerWheel(connection_t *connection, timer_wheel_t *timers) {
+  connection->timers = timers;
+  timer_wheel_initializeEntry(&connection->deadline, (timer_wheel_callback_t)connection_handleDeadline, connection);
+}
+
+void connection_setDeadline(connection_t *connection, uint64_t timeout, int shutdownHow) {
+  if (connection->timers == 0)
+    return;
+
+  // Cancel first so that the shutdown mode isn't changed while the deadline could fire
+  timer_wheel_cancel(connection->timers, &connection->deadline);
+  connection->deadlineShutdown = shutdownHow;
+  connection->deadlineResponse = 0;
+  connection->deadlineResponseSize = 0;
+  timer_wheel_schedule(connection->timers, &connection->deadline, time_getMilliseconds() + timeout);
+}
+
+void connection_setDeadlineResponse(connection_t *connection, uint64_t timeout, const char *response, size_t responseSize) {
+  if (connection->timers == 0)
+    return;
+
+  timer_wheel_cancel(connection->timers, &connection->deadline);
+  connection->deadlineShutdown = SHUT_WR;
+  connection->deadlineResponse = response;
+  connection->deadlineResponseSize = responseSize;
+  timer_wheel_schedule(connection->timers, &connection->deadline, time_getMilliseconds() + timeout);
+}
+
+void connection_clearDeadline(connection_t *connection) {
+  if (connection->timers != 0)
+    timer_wheel_cancel(connection->timers, &connection->deadline);
+}
+
+bool connection_hasTimedOut(const connection_t *connection) {
+  return connection->hasTimedOut;
+}
+
+void connection_handleDeadline(connection_t *connection) {
+  log(LOG_DEBUG, "The deadline for %s:%i has passed - shutting down the connection", connection_getSourceAddress(connection), connection->sourcePort);
+  connection->hasTimedOut = true;
+  // The response is small enough to fit in the socket's buffer, so writing it doesn't hold up the other deadlines
+  if (connection->deadlineResponse != 0)
+    connection_write(connection, connection->deadlineResponse, connection->deadlineResponseSize);
+  shutdown(connection->socket, connection->deadlineShutdown);
+}
+
 string_t *connection_read(const connection_t *connection, int timeout, size_t bytesToRead) {
-  uint8_t timeouts = 0;
-  while (true) {
-    bool dataIsAvailable = connection_pollForData(connection, timeout);
-    if (timeouts++ > 5)
+  string_t *content = string_create();
+  if (content == 0)
+    return 0;
+
+  uint64_t deadline = time_getMilliseconds() + timeout;
+  while (string_getSize(content) < bytesToRead) {
+    uint64_t now = time_getMilliseconds();
+    if (now >= deadline) {
+      log(LOG_DEBUG, "Timed out after reading %zu (out of %zu) bytes", string_getSize(content), bytesToRead);
+      string_free(content);
       return 0;
+    }
+
+    bool dataIsAvailable = connection_pollForData(connection, deadline - now);
     if (!dataIsAvailable)
       continue;
 
     ssize_t bytesAvailable = connection_getAvailableBytes(connection);
     if (bytesAvailable == 0) {
+      // Readable without any data means that the connection was closed
+      if (connection_isClosed(connection)) {
+        string_free(content);
+        return 0;
+      }
       // Nothing to read, wait for next event as specified by the polling above
       continue;
     } else if (bytesAvailable < 0) {
       // Failed to get available bytes
+      string_free(content);
       return 0;
-    } else if ((size_t)bytesAvailable < bytesToRead) {
-      // Not enough bytes for reading, wait
-      continue;
     }
 
+    // Read what's available (up to the remaining bytes) and wait for the rest
+    size_t bytesRemaining = bytesToRead - string_getSize(content);
+    if ((size_t)bytesAvailable > bytesRemaining)
+      bytesAvailable = bytesRemaining;
+
     char *buffer = 0;
     size_t bytesReceived = 0;
     if (connection->ssl == 0)
-      bytesReceived = connection_readBytes(connection, &buffer, bytesToRead, READ_FLAGS_NONE);
+      bytesReceived = connection_readBytes(connection, &buffer, bytesAvailable, READ_FLAGS_NONE);
     else
-      bytesReceived = connection_readSSLBytes(connection, &buffer, bytesToRead, READ_FLAGS_NONE);
+      bytesReceived = connection_readSSLBytes(connection, &buffer, bytesAvailable, READ_FLAGS_NONE);
     // Could not read message
-    if (buffer == 0)
+    if (buffer == 0) {
+      string_free(content);
       return 0;
+    }
 
-    string_t *content = string_fromBufferWithLength(buffer, bytesReceived);
+    string_appendBufferWithLength(content, buffer, bytesReceived);
     free(buffer);
-    return content;
   }
+
+  return content;
 }
 
-string_t *connection_readLine(const connection_t *connection, int timeout, size_t maxBytes) {
-  size_t offset = 0;
-  uint8_t timeouts = 0;
+string_t *connection_readLine(const connection_t *connection, int timeout, size_t maxBytes, bool *isTooLong) {
+  if (isTooLong != 0)
+    *isTooLong = false;
+
+  string_t *line = string_create();
+  if (line == 0)
+    return 0;
+
+  uint64_t deadline = time_getMilliseconds() + timeout;
   while (true) {
-    bool dataIsAvailable = connection_pollForData(connection, timeout);
-    if (timeouts++ > 5)
+    uint64_t now = time_getMilliseconds();
+    if (now >= deadline) {
+      log(LOG_DEBUG, "Timed out waiting for a line");
+      string_free(line);
       return 0;
+    }
+
+    bool dataIsAvailable = connection_pollForData(connection, deadline - now);
     if (!dataIsAvailable)
       continue;
 
     ssize_t bytesAvailable = connection_getAvailableBytes(connection);
     if (bytesAvailable == 0) {
+      // Readable without any data means that the connection was closed
+      if (connection_isClosed(connection)) {
+        string_free(line);
+        return 0;
+      }
       // Nothing to read, wait for next event as specified by the polling above
       continue;
     } else if (bytesAvailable < 0) {
       // Failed to get available bytes
+      string_free(line);
       return 0;
-    } else if ((size_t)bytesAvailable >= maxBytes) {
-      // Don't process more than max bytes
-      bytesAvailable = maxBytes;
     }
 
-    // Read the request without consuming the content
+    // Don't process more than max bytes
+    size_t bytesRemaining = maxBytes - string_getSize(line);
+    if ((size_t)bytesAvailable > bytesRemaining)
+      bytesAvailable = bytesRemaining;
+    if (bytesAvailable == 0) {
+      if (isTooLong != 0)
+        *isTooLong = true;
+      string_free(line);
+      return 0;
+    }
+
+    // Look for the end of the line without consuming the content
     char *buffer = 0;
     size_t bytesReceived = 0;
     if (connection->ssl == 0)
@@ -123,42 +277,38 @@ string_t *connection_readLine(const connection_t *connection, int timeout, size_
     if (buffer == 0)
       continue;
 
-    // Create a string from the buffer
-    string_t *string = string_fromBufferWithLength(buffer, bytesReceived);
+    // Consume up until the end of the line. Without an end, all peeked bytes belong to the line
+    char *end = memchr(buffer, '\n', bytesReceived);
+    size_t bytesToConsume = end == 0 ? bytesReceived : (size_t)(end - buffer) + 1;
     free(buffer);
     buffer = 0;
 
-    string_cursor_t *cursor = string_createCursor(string);
-    // Set the offset to only look through new parts of the message
-    string_setOffset(cursor, offset);
-    // Try to find the end of a line
-    ssize_t lineLength = string_findNextChar(cursor, '\n') + 1;
-    offset = string_getOffset(cursor);
-    string_freeCursor(cursor);
-    string_free(string);
-
-    if (lineLength < 1) {
-      // No line found without looking for more than max bytes
-      if ((size_t)bytesAvailable >= maxBytes)
-        return 0;
-
-      // There's no line available yet, wait for next event
-      continue;
-    }
-
     if (connection->ssl == 0)
-      bytesReceived = connection_readBytes(connection, &buffer, lineLength, READ_FLAGS_NONE);
+      bytesReceived = connection_readBytes(connection, &buffer, bytesToConsume, READ_FLAGS_NONE);
     else
-      bytesReceived = connection_readSSLBytes(connection, &buffer, lineLength, READ_FLAGS_NONE);
+      bytesReceived = connection_readSSLBytes(connection, &buffer, bytesToConsume, READ_FLAGS_NONE);
     // Could not read message
-    if (buffer == 0)
+    if (buffer == 0) {
+      string_free(line);
       return 0;
+    }
 
-    string_t *line = string_fromBufferWithLength(buffer, bytesReceived);
+    string_appendBufferWithLength(line, buffer, bytesReceived);
     free(buffer);
-    // Remove the trailing newlines
-    string_trimEnd(line);
-    return line;
+
+    if (end != 0) {
+      // Remove the trailing newlines
+      string_trimEnd(line);
+      return line;
+    }
+
+    // No line found without looking for more than max bytes
+    if (string_getSize(line) >= maxBytes) {
+      if (isTooLong != 0)
+        *isTooLong = true;
+      string_free(line);
+      return 0;
+    }
   }
 }
 
@@ -175,7 +325,7 @@ bool connection_pollForData(const connection_t *connection, int timeout) {
   log(LOG_DEBUG, "Waiting for data to be readable");
 
   // Wait for the connection to be ready to read
-  int status = poll(descriptors, 1, timeout);
+  int status = connection_poll(descriptors, timeout);
   if (status < -1) {
     log(LOG_ERROR, "Could not wait for connection to send data");
     return false;
@@ -187,6 +337,13 @@ bool connection_pollForData(const connection_t *connection, int timeout) {
   return true;
 }
 
+bool connection_isClosed(const connection_t *connection) {
+  // Peek at the socket itself as TLS may have consumed all available bytes
+  char byte;
+  ssize_t bytesAvailable = recv(connection->socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  return bytesAvailable == 0 || (bytesAvailable < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
 ssize_t connection_getAvailableBytes(const connection_t *connection) {
   // Get the number of bytes immediately available for reading
   int bytesAvailable = -1;
@@ -231,10 +388,10 @@ size_t connection_readBytes(const connection_t *connection, char **buffer, size_
     if (errno == EAGAIN || errno == EWOULDBLOCK) {
       log(LOG_ERROR, "Reading %zu bytes would block", bytesToRead);
     } else if (errno == EBADF) {
-      log(LOG_ERROR, "Could not read bytes from %s:%i - the connection is closed", string_getBuffer(connection->sourceAddress), connection->sourcePort);
+      log(LOG_ERROR, "Could not read bytes from %s:%i - the connection is closed", connection_getSourceAddress(connection), connection->sourcePort);
     } else {
       const char *reason = strerror(errno);
-      log(LOG_ERROR, "Could not read bytes from %s:%i. Got code %d (%s)", string_getBuffer(connection->sourceAddress), connection->sourcePort, errno, reason);
+      log(LOG_ERROR, "Could not read bytes from %s:%i. Got code %d (%s)", connection_getSourceAddress(connection), connection->sourcePort, errno, reason);
     }
 
     free(*buffer);
@@ -256,7 +413,7 @@ size_t connection_readSSLBytes(const connection_t *connection, char **buffer, si
   size_t bytesReceived = 0;
   if (flags == READ_FLAGS_PEEK) {
     if (SSL_peek_ex(connection->ssl, (*buffer), bytesToRead, &bytesReceived) <= 0) {
-      log(LOG_ERROR, "Could not read bytes from %s:%i (TLS)", string_getBuffer(connection->sourceAddress), connection->sourcePort);
+      log(LOG_ERROR, "Could not read bytes from %s:%i (TLS)", connection_getSourceAddress(connection), connection->sourcePort);
       free(*buffer);
       *buffer = 0;
       return 0;
@@ -265,7 +422,7 @@ size_t connection_readSSLBytes(const connection_t *connection, char **buffer, si
     log(LOG_DEBUG, "Peeked %zu bytes (TLS)", bytesReceived);
   } else {
     if (SSL_read_ex(connection->ssl, (*buffer), bytesToRead, &bytesReceived) <= 0) {
-      log(LOG_ERROR, "Could not read bytes from %s:%i (TLS)", string_getBuffer(connection->sourceAddress), connection->sourcePort);
+      log(LOG_ERROR, "Could not read bytes from %s:%i (TLS)", connection_getSourceAddress(connection), connection->sourcePort);
       free(*buffer);
       *buffer = 0;
       return 0;
@@ -278,26 +435,43 @@ size_t connection_readSSLBytes(const connection_t *connection, char **buffer, si
 }
 
 size_t connection_write(const connection_t *connection, const char *buffer, size_t bufferSize) {
-  const char *sourceAddress = string_getBuffer(connection->sourceAddress);
+  const char *sourceAddress = connection_getSourceAddress(connection);
   uint16_t sourcePort = connection->sourcePort;
 
-  ssize_t bytesSent = 0;
-  if (connection->ssl == 0) {
-    // Use the flag MSG_NOSIGNAL to try to stop SIGPIPE on supported platforms (there is a signal handler catching other cases)
-    bytesSent = send(connection->socket, buffer, strlen(buffer), MSG_NOSIGNAL);
-    if (bytesSent == -1) {
+  // The buffer may hold binary data (such as compressed bodies), so the size is used rather than the null terminator
+  size_t bytesSent = 0;
+  uint8_t timeouts = 0;
+  while (bytesSent < bufferSize) {
+    ssize_t chunkSize = 0;
+    if (connection->ssl == 0) {
+      // Use the flag MSG_NOSIGNAL to try to stop SIGPIPE on supported platforms (there is a signal handler catching other cases)
+      chunkSize = send(connection->socket, buffer + bytesSent, bufferSize - bytesSent, MSG_NOSIGNAL);
+    } else {
+      size_t sslBytesSent = 0;
+      int status = SSL_write_ex(connection->ssl, buffer + bytesSent, bufferSize - bytesSent, &sslBytesSent);
+      chunkSize = status > 0 ? (ssize_t)sslBytesSent : -1;
+      // OpenSSL requires a retried write to use the same buffer, which it does as nothing was consumed
+      if (status <= 0 && SSL_get_error(connection->ssl, status) == SSL_ERROR_WANT_WRITE)
+        errno = EAGAIN;
+      else if (status <= 0)
+        errno = EIO;
+    }
+
+    if (chunkSize > 0) {
+      bytesSent += chunkSize;
+      timeouts = 0;
+    } else if (chunkSize == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // The socket buffer is full, wait for the client to consume it
+      if (!connection_pollForWritable(connection, CONNECTION_WRITE_TIMEOUT) && timeouts++ > 5)
+        break;
+    } else {
       if (errno == EBADF) {
         log(LOG_ERROR, "Could not write to %s:%i. The connection had already closed", sourceAddress, sourcePort);
       } else {
         const char *reason = strerror(errno);
-        log(LOG_ERROR, "Could not write to %s:%i. Got error %d (%s)", sourceAddress, sourcePort, errno, reason);
+        log(LOG_ERROR, "Could not write to %s:%i%s. Got error %d (%s)", sourceAddress, sourcePort, connection->ssl == 0 ? "" : " (TLS)", errno, reason);
       }
-      return 0;
-    }
-  } else {
-    if (SSL_write_ex(connection->ssl, buffer, strlen(buffer), (size_t *)&bytesSent) < 0) {
-      log(LOG_ERROR, "Could not write to %s:%i (TLS)", sourceAddress, sourcePort);
-      return 0;
+      break;
     }
   }
 
@@ -305,43 +479,185 @@ size_t connection_write(const connection_t *connection, const char *buffer, size
   return bytesSent;
 }
 
+// Write a single chunk of a file. Returns the number of bytes written, 0 on EOF or -1 on error (errno is EAGAIN if the call would block)
+ssize_t connection_writeFileChunk(const connection_t *connection, int fileDescriptor, off_t offset, size_t size) {
+  if (connection->ssl == 0) {
+#ifdef __linux__
+    return sendfile(connection->socket, fileDescriptor, &offset, size);
+#endif
+  } else if (connection_isKernelTLS(connection)) {
+#ifdef SSL_OP_ENABLE_KTLS
+    ossl_ssize_t bytesSent = SSL_sendfile(connection->ssl, fileDescriptor, offset, size, 0);
+    if (bytesSent >= 0)
+      return bytesSent;
+
+    // Only a full socket buffer is retried, errno is not set by OpenSSL for any other error
+    errno = SSL_get_error(connection->ssl, (int)bytesSent) == SSL_ERROR_WANT_WRITE ? EAGAIN : EIO;
+    return -1;
+#endif
+  }
+
+  // Copy the file through user space
+  char buffer[CONNECTION_FILE_CHUNK_SIZE];
+  ssize_t bytesRead = pread(fileDescriptor, buffer, size < CONNECTION_FILE_CHUNK_SIZE ? size : CONNECTION_FILE_CHUNK_SIZE, offset);
+  if (bytesRead <= 0)
+    return bytesRead;
+
+  if (connection->ssl == 0)
+    return send(connection->socket, buffer, bytesRead, MSG_NOSIGNAL);
+
+  // OpenSSL requires a retried write to use the same buffer, so wait for the socket here instead of returning
+  uint8_t timeouts = 0;
+  while (true) {
+    size_t bytesSent = 0;
+    int status = SSL_write_ex(connection->ssl, buffer, bytesRead, &bytesSent);
+    if (status > 0)
+      return bytesSent;
+
+    if (SSL_get_error(connection->ssl, status) != SSL_ERROR_WANT_WRITE || timeouts++ > 5) {
+      errno = EIO;
+      return -1;
+    }
+
+    connection_pollForWritable(connection, CONNECTION_WRITE_TIMEOUT);
+  }
+}
+
+size_t connection_writeFile(const connection_t *connection, int fileDescriptor, off_t offset, size_t size) {
+  const char *sourceAddress = connection_getSourceAddress(connection);
+  uint16_t sourcePort = connection->sourcePort;
+
+  size_t bytesSent = 0;
+  uint8_t timeouts = 0;
+  while (bytesSent < size) {
+    ssize_t chunkSize = connection_writeFileChunk(connection, fileDescriptor, offset + bytesSent, size - bytesSent);
+    if (chunkSize > 0) {
+      bytesSent += chunkSize;
+      timeouts = 0;
+    } else if (chunkSize == 0) {
+      log(LOG_ERROR, "The file ended after %zu (out of %zu) bytes when writing to %s:%i", bytesSent, size, sourceAddress, sourcePort);
+      break;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      // The socket buffer is full, wait for the client to consume it
+      if (!connection_pollForWritable(connection, CONNECTION_WRITE_TIMEOUT) && timeouts++ > 5)
+        break;
+    } else {
+      const char *reason = strerror(errno);
+      log(LOG_ERROR, "Could not write file to %s:%i. Got error %d (%s)", sourceAddress, sourcePort, errno, reason);
+      break;
+    }
+  }
+
+  log(LOG_DEBUG, "Successfully wrote %zu (out of %zu) bytes of file to %s:%i%s", bytesSent, size, sourceAddress, sourcePort, connection_isKernelTLS(connection) ? " (kTLS)" : "");
+  return bytesSent;
+}
+
+bool connection_pollForWritable(const connection_t *connection, int timeout) {
+  // Set up structures necessary for polling
+  struct pollfd descriptors[1];
+  memset(descriptors, 0, sizeof(struct pollfd));
+  descriptors[0].fd = connection->socket;
+  descriptors[0].events = POLLOUT;
+
+  log(LOG_DEBUG, "Waiting for connection to be writable");
+
+  // Wait for the connection to be ready to write
+  int status = connection_poll(descriptors, timeout);
+  if (status < 0) {
+    log(LOG_ERROR, "Could not wait for connection to be writable");
+    return false;
+  } else if (status == 0) {
+    log(LOG_ERROR, "The connection timed out");
+    return false;
+  }
+
+  return true;
+}
+
+bool connection_discard(const connection_t *connection) {
+  // A peer that keeps sending is only read from a few times, leaving the rest for the next call
+  char buffer[CONNECTION_DISCARD_CHUNK_SIZE];
+  for (size_t i = 0; i < CONNECTION_DISCARD_READS; i++) {
+    ssize_t bytesReceived = recv(connection->socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (bytesReceived > 0)
+      continue;
+
+    return bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+  }
+
+  return true;
+}
+
+void connection_linger(const connection_t *connection, int timeout) {
+  shutdown(connection->socket, SHUT_WR);
+
+  struct pollfd descriptor;
+  memset(&descriptor, 0, sizeof(struct pollfd));
+  descriptor.fd = connection->socket;
+  descriptor.events = POLLIN;
+
+  uint64_t deadline = time_getMilliseconds() + timeout;
+  while (connection_discard(connection)) {
+    uint64_t now = time_getMilliseconds();
+    if (now >= deadline || connection_poll(&descriptor, (int)(deadline - now)) <= 0)
+      break;
+  }
+}
+
+bool connection_isKernelTLS(const connection_t *connection) {
+  if (connection->ssl == 0)
+    return false;
+
+#ifdef SSL_OP_ENABLE_KTLS
+  return BIO_get_ktls_send(SSL_get_wbio(connection->ssl));
+#else
+  return false;
+#endif
+}
+
 void connection_close(connection_t *connection) {
   if (shutdown(connection->socket, SHUT_RDWR) == -1) {
     if (errno != ENOTCONN && errno != EINVAL) {
       if (errno == ENOTSOCK || errno == EBADF) {
         log(LOG_ERROR, "Failed to shutdown connection. It was likely already closed");
+        return;
       } else {
         const char *reason = strerror(errno);
         log(LOG_ERROR, "Failed to shutdown connection. Got error %d (%s)", errno, reason);
       }
     }
-  } else {
-    if (close(connection->socket) == -1) {
-      const char *reason = strerror(errno);
-      log(LOG_ERROR, "Unable to close connection. Got error %d (%s)", errno, reason);
-    }
   }
-}
 
-// Detect if TLS was used
-bool connection_isSSL(const connection_t *connection) {
-  char *buffer = 0;
-  connection_readBytes(connection, &buffer, 6, READ_FLAGS_PEEK);
-  if (buffer == 0)
-    return 0;
-
-  bool isHandshakeRecord = buffer[0] == 0x16;
-  bool isClientHello = buffer[5] == 0x01;
-
-  free(buffer);
-  return isHandshakeRecord && isClientHello;
+  // Close the socket even if the peer already disconnected (ENOTCONN)
+  if (close(connection->socket) == -1) {
+    const char *reason = strerror(errno);
+    log(LOG_ERROR, "Unable to close connection. Got error %d (%s)", errno, reason);
+  }
 }
 
+// Detect if TLS was used
 void connection_free(connection_t *connection) {
+  // Make sure that the deadline doesn't fire after the socket is closed
+  connection_clearDeadline(connection);
   connection_close(connection);
-  if (connection->sourceAddress != 0)
-    string_free(connection->sourceAddress);
   if (connection->ssl != 0)
     SSL_free(connection->ssl);
-  free(connection);
+  if (connection->client != 0)
+    client_limits_releaseConnection(connection->client);
+  if (connection_pool == 0)
+    free(connection);
+  else
+    pool_release(connection_pool, connection);
+}
+
+void connection_freePool() {
+  if (connection_pool == 0)
+    return;
+
+  pool_free(connection_pool);
+  connection_pool = 0;
+}
+
+void connection_createPool() {
+  connection_pool = pool_create(sizeof(connection_t), CONNECTION_POOL_CAPACITY);
 }
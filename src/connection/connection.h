@@ -1,47 +1,113 @@
 #ifndef CONNECTION_H
 #define CONNECTION_H
 
+#include <netinet/in.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 
 #include <openssl/ssl.h>
 
+#include "../client-limits/client-limits.h"
+#include "../datastructures/timer-wheel/timer-wheel.h"
 #include "../string/string.h"
 
 #define READ_FLAGS_NONE 0
 #define READ_FLAGS_PEEK MSG_PEEK
 
+// The number of bytes to copy through user space at a time when sendfile is unavailable
+#define CONNECTION_FILE_CHUNK_SIZE 65536
+// Don't allow connections to block writes for more than one second at a time
+#define CONNECTION_WRITE_TIMEOUT 1000
+// The number of idle connection objects kept for reuse
+#define CONNECTION_POOL_CAPACITY 1024
+// The maximum time in milliseconds a connection answered early waits for the peer to close it (see connection_linger)
+#define CONNECTION_LINGER_TIMEOUT 500
+// The number of bytes discarded at a time and how many times a peer that keeps sending is read from (see connection_discard)
+#define CONNECTION_DISCARD_CHUNK_SIZE 4096
+#define CONNECTION_DISCARD_READS 16
+// Large enough to hold a formatted IPv4 or IPv6 address
+#define CONNECTION_ADDRESS_LENGTH INET6_ADDRSTRLEN
+
 typedef struct {
   SSL *ssl;
   int socket;
-  string_t *sourceAddress;
+  // The peer's address as returned by accept
+  struct sockaddr_storage sourceAddress;
+  // The peer's address as formatted when set (see connection_setSourceAddress)
+  char formattedSourceAddress[CONNECTION_ADDRESS_LENGTH];
   uint16_t sourcePort;
+  // The timers used for deadlines (0 if deadlines are not used)
+  timer_wheel_t *timers;
+  // The deadline of the current phase of the connection (see connection_setDeadline)
+  timer_wheel_entry_t deadline;
+  // How to shut down the socket once the deadline has passed (SHUT_RD or SHUT_RDWR)
+  int deadlineShutdown;
+  // Written before shutting down the socket for writing once the deadline has passed, if set (see connection_setDeadlineResponse)
+  const char *deadlineResponse;
+  size_t deadlineResponseSize;
+  // Whether or not the deadline has passed
+  volatile bool hasTimedOut;
+  // The time in milliseconds the connection was accepted, from which the header must be received within the header timeout (0 if unknown)
+  uint64_t acceptedAt;
+  // The time in milliseconds the connection was queued for a worker (0 if not queued)
+  uint64_t queuedAt;
+  // The accounting of the peer's address, released when freed (0 if the peer is not limited)
+  client_limits_client_t *client;
 } connection_t;
 
+// Connections are recycled through a pool shared by all threads
 connection_t *connection_create();
+// Free the connections kept for reuse. Every other thread using connections must have exited
+void connection_freePool();
 
 // Connection owns the socket.
 void connection_setSocket(connection_t *connection, int socket) __attribute__((nonnull(1)));
 int connection_getSocket(const connection_t *connection) __attribute__((nonnull(1)));
 
-// Connection owns the source address.
-void connection_setSourceAddress(connection_t *connection, string_t *sourceAddress) __attribute__((nonnull(1)));
-string_t *connection_getSourceAddress(const connection_t *connection) __attribute__((nonnull(1)));
-
-void connection_setSourcePort(connection_t *connection, uint16_t sourcePort) __attribute__((nonnull(1)));
+// Set the peer's address (and port) as returned by accept
+void connection_setSourceAddress(connection_t *connection, const struct sockaddr *address, socklen_t addressLength) __attribute__((nonnull(1, 2)));
+// Get the peer's formatted address. Returns 0 if unknown
+const char *connection_getSourceAddress(const connection_t *connection) __attribute__((nonnull(1)));
 uint16_t connection_getSourcePort(const connection_t *connection) __attribute__((nonnull(1)));
+// Get a hash of the peer's address (not its port), the same for every connection of a client
+size_t connection_getAffinity(const connection_t *connection) __attribute__((nonnull(1)));
+
+// Use the timers for deadlines. The connection must be freed before the timers are
+void connection_setTimerWheel(connection_t *connection, timer_wheel_t *timers) __attribute__((nonnull(1)));
+// Shut down the socket (SHUT_RD or SHUT_RDWR) if the deadline passes in timeout milliseconds, replacing any previous deadline.
+// Blocked reads and writes are woken up and fail
+void connection_setDeadline(connection_t *connection, uint64_t timeout, int shutdownHow) __attribute__((nonnull(1)));
+// Write the response and shut down the socket for writing if the deadline passes in timeout milliseconds, replacing any
+// previous deadline. The response must outlive the deadline. Meant for connections no thread is using meanwhile
+void connection_setDeadlineResponse(connection_t *connection, uint64_t timeout, const char *response, size_t responseSize) __attribute__((nonnull(1, 3)));
+void connection_clearDeadline(connection_t *connection) __attribute__((nonnull(1)));
+bool connection_hasTimedOut(const connection_t *connection) __attribute__((nonnull(1)));
 
+// Read exactly bytesToRead bytes, waiting for at most timeout milliseconds in total. Returns 0 if failed or timed out
 string_t *connection_read(const connection_t *connection, int timeout, size_t bytesToRead) __attribute__((nonnull(1)));
-string_t *connection_readLine(const connection_t *connection, int timeout, size_t maxBytes) __attribute__((nonnull(1)));
+// Read a line of at most maxBytes bytes, waiting for at most timeout milliseconds in total. Returns 0 if failed or timed out.
+// isTooLong (if set) tells whether it failed as the line is longer than maxBytes
+string_t *connection_readLine(const connection_t *connection, int timeout, size_t maxBytes, bool *isTooLong) __attribute__((nonnull(1)));
 bool connection_pollForData(const connection_t *connection, int timeout) __attribute__((nonnull(1)));
 ssize_t connection_getAvailableBytes(const connection_t *connection) __attribute__((nonnull(1)));
+// Whether or not the peer has closed the connection (or it has been shut down for reading)
+bool connection_isClosed(const connection_t *connection) __attribute__((nonnull(1)));
 size_t connection_readBytes(const connection_t *connection, char **buffer, size_t bytesToRead, int flags) __attribute__((nonnull(1, 2)));
 size_t connection_readSSLBytes(const connection_t *connection, char **buffer, size_t bytesToRead, int flags) __attribute__((nonnull(1, 2)));
 size_t connection_write(const connection_t *connection, const char *buffer, size_t bufferSize) __attribute__((nonnull(1, 2)));
+// Write size bytes of a file starting at offset. Uses sendfile for plain connections and SSL_sendfile for kernel TLS
+// connections, falling back to copying through user space otherwise. Returns the number of bytes written
+size_t connection_writeFile(const connection_t *connection, int fileDescriptor, off_t offset, size_t size) __attribute__((nonnull(1)));
+bool connection_pollForWritable(const connection_t *connection, int timeout) __attribute__((nonnull(1)));
+// Discard the data the peer has sent without waiting for more. Returns false once the peer has closed the connection (or it failed)
+bool connection_discard(const connection_t *connection) __attribute__((nonnull(1)));
+// Shut down the socket for writing and discard what the peer still sends until it closes the connection or timeout milliseconds
+// pass. Closing with unread data resets the connection, which may drop a response the peer has not read yet
+void connection_linger(const connection_t *connection, int timeout) __attribute__((nonnull(1)));
 
-// Check if the connection is for TLS (undefined behaviour if not called as the first read)
-bool connection_isSSL(const connection_t *connection) __attribute__((nonnull(1)));
+// Whether or not the kernel handles TLS records written to the connection (kTLS)
+bool connection_isKernelTLS(const connection_t *connection) __attribute__((nonnull(1)));
 
 void connection_close(connection_t *connection) __attribute__((nonnull(1)));
 void connection_free(connection_t *connection) __attribute__((nonnull(1)));
@@ -0,0 +1,205 @@
+#include <string.h>
+
+#include "../../logging/logging.h"
+
+#include "arena.h"
+
+// Each allocation is preceded by a header holding its size, aligned to keep the allocation aligned
+#define ARENA_HEADER_SIZE ARENA_ALIGNMENT
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1))
+// The offset of the first allocation in a block
+#define ARENA_BLOCK_HEADER_SIZE ARENA_ALIGN(sizeof(arena_block_t))
+// The bytes used by an allocation. Empty allocations still use a byte to keep their pointers unique
+#define ARENA_REQUIRED(size) (ARENA_HEADER_SIZE + ARENA_ALIGN((size) == 0 ? 1 : (size)))
+
+// The arena used by arena_malloc and friends in this thread
+static __thread arena_t *arena_current = 0;
+
+arena_block_t *arena_createBlock(size_t size);
+// Get the block holding the pointer, if any
+arena_block_t *arena_getBlock(const arena_t *arena, const void *pointer);
+
+arena_t *arena_create(size_t blockSize) {
+  if (blockSize == 0)
+    blockSize = ARENA_DEFAULT_BLOCK_SIZE;
+
+  arena_t *arena = malloc(sizeof(arena_t));
+  if (arena == 0) {
+    log(LOG_ERROR, "Failed to allocate arena");
+    return 0;
+  }
+
+  memset(arena, 0, sizeof(arena_t));
+  arena->blockSize = blockSize;
+
+  return arena;
+}
+
+void *arena_allocate(arena_t *arena, size_t size) {
+  size_t required = ARENA_REQUIRED(size);
+
+  // Move on to the next (kept) block or create a new one if the current block is full
+  while (arena->current == 0 || arena->current->used + required > arena->current->size) {
+    if (arena->current != 0 && arena->current->next != 0) {
+      arena->current = arena->current->next;
+      arena->current->used = ARENA_BLOCK_HEADER_SIZE;
+      continue;
+    }
+
+    size_t blockSize = arena->blockSize;
+    if (ARENA_BLOCK_HEADER_SIZE + required > blockSize)
+      blockSize = ARENA_BLOCK_HEADER_SIZE + required;
+
+    arena_block_t *block = arena_createBlock(blockSize);
+    if (block == 0)
+      return 0;
+    arena->blockAllocations++;
+
+    if (arena->current == 0)
+      arena->first = block;
+    else
+      arena->current->next = block;
+    arena->current = block;
+  }
+
+  uint8_t *header = (uint8_t *)arena->current + arena->current->used;
+  arena->current->used += required;
+  *(size_t *)header = size;
+
+  arena->last = header + ARENA_HEADER_SIZE;
+  arena->arenaAllocations++;
+  arena->allocatedBytes += size;
+
+  return arena->last;
+}
+
+bool arena_contains(const arena_t *arena, const void *pointer) {
+  return arena_getBlock(arena, pointer) != 0;
+}
+
+void arena_reset(arena_t *arena) {
+  arena->current = arena->first;
+  if (arena->current != 0)
+    arena->current->used = ARENA_BLOCK_HEADER_SIZE;
+  arena->last = 0;
+
+  arena->arenaAllocations = 0;
+  arena->heapAllocations = 0;
+  arena->blockAllocations = 0;
+  arena->allocatedBytes = 0;
+}
+
+void arena_free(arena_t *arena) {
+  if (arena_current == arena)
+    arena_current = 0;
+
+  arena_block_t *block = arena->first;
+  while (block != 0) {
+    arena_block_t *next = block->next;
+    free(block);
+    block = next;
+  }
+
+  free(arena);
+}
+
+void arena_setCurrent(arena_t *arena) {
+  arena_current = arena;
+}
+
+arena_t *arena_getCurrent() {
+  return arena_current;
+}
+
+void *arena_malloc(size_t size) {
+  if (arena_current == 0)
+    return malloc(size);
+
+  if (size > ARENA_MAX_ALLOCATION_SIZE) {
+    arena_current->heapAllocations++;
+    return malloc(size);
+  }
+
+  return arena_allocate(arena_current, size);
+}
+
+void *arena_realloc(void *pointer, size_t size) {
+  if (pointer == 0)
+    return arena_malloc(size);
+
+  arena_block_t *block = arena_current == 0 ? 0 : arena_getBlock(arena_current, pointer);
+  if (block == 0) {
+    // Memory allocated on the heap stays on the heap
+    if (arena_current != 0)
+      arena_current->heapAllocations++;
+    return realloc(pointer, size);
+  }
+
+  size_t *header = (size_t *)((uint8_t *)pointer - ARENA_HEADER_SIZE);
+  size_t previousSize = *header;
+
+  // Grow or shrink the last allocation in place if it fits in its block
+  if (pointer == arena_current->last && size <= ARENA_MAX_ALLOCATION_SIZE) {
+    size_t previousRequired = ARENA_REQUIRED(previousSize);
+    size_t required = ARENA_REQUIRED(size);
+    if (block->used - previousRequired + required <= block->size) {
+      block->used = block->used - previousRequired + required;
+      if (size > previousSize)
+        arena_current->allocatedBytes += size - previousSize;
+      *header = size;
+      return pointer;
+    }
+  }
+
+  if (size <= previousSize) {
+    *header = size;
+    return pointer;
+  }
+
+  void *newPointer = arena_malloc(size);
+  if (newPointer == 0)
+    return 0;
+
+  memcpy(newPointer, pointer, previousSize);
+  return newPointer;
+}
+
+void arena_release(void *pointer) {
+  if (pointer == 0)
+    return;
+
+  // Memory of the arena is released when it's reset
+  if (arena_current != 0 && arena_contains(arena_current, pointer))
+    return;
+
+  free(pointer);
+}
+
+arena_block_t *arena_createBlock(size_t size) {
+  arena_block_t *block = malloc(size);
+  if (block == 0) {
+    log(LOG_ERROR, "Failed to allocate arena block");
+    return 0;
+  }
+
+  block->next = 0;
+  block->size = size;
+  block->used = ARENA_BLOCK_HEADER_SIZE;
+
+  return block;
+}
+
+arena_block_t *arena_getBlock(const arena_t *arena, const void *pointer) {
+  // Only the blocks in use are searched - memory of blocks beyond the current block is stale
+  for (arena_block_t *block = arena->first; block != 0; block = block->next) {
+    const uint8_t *start = (const uint8_t *)block + ARENA_BLOCK_HEADER_SIZE;
+    const uint8_t *end = (const uint8_t *)block + block->used;
+    if ((const uint8_t *)pointer >= start && (const uint8_t *)pointer < end)
+      return block;
+
+    if (block == arena->current)
+      break;
+  }
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// The default size of each block of an arena
+#define ARENA_DEFAULT_BLOCK_SIZE 65536
+// Allocations larger than this are always made on the heap to not waste blocks
+#define ARENA_MAX_ALLOCATION_SIZE 16384
+// Every allocation is aligned to this many bytes
+#define ARENA_ALIGNMENT 16
+
+typedef struct arena_block_t {
+  struct arena_block_t *next;
+  // The number of bytes of the block
+  size_t size;
+  // The number of used bytes of the block
+  size_t used;
+} arena_block_t;
+
+typedef struct {
+  // The first block of the arena. Blocks are kept when the arena is reset
+  arena_block_t *first;
+  // The block currently allocated from
+  arena_block_t *current;
+  size_t blockSize;
+  // The last allocation made, which may be grown in place
+  void *last;
+
+  // Allocations made from the arena since the last reset
+  size_t arenaAllocations;
+  // Allocations made from the heap by arena_malloc and arena_realloc since the last reset
+  size_t heapAllocations;
+  // Blocks allocated since the last reset
+  size_t blockAllocations;
+  // Bytes handed out by the arena since the last reset
+  size_t allocatedBytes;
+} arena_t;
+
+// Create an arena allocating blocks of blockSize bytes (0 for the default)
+arena_t *arena_create(size_t blockSize);
+// Allocate size bytes from the arena. Returns 0 if the allocation failed
+void *arena_allocate(arena_t *arena, size_t size) __attribute__((nonnull(1)));
+// Whether or not the pointer was allocated from the arena
+bool arena_contains(const arena_t *arena, const void *pointer) __attribute__((nonnull(1)));
+// Release all allocations of the arena in O(1), keeping the blocks for reuse. Resets the counters
+void arena_reset(arena_t *arena) __attribute__((nonnull(1)));
+void arena_free(arena_t *arena) __attribute__((nonnull(1)));
+
+// Use an arena for allocations made through arena_malloc and friends by this thread (0 to use the heap)
+void arena_setCurrent(arena_t *arena);
+// Get the arena used by this thread, if any
+arena_t *arena_getCurrent();
+
+// Allocate from the thread's current arena, or the heap if there is none
+void *arena_malloc(size_t size);
+// Reallocate memory allocated by arena_malloc, malloc or realloc
+void *arena_realloc(void *pointer, size_t size);
+// Free memory allocated by arena_malloc, malloc or realloc. Memory of the current arena is released on reset
+void arena_release(void *pointer);
+
+#endif
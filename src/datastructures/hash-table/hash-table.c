@@ -1,36 +1,38 @@
 #include <string.h>
 
+#include "../arena/arena.h"
+
 #include "hash-table.h"
 
-// Uses the CRC32 hash algorithm (https://en.wikipedia.org/wiki/Cyclic_redundancy_check)
-// Mostly adapted from the excellent https://www.hackersdelight.org/hdcodetxt/crc.c.txt
+#if !defined(HASH_TABLE_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HASH_TABLE_X86
+#include <immintrin.h>
+#endif
+
+uint32_t hash_table_hashScalar(const char *value, size_t length);
+#ifdef HASH_TABLE_X86
+uint32_t hash_table_hashSSE42(const char *value, size_t length);
+#endif
+// Build the lookup table and choose the best implementation supported by the CPU
+void hash_table_initialize() __attribute__((constructor));
+
+// Uses the CRC32C hash algorithm (https://en.wikipedia.org/wiki/Cyclic_redundancy_check), which x86 CPUs with SSE 4.2
+// compute in hardware, eight bytes at a time. The table based fallback is mostly adapted from the excellent
+// https://www.hackersdelight.org/hdcodetxt/crc.c.txt
 // License of the original code http://www.hackersdelight.org/permissions.htm
-// NOTE: Expects values to be null terminated!
-static uint32_t hashLookup[256] = {0};
-uint32_t hash_table_hash(const char *value) {
-  uint32_t crc, mask;
-
-  if (hashLookup[1] == 0) {
-    for (uint32_t byte = 0; byte < 256; byte++) {
-      crc = byte;
-      for (uint32_t bit = 0; bit < 8; bit++) {
-        mask = -(crc & 1);
-        // The magic number is the polynomial used
-        crc = (crc >> 1) ^ (0xEDB88320 & mask);
-      }
-      hashLookup[byte] = crc;
-    }
-  }
+static uint32_t hash_table_lookup[256];
+static uint32_t (*hash_table_implementation)(const char *value, size_t length) = hash_table_hashScalar;
 
-  crc = 0xFFFFFFFF;
-  for (uint32_t byte = 0; value[byte] != 0; byte++)
-    crc = (crc >> 8) ^ hashLookup[(crc ^ value[byte]) & 0xFF];
+uint32_t hash_table_hashWithLength(const char *value, size_t length) {
+  return hash_table_implementation(value, length);
+}
 
-  return ~crc;
+uint32_t hash_table_hash(const char *value) {
+  return hash_table_hashWithLength(value, strlen(value));
 }
 
 hash_table_t *hash_table_create() {
-  hash_table_t *hashTable = malloc(sizeof(hash_table_t));
+  hash_table_t *hashTable = arena_malloc(sizeof(hash_table_t));
   if (hashTable == 0)
     return 0;
 
@@ -38,7 +40,7 @@ hash_table_t *hash_table_create() {
 
   hashTable->entries = list_create();
   if (hashTable->entries == 0) {
-    free(hashTable);
+    arena_release(hashTable);
 
     return 0;
   }
@@ -47,11 +49,11 @@ hash_table_t *hash_table_create() {
 }
 
 void *hash_table_setValue(hash_table_t *hashTable, string_t *key, void *value) {
-  uint32_t keyHash = hash_table_hash(string_getBuffer(key));
+  uint32_t keyHash = hash_table_hashWithLength(string_getBuffer(key), string_getSize(key));
   ssize_t keyIndex = hash_table_findIndex(hashTable, keyHash);
 
   if (keyIndex == -1) {
-    hash_table_entry_t *entry = malloc(sizeof(hash_table_entry_t));
+    hash_table_entry_t *entry = arena_malloc(sizeof(hash_table_entry_t));
     if (entry == 0)
       return 0;
 
@@ -72,7 +74,7 @@ void *hash_table_setValue(hash_table_t *hashTable, string_t *key, void *value) {
 }
 
 void *hash_table_removeValue(hash_table_t *hashTable, const string_t *key) {
-  uint32_t keyHash = hash_table_hash(string_getBuffer(key));
+  uint32_t keyHash = hash_table_hashWithLength(string_getBuffer(key), string_getSize(key));
   ssize_t keyIndex = hash_table_findIndex(hashTable, keyHash);
 
   if (keyIndex == -1)
@@ -81,13 +83,17 @@ void *hash_table_removeValue(hash_table_t *hashTable, const string_t *key) {
   hash_table_entry_t *entry = list_removeValue(hashTable->entries, keyIndex);
   string_free(entry->key);
   void *removedValue = entry->value;
-  free(entry);
+  arena_release(entry);
 
   return removedValue;
 }
 
 void *hash_table_getValue(const hash_table_t *hashTable, const string_t *key) {
-  uint32_t keyHash = hash_table_hash(string_getBuffer(key));
+  return hash_table_getValueByView(hashTable, string_getView(key));
+}
+
+void *hash_table_getValueByView(const hash_table_t *hashTable, string_view_t key) {
+  uint32_t keyHash = hash_table_hashWithLength(key.buffer, key.size);
   ssize_t keyIndex = hash_table_findIndex(hashTable, keyHash);
 
   if (keyIndex == -1)
@@ -143,7 +149,7 @@ void hash_table_clear(hash_table_t *hashTable) {
   while (hashTable->entries->length > 0) {
     hash_table_entry_t *entry = list_removeValue(hashTable->entries, 0);
     string_free(entry->key);
-    free(entry);
+    arena_release(entry);
   }
 }
 
@@ -151,5 +157,49 @@ void hash_table_clear(hash_table_t *hashTable) {
 void hash_table_free(hash_table_t *hashTable) {
   hash_table_clear(hashTable);
   list_free(hashTable->entries);
-  free(hashTable);
+  arena_release(hashTable);
+}
+
+void hash_table_initialize() {
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    uint32_t crc = byte;
+    for (uint32_t bit = 0; bit < 8; bit++) {
+      uint32_t mask = -(crc & 1);
+      // The magic number is the (reversed) Castagnoli polynomial
+      crc = (crc >> 1) ^ (0x82F63B78 & mask);
+    }
+    hash_table_lookup[byte] = crc;
+  }
+
+#ifdef HASH_TABLE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2"))
+    hash_table_implementation = hash_table_hashSSE42;
+#endif
+}
+
+uint32_t hash_table_hashScalar(const char *value, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t byte = 0; byte < length; byte++)
+    crc = (crc >> 8) ^ hash_table_lookup[(crc ^ (uint8_t)value[byte]) & 0xFF];
+
+  return ~crc;
+}
+
+#ifdef HASH_TABLE_X86
+__attribute__((target("sse4.2"))) uint32_t hash_table_hashSSE42(const char *value, size_t length) {
+  uint64_t crc = 0xFFFFFFFF;
+  size_t offset = 0;
+  for (; offset + 8 <= length; offset += 8) {
+    uint64_t chunk;
+    memcpy(&chunk, value + offset, 8);
+    crc = _mm_crc32_u64(crc, chunk);
+  }
+
+  uint32_t crc32 = (uint32_t)crc;
+  for (; offset < length; offset++)
+    crc32 = _mm_crc32_u8(crc32, (uint8_t)value[offset]);
+
+  return ~crc32;
 }
+#endif
@@ -23,13 +23,17 @@ typedef struct {
   list_t *entries;
 } hash_table_t;
 
+// NOTE: Expects values to be null terminated!
 uint32_t hash_table_hash(const char *value) __attribute__((nonnull(1)));
+uint32_t hash_table_hashWithLength(const char *value, size_t length);
 
 hash_table_t *hash_table_create();
 // The hash table owns the key, but not the value
 void *hash_table_setValue(hash_table_t *hashTable, string_t *key, void *value) __attribute__((nonnull(1, 2)));
 void *hash_table_removeValue(hash_table_t *hashTable, const string_t *key) __attribute__((nonnull(1, 2)));
 void *hash_table_getValue(const hash_table_t *hashTable, const string_t *key) __attribute__((nonnull(1, 2)));
+// Look up a value without having to create a string for the key
+void *hash_table_getValueByView(const hash_table_t *hashTable, string_view_t key) __attribute__((nonnull(1)));
 hash_table_entry_t *hash_table_getEntryByIndex(const hash_table_t *hashTable, size_t index) __attribute__((nonnull(1)));
 // The hash table owns the returned key
 string_t *hash_table_getKeyByIndex(const hash_table_t *hashTable, size_t index) __attribute__((nonnull(1)));
@@ -1,10 +1,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../arena/arena.h"
+
 #include "list.h"
 
 list_t *list_create() {
-  list_t *list = malloc(sizeof(list_t));
+  list_t *list = arena_malloc(sizeof(list_t));
   if (list == 0)
     return 0;
 
@@ -14,7 +16,7 @@ list_t *list_create() {
 }
 
 void list_addValue(list_t *list, void *value) {
-  list_node_t *node = malloc(sizeof(list_node_t));
+  list_node_t *node = arena_malloc(sizeof(list_node_t));
   if (node == 0)
     return;
 
@@ -82,7 +84,7 @@ void *list_removeValue(list_t *list, size_t index) {
   void *value = 0;
   if (list->length == 1) {
     value = list->current->value;
-    free(list->current);
+    arena_release(list->current);
     list->current = 0;
     list->tail = 0;
   } else {
@@ -101,7 +103,7 @@ void *list_removeValue(list_t *list, size_t index) {
       list->tail = current->previous;
 
     list->current = current->next;
-    free(current);
+    arena_release(current);
 #endif
   }
 
@@ -164,5 +166,5 @@ void list_clear(list_t *list) {
 // Does not free values
 void list_free(list_t *list) {
   list_clear(list);
-  free(list);
+  arena_release(list);
 }
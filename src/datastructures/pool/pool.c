@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include "../../logging/logging.h"
+
+#include "pool.h"
+
+// The released objects of a thread
+typedef struct {
+  pool_t *pool;
+  void *objects;
+  size_t length;
+} pool_cache_t;
+
+// The next object of a list of released objects
+#define POOL_NEXT(object) (*(void **)(object))
+
+// Get the cache of the calling thread, creating it if necessary. Returns 0 if it could not be created
+pool_cache_t *pool_getCache(pool_t *pool);
+// Return the objects of a cache to the pool, freeing those beyond its capacity
+void pool_flushCache(pool_t *pool, pool_cache_t *cache, size_t objects);
+// Called when a thread with a cache exits
+void pool_freeCache(pool_cache_t *cache);
+
+pool_t *pool_create(size_t objectSize, size_t capacity) {
+  pool_t *pool = malloc(sizeof(pool_t));
+  if (pool == 0) {
+    log(LOG_ERROR, "Failed to allocate pool");
+    return 0;
+  }
+
+  memset(pool, 0, sizeof(pool_t));
+  pool->objectSize = objectSize < sizeof(void *) ? sizeof(void *) : objectSize;
+  pool->capacity = capacity;
+
+  if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+    log(LOG_ERROR, "Failed to create mutex for pool");
+    free(pool);
+    return 0;
+  }
+
+  if (pthread_key_create(&pool->threadCache, (void (*)(void *))pool_freeCache) != 0) {
+    log(LOG_ERROR, "Failed to create thread cache for pool");
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+    return 0;
+  }
+
+  return pool;
+}
+
+void *pool_acquire(pool_t *pool) {
+  pool_cache_t *cache = pool_getCache(pool);
+  if (cache != 0) {
+    // Refill the cache from the pool if it's empty
+    if (cache->objects == 0) {
+      pthread_mutex_lock(&pool->mutex);
+      for (size_t i = 0; i < POOL_BATCH_SIZE && pool->objects != 0; i++) {
+        void *object = pool->objects;
+        pool->objects = POOL_NEXT(object);
+        pool->length--;
+        POOL_NEXT(object) = cache->objects;
+        cache->objects = object;
+        cache->length++;
+      }
+      pthread_mutex_unlock(&pool->mutex);
+    }
+
+    if (cache->objects != 0) {
+      void *object = cache->objects;
+      cache->objects = POOL_NEXT(object);
+      cache->length--;
+      __atomic_fetch_add(&pool->reuses, 1, __ATOMIC_RELAXED);
+      return object;
+    }
+  }
+
+  void *object = malloc(pool->objectSize);
+  if (object == 0) {
+    log(LOG_ERROR, "Failed to allocate object for pool");
+    return 0;
+  }
+
+  __atomic_fetch_add(&pool->allocations, 1, __ATOMIC_RELAXED);
+  return object;
+}
+
+void pool_release(pool_t *pool, void *object) {
+  pool_cache_t *cache = pool_getCache(pool);
+  if (cache == 0) {
+    free(object);
+    return;
+  }
+
+  POOL_NEXT(object) = cache->objects;
+  cache->objects = object;
+  cache->length++;
+
+  // Hand a batch over to other threads (such as from the workers to the thread accepting connections)
+  if (cache->length > POOL_THREAD_CACHE_SIZE)
+    pool_flushCache(pool, cache, POOL_BATCH_SIZE);
+}
+
+size_t pool_getLength(pool_t *pool) {
+  pthread_mutex_lock(&pool->mutex);
+  size_t length = pool->length;
+  pthread_mutex_unlock(&pool->mutex);
+  return length;
+}
+
+void pool_free(pool_t *pool) {
+  // Free the objects cached by the calling thread
+  pool_cache_t *cache = pthread_getspecific(pool->threadCache);
+  if (cache != 0) {
+    pthread_setspecific(pool->threadCache, 0);
+    pool_freeCache(cache);
+  }
+
+  pthread_key_delete(pool->threadCache);
+
+  void *object = pool->objects;
+  while (object != 0) {
+    void *next = POOL_NEXT(object);
+    free(object);
+    object = next;
+  }
+
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool);
+}
+
+pool_cache_t *pool_getCache(pool_t *pool) {
+  pool_cache_t *cache = pthread_getspecific(pool->threadCache);
+  if (cache != 0)
+    return cache;
+
+  cache = malloc(sizeof(pool_cache_t));
+  if (cache == 0)
+    return 0;
+
+  cache->pool = pool;
+  cache->objects = 0;
+  cache->length = 0;
+
+  if (pthread_setspecific(pool->threadCache, cache) != 0) {
+    free(cache);
+    return 0;
+  }
+
+  return cache;
+}
+
+void pool_flushCache(pool_t *pool, pool_cache_t *cache, size_t objects) {
+  pthread_mutex_lock(&pool->mutex);
+  for (size_t i = 0; i < objects && cache->objects != 0; i++) {
+    void *object = cache->objects;
+    cache->objects = POOL_NEXT(object);
+    cache->length--;
+
+    if (pool->length >= pool->capacity) {
+      free(object);
+      continue;
+    }
+
+    POOL_NEXT(object) = pool->objects;
+    pool->objects = object;
+    pool->length++;
+  }
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+void pool_freeCache(pool_cache_t *cache) {
+  pool_flushCache(cache->pool, cache, cache->length);
+  free(cache);
+}
@@ -0,0 +1,42 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// The number of released objects each thread keeps for itself before returning them to the pool
+#define POOL_THREAD_CACHE_SIZE 32
+// The number of objects moved between a thread's cache and the pool at a time
+#define POOL_BATCH_SIZE (POOL_THREAD_CACHE_SIZE / 2)
+
+typedef struct {
+  // The size of each object. Released objects are linked through their first bytes
+  size_t objectSize;
+  // The maximum number of idle objects kept by the pool. Objects released beyond this are freed
+  size_t capacity;
+  // The idle objects shared by all threads
+  void *objects;
+  size_t length;
+  // Each thread caches released objects to avoid locking for every acquire and release
+  pthread_key_t threadCache;
+  pthread_mutex_t mutex;
+
+  // The number of objects allocated from the heap (for statistics)
+  size_t allocations;
+  // The number of objects acquired from the pool or a thread's cache (for statistics)
+  size_t reuses;
+} pool_t;
+
+// Create a pool of objects of objectSize bytes, keeping at most capacity idle objects
+pool_t *pool_create(size_t objectSize, size_t capacity);
+// Get an idle object or allocate a new one. The memory of the object is not cleared
+void *pool_acquire(pool_t *pool) __attribute__((nonnull(1)));
+// Return an object to be reused by any thread
+void pool_release(pool_t *pool, void *object) __attribute__((nonnull(1, 2)));
+// Get the number of idle objects shared by the pool (excluding thread caches)
+size_t pool_getLength(pool_t *pool) __attribute__((nonnull(1)));
+// NOTE: Objects cached by other threads are returned when they exit and must have done so
+void pool_free(pool_t *pool) __attribute__((nonnull(1)));
+
+#endif
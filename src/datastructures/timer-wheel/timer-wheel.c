@@ -0,0 +1,172 @@
+#include <string.h>
+
+#include "../../logging/logging.h"
+
+#include "timer-wheel.h"
+
+void timer_wheel_insert(timer_wheel_t *wheel, timer_wheel_entry_t *entry);
+void timer_wheel_remove(timer_wheel_t *wheel, timer_wheel_entry_t *entry);
+// Move the entries of a slot in a higher level to lower levels
+void timer_wheel_cascade(timer_wheel_t *wheel, size_t level);
+
+timer_wheel_t *timer_wheel_create(uint64_t resolution, uint64_t now) {
+  if (resolution == 0)
+    return 0;
+
+  timer_wheel_t *wheel = malloc(sizeof(timer_wheel_t));
+  if (wheel == 0) {
+    log(LOG_ERROR, "Failed to allocate timer wheel");
+    return 0;
+  }
+
+  memset(wheel, 0, sizeof(timer_wheel_t));
+  wheel->resolution = resolution;
+  wheel->tick = now / resolution;
+
+  if (pthread_mutex_init(&wheel->mutex, NULL) != 0) {
+    log(LOG_ERROR, "Failed to create mutex for timer wheel");
+    free(wheel);
+    return 0;
+  }
+
+  return wheel;
+}
+
+void timer_wheel_initializeEntry(timer_wheel_entry_t *entry, timer_wheel_callback_t callback, void *context) {
+  memset(entry, 0, sizeof(timer_wheel_entry_t));
+  entry->callback = callback;
+  entry->context = context;
+}
+
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint64_t expires) {
+  pthread_mutex_lock(&wheel->mutex);
+  if (entry->isScheduled)
+    timer_wheel_remove(wheel, entry);
+  else
+    wheel->length++;
+
+  // Round up to never expire early. Entries already expired are handled by the next tick
+  entry->expires = (expires + wheel->resolution - 1) / wheel->resolution;
+  if (entry->expires <= wheel->tick)
+    entry->expires = wheel->tick + 1;
+  timer_wheel_insert(wheel, entry);
+  entry->isScheduled = true;
+  pthread_mutex_unlock(&wheel->mutex);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_entry_t *entry) {
+  pthread_mutex_lock(&wheel->mutex);
+  if (entry->isScheduled) {
+    timer_wheel_remove(wheel, entry);
+    entry->isScheduled = false;
+    wheel->length--;
+  }
+  pthread_mutex_unlock(&wheel->mutex);
+}
+
+size_t timer_wheel_advance(timer_wheel_t *wheel, uint64_t now) {
+  uint64_t target = now / wheel->resolution;
+  size_t expiredEntries = 0;
+
+  pthread_mutex_lock(&wheel->mutex);
+  // There's nothing to process, skip ahead
+  if (wheel->length == 0 && target > wheel->tick)
+    wheel->tick = target;
+
+  while (wheel->tick < target) {
+    wheel->tick++;
+
+    // Cascade the higher levels whose lower levels have wrapped around, starting with the highest
+    size_t levels = 0;
+    while (levels + 1 < TIMER_WHEEL_LEVELS && (wheel->tick & ((1ULL << (TIMER_WHEEL_BITS * (levels + 1))) - 1)) == 0)
+      levels++;
+    for (size_t level = levels; level > 0; level--)
+      timer_wheel_cascade(wheel, level);
+
+    // Expire the entries of the current tick
+    size_t slot = wheel->tick & TIMER_WHEEL_MASK;
+    timer_wheel_entry_t *entry = wheel->slots[0][slot];
+    wheel->slots[0][slot] = 0;
+    while (entry != 0) {
+      timer_wheel_entry_t *next = entry->next;
+      entry->previous = 0;
+      entry->next = 0;
+      entry->isScheduled = false;
+      wheel->length--;
+      entry->callback(entry->context);
+      expiredEntries++;
+      entry = next;
+    }
+  }
+  pthread_mutex_unlock(&wheel->mutex);
+
+  return expiredEntries;
+}
+
+size_t timer_wheel_getLength(timer_wheel_t *wheel) {
+  pthread_mutex_lock(&wheel->mutex);
+  size_t length = wheel->length;
+  pthread_mutex_unlock(&wheel->mutex);
+  return length;
+}
+
+void timer_wheel_free(timer_wheel_t *wheel) {
+  pthread_mutex_destroy(&wheel->mutex);
+  free(wheel);
+}
+
+void timer_wheel_insert(timer_wheel_t *wheel, timer_wheel_entry_t *entry) {
+  // Cascaded entries expiring this tick are placed in the current slot, which is processed after cascading
+  if (entry->expires < wheel->tick)
+    entry->expires = wheel->tick;
+
+  // Cap entries too far away to the range of the wheel
+  uint64_t range = 1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+  if (entry->expires - wheel->tick >= range)
+    entry->expires = wheel->tick + range - 1;
+
+  // Find the lowest level able to hold the entry
+  uint64_t delta = entry->expires - wheel->tick;
+  size_t level = 0;
+  while (level + 1 < TIMER_WHEEL_LEVELS && delta >= (1ULL << (TIMER_WHEEL_BITS * (level + 1))))
+    level++;
+
+  size_t slot = (entry->expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+  entry->previous = 0;
+  entry->next = wheel->slots[level][slot];
+  if (entry->next != 0)
+    entry->next->previous = entry;
+  wheel->slots[level][slot] = entry;
+}
+
+void timer_wheel_remove(timer_wheel_t *wheel, timer_wheel_entry_t *entry) {
+  if (entry->previous != 0) {
+    entry->previous->next = entry->next;
+  } else {
+    // The entry is the head of its slot - find it
+    for (size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+      size_t slot = (entry->expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+      if (wheel->slots[level][slot] == entry) {
+        wheel->slots[level][slot] = entry->next;
+        break;
+      }
+    }
+  }
+
+  if (entry->next != 0)
+    entry->next->previous = entry->previous;
+
+  entry->previous = 0;
+  entry->next = 0;
+}
+
+void timer_wheel_cascade(timer_wheel_t *wheel, size_t level) {
+  size_t slot = (wheel->tick >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+  timer_wheel_entry_t *entry = wheel->slots[level][slot];
+  wheel->slots[level][slot] = 0;
+  while (entry != 0) {
+    timer_wheel_entry_t *next = entry->next;
+    timer_wheel_insert(wheel, entry);
+    entry = next;
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Each level of the wheel has 2^TIMER_WHEEL_BITS slots
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+// Timers further away than TIMER_WHEEL_SLOTS^TIMER_WHEEL_LEVELS ticks are capped
+#define TIMER_WHEEL_LEVELS 4
+
+typedef void (*timer_wheel_callback_t)(void *context);
+
+// A timer embedded in the owning structure (such as a connection)
+typedef struct timer_wheel_entry_t {
+  struct timer_wheel_entry_t *previous;
+  struct timer_wheel_entry_t *next;
+  // The tick at which the timer expires
+  uint64_t expires;
+  timer_wheel_callback_t callback;
+  void *context;
+  bool isScheduled;
+} timer_wheel_entry_t;
+
+typedef struct {
+  // Each slot is a doubly linked list of entries, allowing for O(1) scheduling and cancellation
+  timer_wheel_entry_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+  // The length of a tick in milliseconds
+  uint64_t resolution;
+  // The last tick that was processed
+  uint64_t tick;
+  // The number of scheduled entries
+  size_t length;
+  pthread_mutex_t mutex;
+} timer_wheel_t;
+
+// Create a wheel with ticks of resolution milliseconds, starting at now (milliseconds)
+timer_wheel_t *timer_wheel_create(uint64_t resolution, uint64_t now);
+// Initialize an entry calling callback with context when expired
+void timer_wheel_initializeEntry(timer_wheel_entry_t *entry, timer_wheel_callback_t callback, void *context) __attribute__((nonnull(1, 2)));
+// Schedule (or reschedule) an entry to expire at expires (milliseconds)
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint64_t expires) __attribute__((nonnull(1, 2)));
+// Cancel an entry. Once returned, the entry's callback is guaranteed not to be running or to run
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_entry_t *entry) __attribute__((nonnull(1, 2)));
+// Process all ticks up until now (milliseconds), calling the callbacks of expired entries. Returns the number of expired entries
+// NOTE: Callbacks are called with the wheel locked and may not use the wheel
+size_t timer_wheel_advance(timer_wheel_t *wheel, uint64_t now) __attribute__((nonnull(1)));
+// Get the number of scheduled entries
+size_t timer_wheel_getLength(timer_wheel_t *wheel) __attribute__((nonnull(1)));
+// NOTE: Scheduled entries are not called nor freed
+void timer_wheel_free(timer_wheel_t *wheel) __attribute__((nonnull(1)));
+
+#endif
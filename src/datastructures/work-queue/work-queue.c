@@ -0,0 +1,266 @@
+#include <string.h>
+#include <sys/types.h>
+
+#include "../../logging/logging.h"
+
+#include "work-queue.h"
+
+// Add a value to a locked deque, growing it if full. Returns false if failed
+bool work_queue_append(work_queue_deque_t *deque, void *value);
+// Take the oldest value of a locked deque. Returns 0 if empty
+void *work_queue_take(work_queue_deque_t *deque);
+// Take the oldest value of a deque, locking it. Returns 0 if empty
+void *work_queue_takeLocked(work_queue_t *queue, work_queue_deque_t *deque);
+// Pick the deque to push to, starting with the one hinted at (see work_queue_push). Returns -1 if all are closed
+ssize_t work_queue_pickOwner(work_queue_t *queue, size_t hint);
+// Take a value from the deque of another owner. Returns 0 if all are empty
+void *work_queue_steal(work_queue_t *queue, size_t owner);
+// Wake an owner waiting for a value, if any, to steal one
+void work_queue_wakeWaitingOwner(work_queue_t *queue);
+
+work_queue_t *work_queue_create(size_t owners) {
+  work_queue_t *queue = malloc(sizeof(work_queue_t));
+  if (queue == 0) {
+    log(LOG_ERROR, "Failed to allocate work queue");
+    return 0;
+  }
+  memset(queue, 0, sizeof(work_queue_t));
+
+  queue->deques = malloc(sizeof(work_queue_deque_t) * owners);
+  if (queue->deques == 0) {
+    log(LOG_ERROR, "Failed to allocate deques for the work queue");
+    free(queue);
+    return 0;
+  }
+  memset(queue->deques, 0, sizeof(work_queue_deque_t) * owners);
+
+  for (size_t i = 0; i < owners; i++) {
+    work_queue_deque_t *deque = &queue->deques[i];
+    deque->values = malloc(sizeof(void *) * WORK_QUEUE_INITIAL_CAPACITY);
+    if (deque->values == 0 || pthread_mutex_init(&deque->mutex, NULL) != 0 || pthread_cond_init(&deque->condition, NULL) != 0) {
+      log(LOG_ERROR, "Failed to create deque %zu of the work queue", i);
+      free(deque->values);
+      queue->owners = i;
+      work_queue_free(queue);
+      return 0;
+    }
+    deque->capacity = WORK_QUEUE_INITIAL_CAPACITY;
+  }
+  queue->owners = owners;
+
+  return queue;
+}
+
+void work_queue_open(work_queue_t *queue, size_t owner) {
+  work_queue_deque_t *deque = &queue->deques[owner];
+  pthread_mutex_lock(&deque->mutex);
+  __atomic_store_n(&deque->isOpen, true, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&deque->mutex);
+}
+
+void work_queue_close(work_queue_t *queue, size_t owner) {
+  work_queue_deque_t *deque = &queue->deques[owner];
+  pthread_mutex_lock(&deque->mutex);
+  __atomic_store_n(&deque->isOpen, false, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&deque->mutex);
+
+  // Values pushed before the deque was closed would otherwise wait for another owner to steal them
+  while (work_queue_pickOwner(queue, owner) >= 0) {
+    void *value = work_queue_takeLocked(queue, deque);
+    if (value == 0)
+      break;
+
+    work_queue_push(queue, value, owner);
+  }
+}
+
+bool work_queue_push(work_queue_t *queue, void *value, size_t hint) {
+  for (size_t attempt = 0; attempt <= queue->owners; attempt++) {
+    ssize_t pickedOwner = work_queue_pickOwner(queue, hint);
+    size_t owner = pickedOwner < 0 ? hint % queue->owners : (size_t)pickedOwner;
+    work_queue_deque_t *deque = &queue->deques[owner];
+
+    pthread_mutex_lock(&deque->mutex);
+    // The deque may have been closed since it was picked. Values are only left in closed deques if all are closed
+    if (!deque->isOpen && pickedOwner >= 0 && attempt < queue->owners) {
+      pthread_mutex_unlock(&deque->mutex);
+      continue;
+    }
+
+    if (!work_queue_append(deque, value)) {
+      pthread_mutex_unlock(&deque->mutex);
+      return false;
+    }
+    __atomic_add_fetch(&queue->length, 1, __ATOMIC_SEQ_CST);
+
+    // The owner no longer counts as waiting so that further values are pushed to other waiting owners
+    bool wasWaiting = deque->isWaiting;
+    if (wasWaiting) {
+      __atomic_store_n(&deque->isWaiting, false, __ATOMIC_SEQ_CST);
+      pthread_cond_signal(&deque->condition);
+    }
+    pthread_mutex_unlock(&deque->mutex);
+
+    // All owners were busy when picking. One that has started waiting since may steal the value
+    if (!wasWaiting)
+      work_queue_wakeWaitingOwner(queue);
+    return true;
+  }
+
+  return false;
+}
+
+void *work_queue_pop(work_queue_t *queue, size_t owner) {
+  work_queue_deque_t *deque = &queue->deques[owner];
+  while (true) {
+    if (__atomic_load_n(&queue->unlocked, __ATOMIC_SEQ_CST))
+      return 0;
+
+    void *value = work_queue_takeLocked(queue, deque);
+    if (value != 0)
+      return value;
+
+    if (__atomic_load_n(&queue->length, __ATOMIC_SEQ_CST) > 0) {
+      value = work_queue_steal(queue, owner);
+      if (value != 0)
+        return value;
+    }
+
+    pthread_mutex_lock(&deque->mutex);
+    // Announce waiting before looking for values once more. A concurrent push either sees this or its value is seen
+    __atomic_store_n(&deque->isWaiting, true, __ATOMIC_SEQ_CST);
+    if (deque->length == 0 && __atomic_load_n(&queue->length, __ATOMIC_SEQ_CST) == 0 && !__atomic_load_n(&queue->unlocked, __ATOMIC_SEQ_CST))
+      pthread_cond_wait(&deque->condition, &deque->mutex);
+    __atomic_store_n(&deque->isWaiting, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&deque->mutex);
+  }
+}
+
+size_t work_queue_getLength(work_queue_t *queue) {
+  return __atomic_load_n(&queue->length, __ATOMIC_SEQ_CST);
+}
+
+size_t work_queue_getSteals(work_queue_t *queue) {
+  return __atomic_load_n(&queue->steals, __ATOMIC_RELAXED);
+}
+
+void work_queue_unlock(work_queue_t *queue) {
+  __atomic_store_n(&queue->unlocked, true, __ATOMIC_SEQ_CST);
+  for (size_t i = 0; i < queue->owners; i++) {
+    pthread_mutex_lock(&queue->deques[i].mutex);
+    pthread_cond_broadcast(&queue->deques[i].condition);
+    pthread_mutex_unlock(&queue->deques[i].mutex);
+  }
+}
+
+void *work_queue_takeAny(work_queue_t *queue) {
+  for (size_t i = 0; i < queue->owners; i++) {
+    void *value = work_queue_takeLocked(queue, &queue->deques[i]);
+    if (value != 0)
+      return value;
+  }
+
+  return 0;
+}
+
+void work_queue_free(work_queue_t *queue) {
+  for (size_t i = 0; i < queue->owners; i++) {
+    pthread_cond_destroy(&queue->deques[i].condition);
+    pthread_mutex_destroy(&queue->deques[i].mutex);
+    free(queue->deques[i].values);
+  }
+
+  free(queue->deques);
+  free(queue);
+}
+
+bool work_queue_append(work_queue_deque_t *deque, void *value) {
+  if (deque->length == deque->capacity) {
+    size_t capacity = deque->capacity * 2;
+    void **values = malloc(sizeof(void *) * capacity);
+    if (values == 0) {
+      log(LOG_ERROR, "Failed to grow deque of the work queue");
+      return false;
+    }
+
+    // Unwrap the ring buffer so that the oldest value is first
+    for (size_t i = 0; i < deque->length; i++)
+      values[i] = deque->values[(deque->head + i) % deque->capacity];
+    free(deque->values);
+    deque->values = values;
+    deque->capacity = capacity;
+    deque->head = 0;
+  }
+
+  deque->values[(deque->head + deque->length) % deque->capacity] = value;
+  deque->length++;
+  return true;
+}
+
+void *work_queue_take(work_queue_deque_t *deque) {
+  if (deque->length == 0)
+    return 0;
+
+  void *value = deque->values[deque->head];
+  deque->head = (deque->head + 1) % deque->capacity;
+  deque->length--;
+  return value;
+}
+
+void *work_queue_takeLocked(work_queue_t *queue, work_queue_deque_t *deque) {
+  pthread_mutex_lock(&deque->mutex);
+  void *value = work_queue_take(deque);
+  if (value != 0)
+    __atomic_sub_fetch(&queue->length, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&deque->mutex);
+
+  return value;
+}
+
+ssize_t work_queue_pickOwner(work_queue_t *queue, size_t hint) {
+  ssize_t firstOpenOwner = -1;
+  for (size_t i = 0; i < queue->owners; i++) {
+    size_t owner = (hint + i) % queue->owners;
+    work_queue_deque_t *deque = &queue->deques[owner];
+    if (!__atomic_load_n(&deque->isOpen, __ATOMIC_SEQ_CST))
+      continue;
+
+    if (__atomic_load_n(&deque->isWaiting, __ATOMIC_SEQ_CST))
+      return (ssize_t)owner;
+
+    if (firstOpenOwner < 0)
+      firstOpenOwner = (ssize_t)owner;
+  }
+
+  return firstOpenOwner;
+}
+
+void *work_queue_steal(work_queue_t *queue, size_t owner) {
+  for (size_t i = 1; i < queue->owners; i++) {
+    void *value = work_queue_takeLocked(queue, &queue->deques[(owner + i) % queue->owners]);
+    if (value != 0) {
+      __atomic_add_fetch(&queue->steals, 1, __ATOMIC_RELAXED);
+      return value;
+    }
+  }
+
+  return 0;
+}
+
+void work_queue_wakeWaitingOwner(work_queue_t *queue) {
+  for (size_t i = 0; i < queue->owners; i++) {
+    work_queue_deque_t *deque = &queue->deques[i];
+    if (!__atomic_load_n(&deque->isWaiting, __ATOMIC_SEQ_CST))
+      continue;
+
+    pthread_mutex_lock(&deque->mutex);
+    bool isWaiting = deque->isWaiting;
+    if (isWaiting) {
+      __atomic_store_n(&deque->isWaiting, false, __ATOMIC_SEQ_CST);
+      pthread_cond_signal(&deque->condition);
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    if (isWaiting)
+      return;
+  }
+}
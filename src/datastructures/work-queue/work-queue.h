@@ -0,0 +1,68 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+* Run queues of a pool of threads, one deque per owner.
+* Values are pushed to the deque of an owner waiting for work, preferring the one hinted at so that related values
+* tend to be handled by the same thread. Owners take values from their own deque first and steal from the others
+* when it's empty, so each deque has its own lock and no single lock is shared by every push and pop.
+*/
+
+// The number of values each deque can hold before growing
+#define WORK_QUEUE_INITIAL_CAPACITY 16
+
+typedef struct {
+  pthread_mutex_t mutex;
+  // Signalled when a value is pushed to the deque while the owner is waiting
+  pthread_cond_t condition;
+  // A ring buffer of values, oldest first
+  void **values;
+  size_t capacity;
+  size_t head;
+  size_t length;
+  // Whether or not values are pushed to the deque (see work_queue_open)
+  bool isOpen;
+  // Whether or not the owner is waiting for a value. Written with the mutex held, read atomically
+  bool isWaiting;
+} work_queue_deque_t;
+
+typedef struct {
+  work_queue_deque_t *deques;
+  size_t owners;
+
+  // The number of values in all deques, updated atomically
+  size_t length;
+  // The number of values taken from the deque of another owner, updated atomically
+  size_t steals;
+  // Whether or not the queue is unlocked (see work_queue_unlock)
+  bool unlocked;
+} work_queue_t;
+
+// Create a queue for a number of owners, identified by their index. All deques start closed
+work_queue_t *work_queue_create(size_t owners);
+// Start pushing values to an owner's deque
+void work_queue_open(work_queue_t *queue, size_t owner) __attribute__((nonnull(1)));
+// Stop pushing values to an owner's deque. Values left in it are moved to the other open deques
+void work_queue_close(work_queue_t *queue, size_t owner) __attribute__((nonnull(1)));
+// Push a value to the deque of the owner hinted at if it's waiting, to another waiting owner otherwise and
+// to the hinted owner if all are busy. Returns false if the value could not be stored
+bool work_queue_push(work_queue_t *queue, void *value, size_t hint) __attribute__((nonnull(1, 2)));
+// Lock the calling owner until a value can be taken from its own deque or stolen from another. Returns 0 once unlocked
+void *work_queue_pop(work_queue_t *queue, size_t owner) __attribute__((nonnull(1)));
+// Get the number of values waiting to be popped from all deques
+size_t work_queue_getLength(work_queue_t *queue) __attribute__((nonnull(1)));
+// Get the number of values stolen from the deque of another owner
+size_t work_queue_getSteals(work_queue_t *queue) __attribute__((nonnull(1)));
+// Unlock all waiting owners. Further pops return 0
+void work_queue_unlock(work_queue_t *queue) __attribute__((nonnull(1)));
+// Take the oldest value of any deque, whether unlocked or not, such as to free the values left once the owners have stopped.
+// Returns 0 if all are empty
+void *work_queue_takeAny(work_queue_t *queue) __attribute__((nonnull(1)));
+// NOTE: No owner may be using the queue. Values left are not freed (see work_queue_takeAny)
+void work_queue_free(work_queue_t *queue) __attribute__((nonnull(1)));
+
+#endif
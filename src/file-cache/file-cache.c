@@ -0,0 +1,387 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../datastructures/hash-table/hash-table.h"
+#include "../logging/logging.h"
+
+#include "file-cache.h"
+
+// Disk I/O performed on behalf of a worker, holding a reference to the entry
+typedef struct {
+  io_pool_job_t job;
+  file_cache_entry_t *entry;
+  // The status of the path (see file_cache_runValidation)
+  struct stat info;
+  int error;
+  // The range to read ahead (see file_cache_runReadAhead)
+  off_t offset;
+  off_t length;
+} file_cache_job_t;
+
+static file_cache_t *file_cache_globalCache = 0;
+static pthread_once_t file_cache_globalCacheOnce = PTHREAD_ONCE_INIT;
+
+// Create the global cache (see pthread_once)
+void file_cache_createGlobalCache();
+// Find the cached entry of a path. The cache must be locked
+file_cache_entry_t *file_cache_findEntry(file_cache_t *cache, const char *path, size_t pathLength, uint32_t pathHash);
+// Move an entry to the front of the list of entries as it's the most recently used. The cache must be locked
+void file_cache_touchEntry(file_cache_t *cache, file_cache_entry_t *entry, time_t now);
+// Add an entry to the cache, making room if necessary. The cache must be locked
+void file_cache_insertEntry(file_cache_t *cache, file_cache_entry_t *entry, time_t now);
+// Remove an entry from the cache, releasing the cache's reference. The cache must be locked
+void file_cache_removeEntry(file_cache_t *cache, file_cache_entry_t *entry);
+// Remove the entries not used within the inactivity period. The cache must be locked
+void file_cache_expireEntries(file_cache_t *cache, time_t now);
+// Create an entry for a path, which is yet to be opened (see file_cache_openEntry). Returns 0 if out of memory
+file_cache_entry_t *file_cache_createEntry(const char *path, size_t pathLength, uint32_t pathHash, time_t now);
+// Open the path of an entry and get its status
+void file_cache_openEntry(file_cache_entry_t *entry);
+// Run a job on the I/O pool, or on the calling thread if there is none. Returns false if timed out
+bool file_cache_performJob(file_cache_t *cache, file_cache_job_t *job);
+// Create a job for an entry. Returns 0 if out of memory
+file_cache_job_t *file_cache_createJob(file_cache_entry_t *entry, void (*run)(io_pool_job_t *job));
+// Release the entry of a job and free it
+void file_cache_freeJob(io_pool_job_t *job);
+void file_cache_runOpen(io_pool_job_t *job);
+void file_cache_runValidation(io_pool_job_t *job);
+void file_cache_runReadAhead(io_pool_job_t *job);
+// Whether or not the status of a path is still that of the entry
+bool file_cache_isValid(const file_cache_entry_t *entry, int error, const struct stat *info);
+
+file_cache_t *file_cache_create(size_t maxEntries, time_t validity, time_t inactivity) {
+  file_cache_t *cache = malloc(sizeof(file_cache_t));
+  if (cache == 0) {
+    log(LOG_ERROR, "Failed to allocate file cache");
+    return 0;
+  }
+
+  memset(cache, 0, sizeof(file_cache_t));
+  cache->maxEntries = maxEntries;
+  cache->validity = validity;
+  cache->inactivity = inactivity;
+
+  if (pthread_mutex_init(&cache->mutex, NULL) != 0) {
+    log(LOG_ERROR, "Failed to create mutex for file cache");
+    free(cache);
+    return 0;
+  }
+
+  return cache;
+}
+
+file_cache_entry_t *file_cache_open(file_cache_t *cache, const char *path, size_t pathLength) {
+  time_t now = time(NULL);
+  uint32_t pathHash = hash_table_hashWithLength(path, pathLength);
+
+  pthread_mutex_lock(&cache->mutex);
+  file_cache_expireEntries(cache, now);
+  file_cache_entry_t *entry = file_cache_findEntry(cache, path, pathLength, pathHash);
+  if (entry != 0) {
+    __atomic_add_fetch(&entry->references, 1, __ATOMIC_ACQ_REL);
+    if (now - entry->validated < cache->validity) {
+      file_cache_touchEntry(cache, entry, now);
+      cache->hits++;
+      pthread_mutex_unlock(&cache->mutex);
+      return entry;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    // Check the status again without holding the lock
+    file_cache_job_t *job = file_cache_createJob(entry, file_cache_runValidation);
+    if (job == 0 || !file_cache_performJob(cache, job)) {
+      if (job == 0)
+        log(LOG_ERROR, "Failed to allocate job for checking file '%s'", path);
+      file_cache_release(entry);
+      return 0;
+    }
+    bool isValid = file_cache_isValid(entry, job->error, &job->info);
+    file_cache_freeJob(&job->job);
+
+    pthread_mutex_lock(&cache->mutex);
+    if (isValid) {
+      entry->validated = now;
+      if (entry->isCached)
+        file_cache_touchEntry(cache, entry, now);
+      cache->hits++;
+      pthread_mutex_unlock(&cache->mutex);
+      return entry;
+    }
+
+    // The file has changed - replace the entry. Current holders keep using the old file until they release it
+    log(LOG_DEBUG, "Cached file '%s' has changed", path);
+    if (entry->isCached)
+      file_cache_removeEntry(cache, entry);
+    file_cache_release(entry);
+  }
+  cache->misses++;
+  pthread_mutex_unlock(&cache->mutex);
+
+  // Open the file without holding the lock
+  entry = file_cache_createEntry(path, pathLength, pathHash, now);
+  if (entry == 0)
+    return 0;
+  file_cache_job_t *job = file_cache_createJob(entry, file_cache_runOpen);
+  if (job == 0 || !file_cache_performJob(cache, job)) {
+    if (job == 0)
+      log(LOG_ERROR, "Failed to allocate job for opening file '%s'", path);
+    file_cache_release(entry);
+    return 0;
+  }
+  file_cache_freeJob(&job->job);
+
+  pthread_mutex_lock(&cache->mutex);
+  file_cache_entry_t *existingEntry = file_cache_findEntry(cache, path, pathLength, pathHash);
+  if (existingEntry != 0) {
+    // Another thread opened the file first
+    __atomic_add_fetch(&existingEntry->references, 1, __ATOMIC_ACQ_REL);
+    file_cache_touchEntry(cache, existingEntry, now);
+    pthread_mutex_unlock(&cache->mutex);
+    file_cache_release(entry);
+    return existingEntry;
+  }
+
+  file_cache_insertEntry(cache, entry, now);
+  pthread_mutex_unlock(&cache->mutex);
+
+  return entry;
+}
+
+void file_cache_release(file_cache_entry_t *entry) {
+  if (__atomic_sub_fetch(&entry->references, 1, __ATOMIC_ACQ_REL) > 0)
+    return;
+
+  if (entry->file != -1)
+    close(entry->file);
+  free(entry->path);
+  free(entry);
+}
+
+void file_cache_readAhead(file_cache_t *cache, file_cache_entry_t *entry, off_t offset, off_t length) {
+  // Reading ahead on the calling thread would only delay it
+  if (cache->ioPool == 0 || entry->file == -1)
+    return;
+
+  file_cache_job_t *job = file_cache_createJob(entry, file_cache_runReadAhead);
+  if (job == 0)
+    return;
+  job->offset = offset;
+  job->length = length;
+  io_pool_submit(cache->ioPool, &job->job);
+}
+
+void file_cache_expire(file_cache_t *cache) {
+  pthread_mutex_lock(&cache->mutex);
+  file_cache_expireEntries(cache, time(NULL));
+  pthread_mutex_unlock(&cache->mutex);
+}
+
+void file_cache_free(file_cache_t *cache) {
+  while (cache->first != 0)
+    file_cache_removeEntry(cache, cache->first);
+
+  pthread_mutex_destroy(&cache->mutex);
+  free(cache);
+}
+
+file_cache_t *file_cache_getGlobalCache() {
+  pthread_once(&file_cache_globalCacheOnce, file_cache_createGlobalCache);
+  return file_cache_globalCache;
+}
+
+bool file_cache_isFile(const file_cache_entry_t *entry) {
+  return entry->file != -1;
+}
+
+bool file_cache_isExecutable(const file_cache_entry_t *entry) {
+  return entry->error == 0 && (entry->info.st_mode & S_IXUSR);
+}
+
+void file_cache_createGlobalCache() {
+  file_cache_globalCache = file_cache_create(FILE_CACHE_MAX_ENTRIES, FILE_CACHE_VALIDITY, FILE_CACHE_INACTIVITY);
+  if (file_cache_globalCache != 0)
+    file_cache_globalCache->ioPool = io_pool_getGlobalPool();
+}
+
+file_cache_entry_t *file_cache_findEntry(file_cache_t *cache, const char *path, size_t pathLength, uint32_t pathHash) {
+  file_cache_entry_t *entry = cache->buckets[pathHash & (FILE_CACHE_BUCKETS - 1)];
+  for (; entry != 0; entry = entry->nextInBucket) {
+    if (entry->pathHash == pathHash && entry->pathLength == pathLength && memcmp(entry->path, path, pathLength) == 0)
+      return entry;
+  }
+
+  return 0;
+}
+
+void file_cache_touchEntry(file_cache_t *cache, file_cache_entry_t *entry, time_t now) {
+  entry->used = now;
+  if (cache->first == entry)
+    return;
+
+  // Unlink the entry, which is not the first one
+  entry->previous->next = entry->next;
+  if (entry->next != 0)
+    entry->next->previous = entry->previous;
+  else
+    cache->last = entry->previous;
+
+  entry->previous = 0;
+  entry->next = cache->first;
+  cache->first->previous = entry;
+  cache->first = entry;
+}
+
+void file_cache_insertEntry(file_cache_t *cache, file_cache_entry_t *entry, time_t now) {
+  // Evict the least recently used entries to make room
+  file_cache_expireEntries(cache, now);
+  while (cache->last != 0 && cache->length >= cache->maxEntries)
+    file_cache_removeEntry(cache, cache->last);
+
+  entry->next = cache->first;
+  if (cache->first != 0)
+    cache->first->previous = entry;
+  cache->first = entry;
+  if (cache->last == 0)
+    cache->last = entry;
+
+  size_t bucket = entry->pathHash & (FILE_CACHE_BUCKETS - 1);
+  entry->nextInBucket = cache->buckets[bucket];
+  cache->buckets[bucket] = entry;
+
+  entry->isCached = true;
+  entry->used = now;
+  cache->length++;
+  // Held by both the cache and the caller
+  __atomic_add_fetch(&entry->references, 1, __ATOMIC_ACQ_REL);
+}
+
+void file_cache_removeEntry(file_cache_t *cache, file_cache_entry_t *entry) {
+  if (entry->previous != 0)
+    entry->previous->next = entry->next;
+  else
+    cache->first = entry->next;
+  if (entry->next != 0)
+    entry->next->previous = entry->previous;
+  else
+    cache->last = entry->previous;
+  entry->previous = 0;
+  entry->next = 0;
+
+  file_cache_entry_t **link = &cache->buckets[entry->pathHash & (FILE_CACHE_BUCKETS - 1)];
+  while (*link != entry)
+    link = &(*link)->nextInBucket;
+  *link = entry->nextInBucket;
+  entry->nextInBucket = 0;
+
+  entry->isCached = false;
+  cache->length--;
+  file_cache_release(entry);
+}
+
+void file_cache_expireEntries(file_cache_t *cache, time_t now) {
+  // The least recently used entries are last
+  while (cache->last != 0 && now - cache->last->used >= cache->inactivity)
+    file_cache_removeEntry(cache, cache->last);
+}
+
+file_cache_entry_t *file_cache_createEntry(const char *path, size_t pathLength, uint32_t pathHash, time_t now) {
+  file_cache_entry_t *entry = malloc(sizeof(file_cache_entry_t));
+  if (entry == 0) {
+    log(LOG_ERROR, "Failed to allocate file cache entry");
+    return 0;
+  }
+  memset(entry, 0, sizeof(file_cache_entry_t));
+
+  entry->path = malloc(pathLength + 1);
+  if (entry->path == 0) {
+    log(LOG_ERROR, "Failed to allocate file cache entry");
+    free(entry);
+    return 0;
+  }
+  memcpy(entry->path, path, pathLength);
+  entry->path[pathLength] = 0;
+  entry->pathLength = pathLength;
+  entry->pathHash = pathHash;
+  entry->validated = now;
+  entry->used = now;
+  entry->references = 1;
+  entry->file = -1;
+
+  return entry;
+}
+
+void file_cache_openEntry(file_cache_entry_t *entry) {
+  // The descriptor is shared by threads, which only use positional reads, and must not leak into CGI processes.
+  // Don't block on special files such as FIFOs
+  entry->file = open(entry->path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+  if (entry->file == -1) {
+    // The status may still be known, such as for files that are executable but not readable
+    entry->error = stat(entry->path, &entry->info) == 0 ? 0 : errno;
+    return;
+  }
+
+  if (fstat(entry->file, &entry->info) == -1) {
+    entry->error = errno;
+    close(entry->file);
+    entry->file = -1;
+    return;
+  }
+
+  // Only regular files are kept open
+  if (!S_ISREG(entry->info.st_mode)) {
+    close(entry->file);
+    entry->file = -1;
+  }
+}
+
+bool file_cache_performJob(file_cache_t *cache, file_cache_job_t *job) {
+  if (cache->ioPool == 0) {
+    job->job.run(&job->job);
+    return true;
+  }
+
+  return io_pool_run(cache->ioPool, &job->job, IO_POOL_TIMEOUT);
+}
+
+file_cache_job_t *file_cache_createJob(file_cache_entry_t *entry, void (*run)(io_pool_job_t *job)) {
+  file_cache_job_t *job = malloc(sizeof(file_cache_job_t));
+  if (job == 0)
+    return 0;
+  memset(job, 0, sizeof(file_cache_job_t));
+
+  job->job.run = run;
+  job->job.abandon = file_cache_freeJob;
+  job->entry = entry;
+  __atomic_add_fetch(&entry->references, 1, __ATOMIC_ACQ_REL);
+  return job;
+}
+
+void file_cache_freeJob(io_pool_job_t *job) {
+  // The job is the first member
+  file_cache_job_t *fileCacheJob = (file_cache_job_t *)job;
+  file_cache_release(fileCacheJob->entry);
+  free(fileCacheJob);
+}
+
+void file_cache_runOpen(io_pool_job_t *job) {
+  file_cache_openEntry(((file_cache_job_t *)job)->entry);
+}
+
+void file_cache_runValidation(io_pool_job_t *job) {
+  file_cache_job_t *fileCacheJob = (file_cache_job_t *)job;
+  fileCacheJob->error = stat(fileCacheJob->entry->path, &fileCacheJob->info) == 0 ? 0 : errno;
+}
+
+void file_cache_runReadAhead(io_pool_job_t *job) {
+  file_cache_job_t *fileCacheJob = (file_cache_job_t *)job;
+  posix_fadvise(fileCacheJob->entry->file, fileCacheJob->offset, fileCacheJob->length, POSIX_FADV_WILLNEED);
+}
+
+bool file_cache_isValid(const file_cache_entry_t *entry, int error, const struct stat *info) {
+  if (error != 0 || entry->error != 0)
+    return error == entry->error;
+
+  return info->st_ino == entry->info.st_ino && info->st_dev == entry->info.st_dev && info->st_size == entry->info.st_size && info->st_mtime == entry->info.st_mtime && info->st_mode == entry->info.st_mode;
+}
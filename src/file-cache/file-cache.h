@@ -0,0 +1,90 @@
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "../io-pool/io-pool.h"
+
+/**
+* Keeps static files open along with their status so that hot files can be served without open, stat and close calls.
+* Paths that could not be opened, such as missing files, are cached as well. The status of an entry is checked
+* again once it's older than the validity period, replacing the entry if the file has changed. Entries not used
+* within the inactivity period are closed. The cache is shared by all threads of the process.
+* When given an I/O pool, files are opened and checked on its threads (see io_pool_run).
+*/
+
+// The maximum number of cached paths. Each regular file holds a file descriptor
+#define FILE_CACHE_MAX_ENTRIES 256
+// The number of seconds before the status of a cached file is checked again
+#define FILE_CACHE_VALIDITY 1
+// The number of seconds after which an unused entry is closed
+#define FILE_CACHE_INACTIVITY 20
+// The number of buckets in the lookup table. A power of two
+#define FILE_CACHE_BUCKETS 512
+// The number of bytes read ahead of a file being sent (see file_cache_readAhead)
+#define FILE_CACHE_READ_AHEAD_SIZE 2097152
+
+typedef struct file_cache_entry_t {
+  char *path;
+  size_t pathLength;
+  uint32_t pathHash;
+  // The open file, or -1 if the path is not a regular file or could not be opened
+  int file;
+  // 0 if the status of the path is known, errno otherwise
+  int error;
+  struct stat info;
+  // The time the status was last checked
+  time_t validated;
+  // The time the entry was last used
+  time_t used;
+  // The number of holders of the entry, including the cache. Closed and freed when it reaches 0
+  size_t references;
+  // Whether or not the entry is in the cache
+  bool isCached;
+  // Most recently used first
+  struct file_cache_entry_t *previous;
+  struct file_cache_entry_t *next;
+  // The next entry in the same bucket
+  struct file_cache_entry_t *nextInBucket;
+} file_cache_entry_t;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  file_cache_entry_t *buckets[FILE_CACHE_BUCKETS];
+  file_cache_entry_t *first;
+  file_cache_entry_t *last;
+  size_t length;
+  size_t maxEntries;
+  time_t validity;
+  time_t inactivity;
+  // The pool performing disk I/O, or 0 to perform it on the calling thread
+  io_pool_t *ioPool;
+  // Statistics, for debugging purposes
+  size_t hits;
+  size_t misses;
+} file_cache_t;
+
+file_cache_t *file_cache_create(size_t maxEntries, time_t validity, time_t inactivity);
+// Open a path through the cache. Returns 0 if out of memory or the disk timed out. The entry must be released (see file_cache_release)
+file_cache_entry_t *file_cache_open(file_cache_t *cache, const char *path, size_t pathLength) __attribute__((nonnull(1, 2)));
+void file_cache_release(file_cache_entry_t *entry) __attribute__((nonnull(1)));
+// Ask for a range of an open file to be read into the page cache on the I/O pool, without waiting for it
+void file_cache_readAhead(file_cache_t *cache, file_cache_entry_t *entry, off_t offset, off_t length) __attribute__((nonnull(1, 2)));
+// Close all entries not used within the inactivity period
+void file_cache_expire(file_cache_t *cache) __attribute__((nonnull(1)));
+void file_cache_free(file_cache_t *cache) __attribute__((nonnull(1)));
+
+// Get the cache of the process, creating it if necessary
+file_cache_t *file_cache_getGlobalCache();
+
+// Whether or not the entry is an open regular file
+bool file_cache_isFile(const file_cache_entry_t *entry) __attribute__((nonnull(1)));
+// Whether or not the user can execute the path
+bool file_cache_isExecutable(const file_cache_entry_t *entry) __attribute__((nonnull(1)));
+
+#endif
@@ -0,0 +1,205 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "format.h"
+
+// The digits of all numbers from 00 to 99, allowing two digits to be formatted at a time
+static const char format_digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char *format_days[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char *format_months[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// The dates of the current second, shared by all threads
+static pthread_mutex_t format_cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static time_t format_httpDateSecond = -1;
+static char format_cachedHTTPDate[FORMAT_HTTP_DATE_LENGTH];
+static time_t format_commonLogDateSecond = -1;
+static char format_cachedCommonLogDate[FORMAT_COMMON_LOG_DATE_LENGTH];
+
+// Write a number from 0 to 99 as two digits
+static inline char *format_writeTwoDigits(char *buffer, int value) {
+  memcpy(buffer, format_digitPairs + value * 2, 2);
+  return buffer + 2;
+}
+
+size_t format_unsignedInteger(char *buffer, uint64_t value) {
+  char digits[FORMAT_INTEGER_LENGTH];
+  char *end = digits + sizeof(digits);
+  char *start = end;
+
+  // Format two digits at a time, starting with the least significant ones
+  while (value >= 100) {
+    start -= 2;
+    memcpy(start, format_digitPairs + (value % 100) * 2, 2);
+    value /= 100;
+  }
+
+  if (value >= 10) {
+    start -= 2;
+    memcpy(start, format_digitPairs + value * 2, 2);
+  } else {
+    *--start = (char)('0' + value);
+  }
+
+  size_t length = end - start;
+  memcpy(buffer, start, length);
+  buffer[length] = 0;
+  return length;
+}
+
+size_t format_integer(char *buffer, int64_t value) {
+  if (value >= 0)
+    return format_unsignedInteger(buffer, (uint64_t)value);
+
+  // Negate as unsigned to handle the smallest value, which has no positive counterpart
+  buffer[0] = '-';
+  return format_unsignedInteger(buffer + 1, -(uint64_t)value) + 1;
+}
+
+size_t format_hexadecimal(char *buffer, uint64_t value) {
+  static const char digits[] = "0123456789abcdef";
+  char reversed[FORMAT_INTEGER_LENGTH];
+  size_t length = 0;
+  do {
+    reversed[length++] = digits[value & 0xF];
+    value >>= 4;
+  } while (value != 0);
+
+  for (size_t i = 0; i < length; i++)
+    buffer[i] = reversed[length - 1 - i];
+  buffer[length] = 0;
+  return length;
+}
+
+void format_httpDate(char *buffer, time_t time) {
+  struct tm timeInfo;
+  gmtime_r(&time, &timeInfo);
+
+  // Sun, 06 Nov 1994 08:49:37 GMT
+  char *current = buffer;
+  memcpy(current, format_days[timeInfo.tm_wday], 3);
+  current += 3;
+  *current++ = ',';
+  *current++ = ' ';
+  current = format_writeTwoDigits(current, timeInfo.tm_mday);
+  *current++ = ' ';
+  memcpy(current, format_months[timeInfo.tm_mon], 3);
+  current += 3;
+  *current++ = ' ';
+  int year = timeInfo.tm_year + 1900;
+  current = format_writeTwoDigits(current, (year / 100) % 100);
+  current = format_writeTwoDigits(current, year % 100);
+  *current++ = ' ';
+  current = format_writeTwoDigits(current, timeInfo.tm_hour);
+  *current++ = ':';
+  current = format_writeTwoDigits(current, timeInfo.tm_min);
+  *current++ = ':';
+  current = format_writeTwoDigits(current, timeInfo.tm_sec);
+  memcpy(current, " GMT", 5);
+}
+
+void format_commonLogDate(char *buffer, time_t time) {
+  struct tm timeInfo;
+  localtime_r(&time, &timeInfo);
+
+  // [10/Oct/2000:13:55:36 -0700]
+  char *current = buffer;
+  *current++ = '[';
+  current = format_writeTwoDigits(current, timeInfo.tm_mday);
+  *current++ = '/';
+  memcpy(current, format_months[timeInfo.tm_mon], 3);
+  current += 3;
+  *current++ = '/';
+  int year = timeInfo.tm_year + 1900;
+  current = format_writeTwoDigits(current, (year / 100) % 100);
+  current = format_writeTwoDigits(current, year % 100);
+  *current++ = ':';
+  current = format_writeTwoDigits(current, timeInfo.tm_hour);
+  *current++ = ':';
+  current = format_writeTwoDigits(current, timeInfo.tm_min);
+  *current++ = ':';
+  current = format_writeTwoDigits(current, timeInfo.tm_sec);
+  *current++ = ' ';
+
+  // The offset from UTC in hours and minutes
+  long offset = timeInfo.tm_gmtoff / 60;
+  *current++ = offset < 0 ? '-' : '+';
+  if (offset < 0)
+    offset = -offset;
+  current = format_writeTwoDigits(current, (int)(offset / 60) % 100);
+  current = format_writeTwoDigits(current, (int)(offset % 60));
+  memcpy(current, "]", 2);
+}
+
+bool format_parseHTTPDate(const char *buffer, size_t size, time_t *time) {
+  // Sun, 06 Nov 1994 08:49:37 GMT
+  if (size != FORMAT_HTTP_DATE_LENGTH - 1 || buffer[3] != ',' || buffer[4] != ' ' || buffer[7] != ' ' || buffer[11] != ' ' || buffer[16] != ' ' || buffer[19] != ':' || buffer[22] != ':' || memcmp(buffer + 25, " GMT", 4) != 0)
+    return false;
+
+  // The offsets of the two digit numbers: day, century, year, hour, minute and second
+  static const size_t offsets[6] = {5, 12, 14, 17, 20, 23};
+  int numbers[6];
+  for (size_t i = 0; i < 6; i++) {
+    char tens = buffer[offsets[i]];
+    char ones = buffer[offsets[i] + 1];
+    if (tens < '0' || tens > '9' || ones < '0' || ones > '9')
+      return false;
+    numbers[i] = (tens - '0') * 10 + (ones - '0');
+  }
+
+  int month = -1;
+  for (int i = 0; i < 12 && month == -1; i++) {
+    if (memcmp(buffer + 8, format_months[i], 3) == 0)
+      month = i;
+  }
+  if (month == -1)
+    return false;
+
+  struct tm timeInfo;
+  memset(&timeInfo, 0, sizeof(struct tm));
+  timeInfo.tm_mday = numbers[0];
+  timeInfo.tm_mon = month;
+  timeInfo.tm_year = numbers[1] * 100 + numbers[2] - 1900;
+  timeInfo.tm_hour = numbers[3];
+  timeInfo.tm_min = numbers[4];
+  timeInfo.tm_sec = numbers[5];
+  if (timeInfo.tm_mday < 1 || timeInfo.tm_mday > 31 || timeInfo.tm_hour > 23 || timeInfo.tm_min > 59 || timeInfo.tm_sec > 60)
+    return false;
+
+  *time = timegm(&timeInfo);
+  return *time != -1;
+}
+
+void format_getCurrentHTTPDate(char *buffer) {
+  time_t now = time(NULL);
+
+  pthread_mutex_lock(&format_cacheMutex);
+  if (now != format_httpDateSecond) {
+    format_httpDate(format_cachedHTTPDate, now);
+    format_httpDateSecond = now;
+  }
+  memcpy(buffer, format_cachedHTTPDate, FORMAT_HTTP_DATE_LENGTH);
+  pthread_mutex_unlock(&format_cacheMutex);
+}
+
+void format_getCurrentCommonLogDate(char *buffer) {
+  time_t now = time(NULL);
+
+  pthread_mutex_lock(&format_cacheMutex);
+  if (now != format_commonLogDateSecond) {
+    format_commonLogDate(format_cachedCommonLogDate, now);
+    format_commonLogDateSecond = now;
+  }
+  memcpy(buffer, format_cachedCommonLogDate, FORMAT_COMMON_LOG_DATE_LENGTH);
+  pthread_mutex_unlock(&format_cacheMutex);
+}
@@ -0,0 +1,35 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Large enough to hold any formatted 64-bit integer, including sign and null byte
+#define FORMAT_INTEGER_LENGTH 21
+// The length of an RFC 7231 date such as "Sun, 06 Nov 1994 08:49:37 GMT", including null byte
+#define FORMAT_HTTP_DATE_LENGTH 30
+// The length of a CLF timestamp such as "[10/Oct/2000:13:55:36 -0700]", including null byte
+#define FORMAT_COMMON_LOG_DATE_LENGTH 29
+
+// Format an unsigned integer in base 10. The buffer must hold FORMAT_INTEGER_LENGTH bytes. Returns the length
+size_t format_unsignedInteger(char *buffer, uint64_t value) __attribute__((nonnull(1)));
+// Format a signed integer in base 10. The buffer must hold FORMAT_INTEGER_LENGTH bytes. Returns the length
+size_t format_integer(char *buffer, int64_t value) __attribute__((nonnull(1)));
+// Format an unsigned integer in lowercase base 16. The buffer must hold FORMAT_INTEGER_LENGTH bytes. Returns the length
+size_t format_hexadecimal(char *buffer, uint64_t value) __attribute__((nonnull(1)));
+
+// Format a time as an RFC 7231 date (used by HTTP headers). The buffer must hold FORMAT_HTTP_DATE_LENGTH bytes
+void format_httpDate(char *buffer, time_t time) __attribute__((nonnull(1)));
+// Format a time as a CLF timestamp in local time. The buffer must hold FORMAT_COMMON_LOG_DATE_LENGTH bytes
+void format_commonLogDate(char *buffer, time_t time) __attribute__((nonnull(1)));
+// Parse an RFC 7231 date such as "Sun, 06 Nov 1994 08:49:37 GMT". The obsolete formats are not supported
+bool format_parseHTTPDate(const char *buffer, size_t size, time_t *time) __attribute__((nonnull(1, 3)));
+
+// Get the current time as an RFC 7231 date. Formatted at most once per second and shared by all threads
+void format_getCurrentHTTPDate(char *buffer) __attribute__((nonnull(1)));
+// Get the current time as a CLF timestamp. Formatted at most once per second and shared by all threads
+void format_getCurrentCommonLogDate(char *buffer) __attribute__((nonnull(1)));
+
+#endif
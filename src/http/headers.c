@@ -0,0 +1,96 @@
+#include "headers.h"
+
+// The size of the slot table, a power of two
+#define HTTP_HEADER_SLOTS 128
+
+// The canonical names of the well-known headers
+static const string_view_t http_headerNames[HTTP_HEADER_COUNT] = {
+    [HTTP_HEADER_UNKNOWN] = {"", 0},
+    [HTTP_HEADER_ACCEPT] = {"Accept", 6},
+    [HTTP_HEADER_ACCEPT_CHARSET] = {"Accept-Charset", 14},
+    [HTTP_HEADER_ACCEPT_ENCODING] = {"Accept-Encoding", 15},
+    [HTTP_HEADER_ACCEPT_LANGUAGE] = {"Accept-Language", 15},
+    [HTTP_HEADER_ACCEPT_RANGES] = {"Accept-Ranges", 13},
+    [HTTP_HEADER_AGE] = {"Age", 3},
+    [HTTP_HEADER_AUTHORIZATION] = {"Authorization", 13},
+    [HTTP_HEADER_CACHE_CONTROL] = {"Cache-Control", 13},
+    [HTTP_HEADER_CONNECTION] = {"Connection", 10},
+    [HTTP_HEADER_CONTENT_ENCODING] = {"Content-Encoding", 16},
+    [HTTP_HEADER_CONTENT_LANGUAGE] = {"Content-Language", 16},
+    [HTTP_HEADER_CONTENT_LENGTH] = {"Content-Length", 14},
+    [HTTP_HEADER_CONTENT_LOCATION] = {"Content-Location", 16},
+    [HTTP_HEADER_CONTENT_RANGE] = {"Content-Range", 13},
+    [HTTP_HEADER_CONTENT_TYPE] = {"Content-Type", 12},
+    [HTTP_HEADER_COOKIE] = {"Cookie", 6},
+    [HTTP_HEADER_DATE] = {"Date", 4},
+    [HTTP_HEADER_ETAG] = {"ETag", 4},
+    [HTTP_HEADER_EXPECT] = {"Expect", 6},
+    [HTTP_HEADER_EXPIRES] = {"Expires", 7},
+    [HTTP_HEADER_FORWARDED] = {"Forwarded", 9},
+    [HTTP_HEADER_HOST] = {"Host", 4},
+    [HTTP_HEADER_IF_MATCH] = {"If-Match", 8},
+    [HTTP_HEADER_IF_MODIFIED_SINCE] = {"If-Modified-Since", 17},
+    [HTTP_HEADER_IF_NONE_MATCH] = {"If-None-Match", 13},
+    [HTTP_HEADER_IF_RANGE] = {"If-Range", 8},
+    [HTTP_HEADER_IF_UNMODIFIED_SINCE] = {"If-Unmodified-Since", 19},
+    [HTTP_HEADER_KEEP_ALIVE] = {"Keep-Alive", 10},
+    [HTTP_HEADER_LAST_MODIFIED] = {"Last-Modified", 13},
+    [HTTP_HEADER_LOCATION] = {"Location", 8},
+    [HTTP_HEADER_ORIGIN] = {"Origin", 6},
+    [HTTP_HEADER_PRAGMA] = {"Pragma", 6},
+    [HTTP_HEADER_RANGE] = {"Range", 5},
+    [HTTP_HEADER_REFERER] = {"Referer", 7},
+    [HTTP_HEADER_RETRY_AFTER] = {"Retry-After", 11},
+    [HTTP_HEADER_SERVER] = {"Server", 6},
+    [HTTP_HEADER_SET_COOKIE] = {"Set-Cookie", 10},
+    [HTTP_HEADER_TRANSFER_ENCODING] = {"Transfer-Encoding", 17},
+    [HTTP_HEADER_UPGRADE] = {"Upgrade", 7},
+    [HTTP_HEADER_UPGRADE_INSECURE_REQUESTS] = {"Upgrade-Insecure-Requests", 25},
+    [HTTP_HEADER_USER_AGENT] = {"User-Agent", 10},
+    [HTTP_HEADER_VARY] = {"Vary", 4},
+    [HTTP_HEADER_VIA] = {"Via", 3},
+    [HTTP_HEADER_WWW_AUTHENTICATE] = {"WWW-Authenticate", 16},
+    [HTTP_HEADER_X_FORWARDED_FOR] = {"X-Forwarded-For", 15},
+    [HTTP_HEADER_X_FORWARDED_PROTO] = {"X-Forwarded-Proto", 17},
+};
+
+// The header in each slot of the perfect hash below. Every well-known header has a slot of its own,
+// so a lookup is a single comparison. The multipliers must be chosen anew whenever a header is added
+static const uint8_t http_headerSlots[HTTP_HEADER_SLOTS] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 35,  0, 40,  0,  0,  0,
+     0, 43,  9,  8,  0,  0,  0, 10,  0, 39,  0,  0,  0, 16,  0,  0,
+     0,  0, 29, 26,  0,  0, 23,  0,  0,  0, 11,  0,  0,  0, 34,  0,
+     0, 44,  0, 13,  0, 18, 30, 25,  0,  0, 33, 38,  0, 27, 15, 14,
+     0,  0,  5,  0, 24, 42,  0,  0,  0, 22,  0,  0,  0,  0,  0,  0,
+    19, 17, 21,  0, 46,  0,  0,  0,  6,  0,  0, 28, 20, 37, 31,  0,
+     3,  0,  0,  0,  1,  0,  2,  0,  0,  0,  0,  0, 32,  0, 12,  0,
+     0,  7,  0,  4,  0,  0,  0,  0, 41,  0,  0, 36,  0,  0,  0, 45,
+};
+
+// Perfect hash of the well-known header names, based on the length and the case-folded first,
+// middle and last characters
+static inline size_t http_hashHeaderName(string_view_t name) {
+  size_t first = (uint8_t)(name.buffer[0] | 0x20);
+  size_t middle = (uint8_t)(name.buffer[name.size / 2] | 0x20);
+  size_t last = (uint8_t)(name.buffer[name.size - 1] | 0x20);
+  return (name.size + first * 27 + middle * 3 + last) & (HTTP_HEADER_SLOTS - 1);
+}
+
+enum httpHeader http_parseHeaderName(string_view_t name) {
+  if (name.size == 0)
+    return HTTP_HEADER_UNKNOWN;
+
+  enum httpHeader header = http_headerSlots[http_hashHeaderName(name)];
+  string_view_t candidate = http_headerNames[header];
+  if (!string_view_equalsCaseInsensitive(candidate, name))
+    return HTTP_HEADER_UNKNOWN;
+
+  return header;
+}
+
+string_view_t http_getHeaderName(enum httpHeader header) {
+  if (header >= HTTP_HEADER_COUNT)
+    return http_headerNames[HTTP_HEADER_UNKNOWN];
+
+  return http_headerNames[header];
+}
@@ -0,0 +1,67 @@
+#ifndef HEADERS_H
+#define HEADERS_H
+
+#include <stdint.h>
+
+#include "../string/string.h"
+
+/**
+* Well-known header names, resolved to an ID once while parsing so that lookups of
+* these headers are array accesses rather than hash table lookups.
+*/
+
+enum httpHeader { HTTP_HEADER_UNKNOWN,
+                  HTTP_HEADER_ACCEPT,
+                  HTTP_HEADER_ACCEPT_CHARSET,
+                  HTTP_HEADER_ACCEPT_ENCODING,
+                  HTTP_HEADER_ACCEPT_LANGUAGE,
+                  HTTP_HEADER_ACCEPT_RANGES,
+                  HTTP_HEADER_AGE,
+                  HTTP_HEADER_AUTHORIZATION,
+                  HTTP_HEADER_CACHE_CONTROL,
+                  HTTP_HEADER_CONNECTION,
+                  HTTP_HEADER_CONTENT_ENCODING,
+                  HTTP_HEADER_CONTENT_LANGUAGE,
+                  HTTP_HEADER_CONTENT_LENGTH,
+                  HTTP_HEADER_CONTENT_LOCATION,
+                  HTTP_HEADER_CONTENT_RANGE,
+                  HTTP_HEADER_CONTENT_TYPE,
+                  HTTP_HEADER_COOKIE,
+                  HTTP_HEADER_DATE,
+                  HTTP_HEADER_ETAG,
+                  HTTP_HEADER_EXPECT,
+                  HTTP_HEADER_EXPIRES,
+                  HTTP_HEADER_FORWARDED,
+                  HTTP_HEADER_HOST,
+                  HTTP_HEADER_IF_MATCH,
+                  HTTP_HEADER_IF_MODIFIED_SINCE,
+                  HTTP_HEADER_IF_NONE_MATCH,
+                  HTTP_HEADER_IF_RANGE,
+                  HTTP_HEADER_IF_UNMODIFIED_SINCE,
+                  HTTP_HEADER_KEEP_ALIVE,
+                  HTTP_HEADER_LAST_MODIFIED,
+                  HTTP_HEADER_LOCATION,
+                  HTTP_HEADER_ORIGIN,
+                  HTTP_HEADER_PRAGMA,
+                  HTTP_HEADER_RANGE,
+                  HTTP_HEADER_REFERER,
+                  HTTP_HEADER_RETRY_AFTER,
+                  HTTP_HEADER_SERVER,
+                  HTTP_HEADER_SET_COOKIE,
+                  HTTP_HEADER_TRANSFER_ENCODING,
+                  HTTP_HEADER_UPGRADE,
+                  HTTP_HEADER_UPGRADE_INSECURE_REQUESTS,
+                  HTTP_HEADER_USER_AGENT,
+                  HTTP_HEADER_VARY,
+                  HTTP_HEADER_VIA,
+                  HTTP_HEADER_WWW_AUTHENTICATE,
+                  HTTP_HEADER_X_FORWARDED_FOR,
+                  HTTP_HEADER_X_FORWARDED_PROTO,
+                  HTTP_HEADER_COUNT };
+
+// Get the ID of a header name, ignoring case (HTTP_HEADER_UNKNOWN if it's not a well-known header)
+enum httpHeader http_parseHeaderName(string_view_t name);
+// Get the canonical name of a well-known header (an empty view for HTTP_HEADER_UNKNOWN)
+string_view_t http_getHeaderName(enum httpHeader header);
+
+#endif
@@ -2,12 +2,23 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../datastructures/arena/arena.h"
+#include "../format/format.h"
 #include "../logging/logging.h"
 
 #include "http.h"
 
+// Parse a non-negative number of a range. An empty view is parsed as 0
+bool http_parseRangeNumber(string_view_t view, uint64_t *number);
+// Whether or not the parameters of a list element, such as ";q=0.5", give it a weight of zero
+bool http_hasZeroWeight(string_view_t parameters);
+// Trim spaces and tabs from both ends of a view
+string_view_t http_trimView(string_view_t view);
+// Remove the header with the same name, ignoring case, freeing its value (if any)
+void http_removeHeaderIgnoringCase(http_t *http, string_view_t key);
+
 http_t *http_create() {
-  http_t *http = malloc(sizeof(http_t));
+  http_t *http = arena_malloc(sizeof(http_t));
   if (http == 0)
     return 0;
 
@@ -15,13 +26,140 @@ http_t *http_create() {
 
   http->headers = hash_table_create();
   if (http->headers == 0) {
-    free(http);
+    arena_release(http);
     return 0;
   }
 
   return http;
 }
 
+ssize_t http_parseRange(string_view_t range, uint64_t size, http_range_t *ranges, size_t maxRanges) {
+  // Only byte ranges are supported
+  if (!string_view_startsWithBuffer(range, "bytes="))
+    return -1;
+
+  size_t count = 0;
+  size_t specifiers = 0;
+  size_t offset = 6;
+  while (offset <= range.size) {
+    ssize_t end = string_view_findChar(range, offset, ',');
+    if (end == -1)
+      end = range.size;
+    string_view_t specifier = http_trimView(string_view_substring(range, offset, end));
+    offset = end + 1;
+
+    // Empty list elements are allowed
+    if (specifier.size == 0)
+      continue;
+    specifiers++;
+
+    ssize_t dash = string_view_findChar(specifier, 0, '-');
+    if (dash == -1)
+      return -1;
+
+    uint64_t first = 0;
+    uint64_t last = 0;
+    string_view_t firstView = string_view_substring(specifier, 0, dash);
+    string_view_t lastView = string_view_substring(specifier, dash + 1, specifier.size);
+    if ((firstView.size == 0 && lastView.size == 0) || !http_parseRangeNumber(firstView, &first) || !http_parseRangeNumber(lastView, &last))
+      return -1;
+
+    http_range_t parsedRange;
+    if (firstView.size == 0) {
+      // A suffix such as "-500" for the last 500 bytes
+      if (last == 0 || size == 0)
+        continue;
+      parsedRange.offset = last >= size ? 0 : size - last;
+      parsedRange.length = size - parsedRange.offset;
+    } else {
+      if (lastView.size != 0 && last < first)
+        return -1;
+      if (first >= size)
+        continue;
+      if (lastView.size == 0 || last >= size)
+        last = size - 1;
+      parsedRange.offset = first;
+      parsedRange.length = last - first + 1;
+    }
+
+    // Overlapping and adjacent ranges are merged so that no byte is sent more than once
+    size_t i = 0;
+    while (i < count) {
+      uint64_t end = ranges[i].offset + ranges[i].length;
+      uint64_t parsedEnd = parsedRange.offset + parsedRange.length;
+      if (parsedRange.offset > end || ranges[i].offset > parsedEnd) {
+        i++;
+        continue;
+      }
+
+      if (ranges[i].offset < parsedRange.offset)
+        parsedRange.offset = ranges[i].offset;
+      parsedRange.length = (end > parsedEnd ? end : parsedEnd) - parsedRange.offset;
+      memmove(&ranges[i], &ranges[i + 1], sizeof(http_range_t) * (count - i - 1));
+      count--;
+    }
+
+    if (count == maxRanges)
+      return -1;
+
+    // Keep the ranges ordered by offset
+    size_t index = count;
+    while (index > 0 && ranges[index - 1].offset > parsedRange.offset) {
+      ranges[index] = ranges[index - 1];
+      index--;
+    }
+    ranges[index] = parsedRange;
+    count++;
+  }
+
+  if (specifiers == 0)
+    return -1;
+
+  return count;
+}
+
+uint8_t http_parseAcceptEncoding(string_view_t acceptEncoding) {
+  uint8_t accepted = 0;
+  uint8_t rejected = 0;
+  bool acceptsAny = false;
+  size_t offset = 0;
+  while (offset < acceptEncoding.size) {
+    ssize_t end = string_view_findChar(acceptEncoding, offset, ',');
+    if (end == -1)
+      end = acceptEncoding.size;
+    string_view_t element = string_view_substring(acceptEncoding, offset, end);
+    offset = end + 1;
+
+    ssize_t parametersStart = string_view_findChar(element, 0, ';');
+    string_view_t parameters = {0, 0};
+    if (parametersStart != -1) {
+      parameters = string_view_substring(element, parametersStart + 1, element.size);
+      element = string_view_substring(element, 0, parametersStart);
+    }
+    string_view_t coding = http_trimView(element);
+    bool isRejected = http_hasZeroWeight(parameters);
+
+    uint8_t encoding = 0;
+    if (string_view_equalsBufferCaseInsensitive(coding, "gzip") || string_view_equalsBufferCaseInsensitive(coding, "x-gzip"))
+      encoding = HTTP_ENCODING_GZIP;
+    else if (string_view_equalsBufferCaseInsensitive(coding, "br"))
+      encoding = HTTP_ENCODING_BROTLI;
+    else if (string_view_equalsBuffer(coding, "*"))
+      acceptsAny = !isRejected;
+
+    if (isRejected)
+      rejected |= encoding;
+    else
+      accepted |= encoding;
+  }
+
+  // The wildcard matches any coding not explicitly listed
+  if (acceptsAny)
+    accepted |= (HTTP_ENCODING_GZIP | HTTP_ENCODING_BROTLI) & ~rejected;
+
+  return accepted & ~rejected;
+}
+
 void http_setMethod(http_t *http, enum httpMethod method) {
   http->method = method;
 }
@@ -51,13 +189,62 @@ uint16_t http_getResponseCode(const http_t *http) {
 }
 
 void http_setHeader(http_t *http, string_t *key, string_t *value) {
+  // Header names are case insensitive, so the header may already be set under a name cased differently. Well-known
+  // headers that are not set can't be
+  enum httpHeader header = http_parseHeaderName(string_getView(key));
+  if (header == HTTP_HEADER_UNKNOWN || http->knownHeaders[header] != 0)
+    http_removeHeaderIgnoringCase(http, string_getView(key));
+
   string_t *oldValue = hash_table_setValue(http->headers, key, value);
   if (oldValue != 0)
     string_free(oldValue);
+
+  if (header != HTTP_HEADER_UNKNOWN)
+    http->knownHeaders[header] = value;
+}
+
+void http_removeHeaderIgnoringCase(http_t *http, string_view_t key) {
+  size_t headers = hash_table_getLength(http->headers);
+  for (size_t i = 0; i < headers; i++) {
+    string_t *existingKey = hash_table_getKeyByIndex(http->headers, i);
+    if (!string_view_equalsCaseInsensitive(string_getView(existingKey), key))
+      continue;
+
+    // Only one entry per name is ever set
+    string_t *value = hash_table_removeValue(http->headers, existingKey);
+    if (value != 0)
+      string_free(value);
+    return;
+  }
+}
+
+void http_setHeaderById(http_t *http, enum httpHeader header, string_t *value) {
+  http_setHeader(http, string_fromView(http_getHeaderName(header)), value);
+}
+
+string_t *http_getHeaderById(const http_t *http, enum httpHeader header) {
+  if (header == HTTP_HEADER_UNKNOWN || header >= HTTP_HEADER_COUNT)
+    return 0;
+
+  return http->knownHeaders[header];
+}
+
+void http_setDate(http_t *http) {
+  char date[FORMAT_HTTP_DATE_LENGTH];
+  format_getCurrentHTTPDate(date);
+  http_setHeaderById(http, HTTP_HEADER_DATE, string_fromBufferWithLength(date, FORMAT_HTTP_DATE_LENGTH - 1));
 }
 
 string_t *http_getHeader(const http_t *http, const string_t *key) {
-  return hash_table_getValue(http->headers, key);
+  return http_getHeaderByView(http, string_getView(key));
+}
+
+string_t *http_getHeaderByView(const http_t *http, string_view_t key) {
+  enum httpHeader header = http_parseHeaderName(key);
+  if (header != HTTP_HEADER_UNKNOWN)
+    return http->knownHeaders[header];
+
+  return hash_table_getValueByView(http->headers, key);
 }
 
 void http_setBody(http_t *http, string_t *body) {
@@ -67,7 +254,7 @@ void http_setBody(http_t *http, string_t *body) {
   http->body = body;
   // Content-Length
   if (body != 0)
-    http_setHeader(http, string_fromBuffer("Content-Length"), string_fromInt(string_getSize(http->body)));
+    http_setHeaderById(http, HTTP_HEADER_CONTENT_LENGTH, string_fromInt(string_getSize(http->body)));
 }
 
 string_t *http_getBody(const http_t *http) {
@@ -91,10 +278,9 @@ string_t *http_toResponseString(const http_t *http) {
     string_appendChar(result, ' ');
   }
 
-  string_t *responseCode = string_fromInt(http->responseCode);
-
-  string_append(result, responseCode);
-  string_free(responseCode);
+  char responseCode[FORMAT_INTEGER_LENGTH];
+  size_t responseCodeLength = format_unsignedInteger(responseCode, http->responseCode);
+  string_appendBufferWithLength(result, responseCode, responseCodeLength);
   string_appendChar(result, ' ');
 
   if (http->responseCodeText != 0) {
@@ -123,135 +309,80 @@ string_t *http_toResponseString(const http_t *http) {
 }
 
 bool http_parseRequestLine(http_t *http, const string_t *string) {
-  char current = 0;
-  string_t *tempString = string_create();
-  if (tempString == 0)
-    return 0;
-  string_cursor_t *cursor = string_createCursor(string);
-  if (cursor == 0) {
-    string_free(tempString);
-    return 0;
-  }
+  string_view_t line = string_getView(string);
 
   // Parse method
-  // Reads untill a space is found or null char at end on line
-  while ((current = string_getNextChar(cursor)) != ' ' && current != 0)
-    string_appendChar(tempString, current);
-
-  if (current == 0) {
+  // Reads until a space is found or the end of the line
+  ssize_t methodEnd = string_view_findChar(line, 0, ' ');
+  if (methodEnd == -1) {
     log(LOG_ERROR, "Could not parse request. Missing path and/or version");
-    string_free(tempString);
-    string_freeCursor(cursor);
     return false;
   }
 
   // Convert from string to enum and sets method
-  http->method = http_parseMethod(tempString);
-  string_free(tempString);
+  http->method = http_parseMethodView(string_view_substring(line, 0, methodEnd));
 
   // Initialize https url struct
   if (http->url == 0)
     http->url = url_create();
   if (http->url == 0) {
     log(LOG_ERROR, "Could not initialize http's url struct");
-    string_freeCursor(cursor);
     return false;
   }
   url_setProtocol(http->url, string_fromBuffer("http"));
 
   // Get the path and parameters
-  // Reads untill a space is found or null char at end on line
-  string_t *requestTarget = string_create();
-  if (requestTarget == 0) {
-    string_freeCursor(cursor);
-    return false;
-  }
-
-  while ((current = string_getNextChar(cursor)) != ' ' && current != 0)
-    string_appendChar(requestTarget, current);
-
-  if (current == 0) {
+  // Reads until a space is found or the end of the line
+  ssize_t requestTargetEnd = string_view_findChar(line, methodEnd + 1, ' ');
+  if (requestTargetEnd == -1) {
     log(LOG_ERROR, "Could not parse request. Missing version");
-    string_freeCursor(cursor);
-    string_free(requestTarget);
     return false;
   }
 
   // Parse path and parameters (request target)
-  bool correctlyParsed = http_parseRequestTarget(http, requestTarget);
+  bool correctlyParsed = http_parseRequestTargetView(http, string_view_substring(line, methodEnd + 1, requestTargetEnd));
   if (correctlyParsed == false) {
     log(LOG_ERROR, "Could not parse path and optional parameters");
-    string_freeCursor(cursor);
-    string_free(requestTarget);
     return false;
   }
-  string_free(requestTarget);
 
   // Parse version
-  // Reads until null char at end on line
-  string_t *versionString = string_create();
-  if (versionString == 0) {
-    return false;
-  }
+  // Reads until the end of the line
+  string_view_t versionString = string_view_substring(line, requestTargetEnd + 1, line.size);
 
-  while ((current = string_getNextChar(cursor)) != 0)
-    string_appendChar(versionString, current);
-  // Free cursor, not in use anny more
-  string_freeCursor(cursor);
-
-  // Check to see if the version starts with HTTP/
-  string_t *compareString = string_substring(versionString, 0, 5);
-  if (compareString == 0) {
-    log(LOG_ERROR, "Could not parse HTTP version. Unknown value was passed");
-    string_free(versionString);
-    return false;
-  }
   // If the version does not start with "HTTP/" then exit
-  if (string_equalsBuffer(compareString, "HTTP/") == false) {
+  if (string_view_startsWithBuffer(versionString, "HTTP/") == false) {
     log(LOG_ERROR, "Could not parse request version. Invalid input missing version");
-    if (compareString != 0)
-      string_free(compareString);
-    if (versionString != 0)
-      string_free(versionString);
     return false;
   }
-  string_free(compareString);
 
-  string_t *version = string_substring(versionString, 5, 8);
-  if (version == 0) {
+  string_view_t version = string_view_substring(versionString, 5, 8);
+  if (version.size != 3) {
     log(LOG_ERROR, "Could not parse request version. Invalid input missing version");
-    string_free(versionString);
     return false;
   }
 
   // The three chars after HTTP/ must be in the order: '[0-9]\.[0-9]'
-  bool firstCharIsNotInt = string_getCharAt(version, 0) < '0' || string_getCharAt(version, 0) > '9';
-  bool secondCharIsNotDot = string_getCharAt(version, 1) != '.';
-  bool thirdCharIsNotInt = string_getCharAt(version, 2) < '0' || string_getCharAt(version, 0) > '9';
+  bool firstCharIsNotInt = version.buffer[0] < '0' || version.buffer[0] > '9';
+  bool secondCharIsNotDot = version.buffer[1] != '.';
+  bool thirdCharIsNotInt = version.buffer[2] < '0' || version.buffer[2] > '9';
 
   if (firstCharIsNotInt || secondCharIsNotDot || thirdCharIsNotInt) {
     log(LOG_ERROR, "Could not parse request version. Invalid version number");
-    string_free(version);
-    string_free(versionString);
     return false;
   }
 
   // Set the version
-  http_setVersion(http, version);
+  http_setVersion(http, string_fromView(version));
 
-  string_free(versionString);
   return true;
 }
 
 bool http_parseHeader(http_t *http, const string_t *string) {
-  string_cursor_t *cursor = string_createCursor(string);
-  if (cursor == 0)
-    return false;
-
-  ssize_t offset = string_findNextChar(cursor, ':');
-  string_freeCursor(cursor);
+  string_view_t header = string_getView(string);
 
   // Get the offset for the : if it exesists
+  ssize_t offset = string_view_findChar(header, 0, ':');
   if (offset == -1) {
     log(LOG_ERROR, "Could not find : in header");
     return false;
@@ -263,15 +394,22 @@ bool http_parseHeader(http_t *http, const string_t *string) {
     return false;
   }
 
-  size_t stringLength = string_getSize(string);
-  string_t *key = string_substring(string, 0, offset);
   // + 2 to skip the space
-  string_t *value = string_substring(string, offset + 2, stringLength);
-  if (value == 0) {
+  if ((size_t)offset + 2 >= header.size) {
     log(LOG_ERROR, "The header's value could not be parsed");
     return false;
   }
 
+  string_t *key = string_fromView(string_view_substring(header, 0, offset));
+  string_t *value = string_fromView(string_view_substring(header, offset + 2, header.size));
+  if (key == 0 || value == 0) {
+    if (key != 0)
+      string_free(key);
+    if (value != 0)
+      string_free(value);
+    return false;
+  }
+
   http_setHeader(http, key, value);
   return true;
 }
@@ -284,99 +422,90 @@ void http_parseBody(http_t *http, const string_t *string, size_t offset) {
 }
 
 bool http_parseRequestTarget(http_t *http, const string_t *requestTarget) {
-  string_cursor_t *requestCursor = string_createCursor(requestTarget);
-  ssize_t firstParameter = string_findNextChar(requestCursor, '?');
+  return http_parseRequestTargetView(http, string_getView(requestTarget));
+}
 
-  string_t *path = 0;
+bool http_parseRequestTargetView(http_t *http, string_view_t requestTarget) {
+  ssize_t firstParameter = string_view_findChar(requestTarget, 0, '?');
   if (firstParameter == -1) {
-    path = string_substring(requestTarget, 0, string_getSize(requestTarget));
-    url_setPath(http->url, path);
-  } else {
-    path = string_substring(requestTarget, 0, firstParameter);
-    url_setPath(http->url, path);
-
-    // If there is nothing more that a ? at the end, we set the path and return as there is no url parameters
-    char current = 0;
-    if ((current = string_getNextChar(requestCursor)) == 0) {
-      string_freeCursor(requestCursor);
-      return true;
-    }
+    url_setPath(http->url, string_fromView(requestTarget));
+    return true;
   }
 
-  ssize_t secondParameter = 0;
-  string_t *value = 0;
-  string_t *key = 0;
-  while (firstParameter != -1) {
-    secondParameter = firstParameter + 1;
-    firstParameter = string_findNextChar(requestCursor, '=');
-    if (firstParameter == -1) {
-      string_freeCursor(requestCursor);
+  url_setPath(http->url, string_fromView(string_view_substring(requestTarget, 0, firstParameter)));
+
+  // Parse each key=value pair, separated by &. If there is nothing more than a ? at the end, there are no parameters
+  size_t offset = firstParameter + 1;
+  while (offset < requestTarget.size) {
+    ssize_t keyEnd = string_view_findChar(requestTarget, offset, '=');
+    if (keyEnd == -1)
       return false;
-    }
-    key = string_substring(requestTarget, secondParameter, firstParameter);
-
-    secondParameter = firstParameter + 1;
-    firstParameter = string_findNextChar(requestCursor, '&');
-    if (firstParameter == -1) {
-      value = string_substring(requestTarget, secondParameter, string_getSize(requestTarget));
-      url_setParameter(http->url, key, value);
-      break;
-    }
 
-    value = string_substring(requestTarget, secondParameter, firstParameter);
+    ssize_t valueEnd = string_view_findChar(requestTarget, keyEnd + 1, '&');
+    if (valueEnd == -1)
+      valueEnd = requestTarget.size;
+
+    string_t *key = string_fromView(string_view_substring(requestTarget, offset, keyEnd));
+    string_t *value = string_fromView(string_view_substring(requestTarget, keyEnd + 1, valueEnd));
+    if (key == 0 || value == 0) {
+      if (key != 0)
+        string_free(key);
+      if (value != 0)
+        string_free(value);
+      return false;
+    }
     url_setParameter(http->url, key, value);
+
+    offset = valueEnd + 1;
   }
 
-  string_freeCursor(requestCursor);
   return true;
 }
 
 bool http_parseHost(http_t *http) {
-  string_t *keyHost = string_fromBuffer("Host");
-  string_t *host = hash_table_getValue(http->headers, keyHost);
-  string_free(keyHost);
+  string_t *host = http_getHeaderById(http, HTTP_HEADER_HOST);
   if (host == 0) {
     log(LOG_ERROR, "Can not parse. Host key was not set");
     return false;
   }
 
-  string_cursor_t *hostCursor = string_createCursor(host);
-  ssize_t parameter = string_findNextChar(hostCursor, ':');
-  string_freeCursor(hostCursor);
+  string_view_t hostView = string_getView(host);
+  ssize_t parameter = string_view_findChar(hostView, 0, ':');
   if (http->url == 0)
     http->url = url_create();
   if (parameter == -1) {
     url_setPort(http->url, 80);
-    url_setDomainName(http->url, string_fromBuffer(string_getBuffer(host)));
+    url_setDomainName(http->url, string_copy(host));
   } else {
-    // parameter + 1 to skip colon
-    string_t *portString = string_substring(host, parameter + 1, string_getSize(host));
-    int port = atoi(string_getBuffer(portString));
-    string_free(portString);
+    // parameter + 1 to skip colon. The host is null terminated, so the port can be parsed in place
+    int port = atoi(string_getBuffer(host) + parameter + 1);
     if (port < 0 || port > 1 << 16) {
       log(LOG_DEBUG, "The port in the request was to large");
       return false;
     }
     url_setPort(http->url, port);
-    string_t *domainName = string_substring(host, 0, parameter);
-    url_setDomainName(http->url, domainName);
+    url_setDomainName(http->url, string_fromView(string_view_substring(hostView, 0, parameter)));
   }
   return true;
 }
 
 enum httpMethod http_parseMethod(const string_t *method) {
-  if (string_equalsBuffer(method, "GET") == 1)
+  return http_parseMethodView(string_getView(method));
+}
+
+enum httpMethod http_parseMethodView(string_view_t method) {
+  if (string_view_equalsBuffer(method, "GET"))
     return HTTP_METHOD_GET;
-  if (string_equalsBuffer(method, "PUT") == 1)
+  if (string_view_equalsBuffer(method, "PUT"))
     return HTTP_METHOD_PUT;
-  if (string_equalsBuffer(method, "POST") == 1)
+  if (string_view_equalsBuffer(method, "POST"))
     return HTTP_METHOD_POST;
-  if (string_equalsBuffer(method, "HEAD") == 1)
+  if (string_view_equalsBuffer(method, "HEAD"))
     return HTTP_METHOD_HEAD;
-  if (string_equalsBuffer(method, "OPTIONS") == 1)
+  if (string_view_equalsBuffer(method, "OPTIONS"))
     return HTTP_METHOD_OPTIONS;
 
-  log(LOG_ERROR, "Could not parse http method '%s'", string_getBuffer(method));
+  log(LOG_ERROR, "Could not parse http method '%.*s'", (int)method.size, method.buffer);
   return HTTP_METHOD_UNKNOWN;
 }
 
@@ -414,5 +543,56 @@ void http_free(http_t *http) {
   if (http->url != 0)
     url_free(http->url);
 
-  free(http);
+  arena_release(http);
+}
+
+bool http_parseRangeNumber(string_view_t view, uint64_t *number) {
+  *number = 0;
+  for (size_t i = 0; i < view.size; i++) {
+    char digit = view.buffer[i];
+    if (digit < '0' || digit > '9')
+      return false;
+    // Guard against overflow
+    if (*number > (UINT64_MAX - 9) / 10)
+      return false;
+    *number = *number * 10 + (digit - '0');
+  }
+
+  return true;
+}
+
+bool http_hasZeroWeight(string_view_t parameters) {
+  size_t offset = 0;
+  while (offset < parameters.size) {
+    ssize_t end = string_view_findChar(parameters, offset, ';');
+    if (end == -1)
+      end = parameters.size;
+    string_view_t parameter = http_trimView(string_view_substring(parameters, offset, end));
+    offset = end + 1;
+
+    if (parameter.size < 2 || (parameter.buffer[0] != 'q' && parameter.buffer[0] != 'Q') || parameter.buffer[1] != '=')
+      continue;
+
+    // A weight of zero is "0" optionally followed by a dot and up to three zeros
+    string_view_t weight = string_view_substring(parameter, 2, parameter.size);
+    if (weight.size == 0 || weight.size > 5 || weight.buffer[0] != '0')
+      return false;
+    if (weight.size > 1 && weight.buffer[1] != '.')
+      return false;
+    for (size_t i = 2; i < weight.size; i++) {
+      if (weight.buffer[i] != '0')
+        return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+string_view_t http_trimView(string_view_t view) {
+  while (view.size > 0 && (view.buffer[0] == ' ' || view.buffer[0] == '\t'))
+    view = string_view_substring(view, 1, view.size);
+  while (view.size > 0 && (view.buffer[view.size - 1] == ' ' || view.buffer[view.size - 1] == '\t'))
+    view.size--;
+  return view;
 }
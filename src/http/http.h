@@ -8,6 +8,7 @@
 #include "../url/url.h"
 #include "../datastructures/hash-table/hash-table.h"
 
+#include "headers.h"
 #include "response-codes.h"
 
 enum httpMethod { HTTP_METHOD_UNKNOWN,
@@ -24,10 +25,25 @@ typedef struct {
   // Only for internal use
   string_t *responseCodeText;
   hash_table_t *headers;
+  // The values of the well-known headers, owned by headers
+  string_t *knownHeaders[HTTP_HEADER_COUNT];
   string_t *body;
   url_t *url;
 } http_t;
 
+// The maximum number of ranges served in one response. Requests for more ranges are served the whole resource
+#define HTTP_MAX_RANGES 16
+
+// Content codings accepted by a client (see http_parseAcceptEncoding)
+#define HTTP_ENCODING_GZIP 1
+#define HTTP_ENCODING_BROTLI 2
+
+// A range of bytes of a resource (see http_parseRange)
+typedef struct {
+  uint64_t offset;
+  uint64_t length;
+} http_range_t;
+
 http_t *http_create();
 
 http_t *http_parseRequest(const string_t *request) __attribute__((nonnull(1)));
@@ -35,10 +51,19 @@ bool http_parseRequestLine(http_t *http, const string_t *string) __attribute__((
 bool http_parseHeader(http_t *http, const string_t *string) __attribute__((nonnull(1, 2)));
 void http_parseBody(http_t *http, const string_t *string, size_t offset) __attribute__((nonnull(1, 2)));
 bool http_parseRequestTarget(http_t *http, const string_t *requestTarget) __attribute__((nonnull(1, 2)));
+bool http_parseRequestTargetView(http_t *http, string_view_t requestTarget) __attribute__((nonnull(1)));
 bool http_parseHost(http_t *http) __attribute__((nonnull(1)));
 bool http_parseUrl(http_t *http) __attribute__((nonnull(1)));
 enum httpMethod http_parseMethod(const string_t *method) __attribute__((nonnull(1)));
+enum httpMethod http_parseMethodView(string_view_t method);
 string_t *http_methodToString(enum httpMethod method);
+// Parse a Range header such as "bytes=0-99,-500" for a resource of size bytes, skipping unsatisfiable ranges.
+// Overlapping and adjacent ranges are merged and the ranges are ordered by offset.
+// Returns the number of ranges, 0 if none are satisfiable (416) or -1 if the header is invalid or
+// requests more than maxRanges ranges, in which case it should be ignored
+ssize_t http_parseRange(string_view_t range, uint64_t size, http_range_t *ranges, size_t maxRanges) __attribute__((nonnull(3)));
+// Parse an Accept-Encoding header such as "gzip, br;q=0.8, *;q=0". Returns the accepted codings (HTTP_ENCODING_*)
+uint8_t http_parseAcceptEncoding(string_view_t acceptEncoding);
 
 void http_setMethod(http_t *http, enum httpMethod method) __attribute__((nonnull(1)));
 enum httpMethod http_getMethod(const http_t *http) __attribute__((nonnull(1)));
@@ -53,6 +78,14 @@ uint16_t http_getResponseCode(const http_t *http) __attribute__((nonnull(1)));
 // The key and value is owned
 void http_setHeader(http_t *http, string_t *key, string_t *value) __attribute__((nonnull(1, 2)));
 string_t *http_getHeader(const http_t *http, const string_t *key) __attribute__((nonnull(1, 2)));
+// Get a header without having to create a string for the key
+string_t *http_getHeaderByView(const http_t *http, string_view_t key) __attribute__((nonnull(1)));
+// The value is owned
+void http_setHeaderById(http_t *http, enum httpHeader header, string_t *value) __attribute__((nonnull(1)));
+// Get a well-known header without a hash table lookup
+string_t *http_getHeaderById(const http_t *http, enum httpHeader header) __attribute__((nonnull(1)));
+// Set the Date header to the current time
+void http_setDate(http_t *http) __attribute__((nonnull(1)));
 
 // The body is owned
 void http_setBody(http_t *http, string_t *body) __attribute__((nonnull(1)));
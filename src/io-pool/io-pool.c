@@ -0,0 +1,224 @@
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#include "../logging/logging.h"
+
+#include "io-pool.h"
+
+// A worker waiting for a job (see io_pool_cancelWait)
+typedef struct {
+  io_pool_t *pool;
+  io_pool_job_t *job;
+} io_pool_wait_t;
+
+static io_pool_t *io_pool_globalPool = 0;
+static pthread_once_t io_pool_globalPoolOnce = PTHREAD_ONCE_INIT;
+
+// The main entry point of an I/O thread
+void *io_pool_entryPoint(io_pool_t *pool);
+// Create the global pool (see pthread_once)
+void io_pool_createGlobalPool();
+// Add a job to the queue. The pool must be locked
+void io_pool_enqueue(io_pool_t *pool, io_pool_job_t *job);
+// Leave a job to the I/O thread when a waiting worker is cancelled (see pthread_cleanup_push)
+void io_pool_cancelWait(io_pool_wait_t *wait);
+
+io_pool_t *io_pool_create(size_t threads) {
+  io_pool_t *pool = malloc(sizeof(io_pool_t));
+  if (pool == 0) {
+    log(LOG_ERROR, "Failed to allocate I/O pool");
+    return 0;
+  }
+  memset(pool, 0, sizeof(io_pool_t));
+  pool->shouldRun = true;
+
+  // Wait for jobs using the monotonic clock so that timeouts are not affected by changes to the system time
+  pthread_condattr_t conditionAttributes;
+  pthread_condattr_init(&conditionAttributes);
+  pthread_condattr_setclock(&conditionAttributes, CLOCK_MONOTONIC);
+  if (pthread_mutex_init(&pool->mutex, NULL) != 0 || pthread_cond_init(&pool->queued, NULL) != 0 || pthread_cond_init(&pool->done, &conditionAttributes) != 0) {
+    log(LOG_ERROR, "Failed to create synchronization primitives for I/O pool");
+    pthread_condattr_destroy(&conditionAttributes);
+    free(pool);
+    return 0;
+  }
+  pthread_condattr_destroy(&conditionAttributes);
+
+  // Leave the close, reload and drain signals to the server's main thread (see worker_spawn)
+  sigset_t signals;
+  sigset_t previousSignals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigaddset(&signals, SIGHUP);
+  sigaddset(&signals, SIGUSR2);
+  pthread_sigmask(SIG_BLOCK, &signals, &previousSignals);
+
+  if (threads > IO_POOL_THREADS)
+    threads = IO_POOL_THREADS;
+  for (size_t i = 0; i < threads; i++) {
+    if (pthread_create(&pool->threads[pool->threadCount], NULL, (void *(*)(void *))io_pool_entryPoint, pool) != 0) {
+      log(LOG_ERROR, "Unable to start thread %zu for I/O pool", i);
+      continue;
+    }
+    pool->threadCount++;
+  }
+  pthread_sigmask(SIG_SETMASK, &previousSignals, 0);
+
+  if (pool->threadCount == 0) {
+    io_pool_free(pool);
+    return 0;
+  }
+
+  log(LOG_DEBUG, "Started %zu I/O threads", pool->threadCount);
+  return pool;
+}
+
+bool io_pool_run(io_pool_t *pool, io_pool_job_t *job, int timeout) {
+  job->isDone = false;
+  job->isAbandoned = false;
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += timeout / 1000;
+  deadline.tv_nsec += (timeout % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  io_pool_enqueue(pool, job);
+  // Waiting is a cancellation point - a cancelled worker must leave the job and the lock behind
+  io_pool_wait_t wait = {pool, job};
+  pthread_cleanup_push((void (*)(void *))io_pool_cancelWait, &wait);
+  while (!job->isDone) {
+    if (pthread_cond_timedwait(&pool->done, &pool->mutex, &deadline) == ETIMEDOUT && !job->isDone) {
+      // Leave the job to the I/O thread
+      job->isAbandoned = true;
+      pool->timedOutJobs++;
+      log(LOG_WARNING, "Disk I/O timed out after %dms (%zu queued jobs)", timeout, pool->queueLength);
+      break;
+    }
+  }
+  pthread_cleanup_pop(0);
+  // An abandoned job may be freed as soon as the lock is released
+  bool isDone = job->isDone;
+  pthread_mutex_unlock(&pool->mutex);
+
+  return isDone;
+}
+
+void io_pool_submit(io_pool_t *pool, io_pool_job_t *job) {
+  job->isDone = false;
+  job->isAbandoned = true;
+
+  pthread_mutex_lock(&pool->mutex);
+  if (pool->queueLength >= IO_POOL_MAX_QUEUE_LENGTH) {
+    pool->droppedJobs++;
+    pthread_mutex_unlock(&pool->mutex);
+    job->abandon(job);
+    return;
+  }
+  io_pool_enqueue(pool, job);
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+size_t io_pool_getQueueLength(io_pool_t *pool) {
+  pthread_mutex_lock(&pool->mutex);
+  size_t queueLength = pool->queueLength;
+  pthread_mutex_unlock(&pool->mutex);
+  return queueLength;
+}
+
+void io_pool_free(io_pool_t *pool) {
+  pthread_mutex_lock(&pool->mutex);
+  pool->shouldRun = false;
+  pthread_cond_broadcast(&pool->queued);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (size_t i = 0; i < pool->threadCount; i++)
+    pthread_join(pool->threads[i], NULL);
+
+  pthread_cond_destroy(&pool->queued);
+  pthread_cond_destroy(&pool->done);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool);
+}
+
+io_pool_t *io_pool_getGlobalPool() {
+  pthread_once(&io_pool_globalPoolOnce, io_pool_createGlobalPool);
+  return io_pool_globalPool;
+}
+
+bool io_pool_hasGlobalPool() {
+  return io_pool_globalPool != 0;
+}
+
+void *io_pool_entryPoint(io_pool_t *pool) {
+  pthread_mutex_lock(&pool->mutex);
+  while (true) {
+    // Finish the queued jobs before exiting
+    while (pool->first == 0 && pool->shouldRun)
+      pthread_cond_wait(&pool->queued, &pool->mutex);
+    if (pool->first == 0)
+      break;
+
+    io_pool_job_t *job = pool->first;
+    pool->first = job->next;
+    if (pool->first == 0)
+      pool->last = 0;
+    pool->queueLength--;
+    pool->runningJobs++;
+    pthread_mutex_unlock(&pool->mutex);
+
+    job->run(job);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->runningJobs--;
+    pool->completedJobs++;
+    if (job->isAbandoned) {
+      pthread_mutex_unlock(&pool->mutex);
+      job->abandon(job);
+      pthread_mutex_lock(&pool->mutex);
+    } else {
+      job->isDone = true;
+      pthread_cond_broadcast(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return 0;
+}
+
+void io_pool_createGlobalPool() {
+  io_pool_globalPool = io_pool_create(IO_POOL_THREADS);
+}
+
+void io_pool_cancelWait(io_pool_wait_t *wait) {
+  // The lock is held again once cancelled while waiting
+  bool isDone = wait->job->isDone;
+  if (!isDone)
+    wait->job->isAbandoned = true;
+  pthread_mutex_unlock(&wait->pool->mutex);
+
+  // Nobody is left to free a finished job
+  if (isDone)
+    wait->job->abandon(wait->job);
+}
+
+void io_pool_enqueue(io_pool_t *pool, io_pool_job_t *job) {
+  job->next = 0;
+  if (pool->last != 0)
+    pool->last->next = job;
+  else
+    pool->first = job;
+  pool->last = job;
+
+  pool->queueLength++;
+  if (pool->queueLength > pool->maxQueueLength)
+    pool->maxQueueLength = pool->queueLength;
+  pthread_cond_signal(&pool->queued);
+}
@@ -0,0 +1,76 @@
+#ifndef IO_POOL_H
+#define IO_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+* A small pool of threads performing disk I/O (open, stat, read ahead) on behalf of the workers.
+* A worker waits for its job with a timeout, so that a slow disk or network file system can't hold it
+* indefinitely. Jobs the worker stopped waiting for are finished and cleaned up by the I/O thread.
+* Jobs may also be submitted without waiting, such as reading ahead the next part of a file being sent.
+*/
+
+// The number of I/O threads of each process
+#define IO_POOL_THREADS 4
+// The maximum time in milliseconds a worker waits for a job
+#define IO_POOL_TIMEOUT 10000
+// The maximum number of queued jobs. Jobs submitted without waiting are dropped beyond this
+#define IO_POOL_MAX_QUEUE_LENGTH 1024
+
+typedef struct io_pool_job_t {
+  // Perform the job. Called on an I/O thread
+  void (*run)(struct io_pool_job_t *job);
+  // Clean up and free a job nobody waits for once it's done. Called on an I/O thread
+  void (*abandon)(struct io_pool_job_t *job);
+  // Only for internal use
+  bool isDone;
+  bool isAbandoned;
+  struct io_pool_job_t *next;
+} io_pool_job_t;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  // Signalled when a job is queued
+  pthread_cond_t queued;
+  // Signalled when a job is done
+  pthread_cond_t done;
+  io_pool_job_t *first;
+  io_pool_job_t *last;
+  pthread_t threads[IO_POOL_THREADS];
+  size_t threadCount;
+  bool shouldRun;
+
+  // Metrics
+  // The number of queued jobs
+  size_t queueLength;
+  // The largest number of queued jobs
+  size_t maxQueueLength;
+  // The number of jobs being run
+  size_t runningJobs;
+  size_t completedJobs;
+  // The number of jobs a worker stopped waiting for
+  size_t timedOutJobs;
+  // The number of jobs dropped as the queue was full
+  size_t droppedJobs;
+} io_pool_t;
+
+// Create a pool of threads. Returns 0 if not a single thread could be started
+io_pool_t *io_pool_create(size_t threads);
+// Run a job and wait for it for at most timeout milliseconds. The job is freed by the caller if done.
+// Returns false if timed out, in which case the job is abandoned (see io_pool_job_t)
+bool io_pool_run(io_pool_t *pool, io_pool_job_t *job, int timeout) __attribute__((nonnull(1, 2)));
+// Submit a job without waiting for it. The job is abandoned once done or immediately if the queue is full
+void io_pool_submit(io_pool_t *pool, io_pool_job_t *job) __attribute__((nonnull(1, 2)));
+// Get the number of queued jobs
+size_t io_pool_getQueueLength(io_pool_t *pool) __attribute__((nonnull(1)));
+// Stop the threads once the queued jobs are done and free the pool
+void io_pool_free(io_pool_t *pool) __attribute__((nonnull(1)));
+
+// Get the pool of the process, creating it if necessary (0 if it could not be created)
+io_pool_t *io_pool_getGlobalPool();
+// Whether or not the pool of the process has been created
+bool io_pool_hasGlobalPool();
+
+#endif
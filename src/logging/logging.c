@@ -2,6 +2,8 @@
 #include <stdarg.h>
 #include <time.h>
 
+#include "../format/format.h"
+
 #include "logging.h"
 
 // Enable the console logger by default
@@ -90,20 +92,13 @@ void logging_logToFile(FILE *filePointer, const char *label, int color, const ch
   pthread_mutex_unlock(&mutex);
 }
 
-void logging_request(const string_t *remoteHost, enum httpMethod method, const string_t *path, const string_t *version, uint16_t responseCode, size_t bytesSent) {
-  // Get current time
-  time_t rawTime = time(NULL);
-  // Convert time to local time
-  struct tm *timeInfo = localtime(&rawTime);
-
-  char timeBuffer[29];
-  // Append to buffer the timeformat we want (CLF)
-  // The day is 2 characters, the month 3, the year 4, hours 2, minute 2, second 2 and time zone 4
-  // This, space character brackets, etc. and null adds up to 29 characters
-  strftime(timeBuffer, 29, "[%d/%b/%Y:%H:%M:%S %z]", timeInfo);
+void logging_request(const char *remoteHost, enum httpMethod method, const string_t *path, const string_t *version, uint16_t responseCode, size_t bytesSent) {
+  // The timestamp is formatted once per second and shared by all threads
+  char timeBuffer[FORMAT_COMMON_LOG_DATE_LENGTH];
+  format_getCurrentCommonLogDate(timeBuffer);
 
   string_t *methodString = http_methodToString(method);
-  logRaw(LOG_NOTICE, "%s - - %s \"%s %s HTTP/%s\" %d %zu", remoteHost == 0 ? "-" : string_getBuffer(remoteHost), timeBuffer, methodString == 0 ? "-" : string_getBuffer(methodString), path == 0 ? "-" : string_getBuffer(path), version == 0 ? "-" : string_getBuffer(version), responseCode, bytesSent);
+  logRaw(LOG_NOTICE, "%s - - %s \"%s %s HTTP/%s\" %d %zu", remoteHost == 0 ? "-" : remoteHost, timeBuffer, methodString == 0 ? "-" : string_getBuffer(methodString), path == 0 ? "-" : string_getBuffer(path), version == 0 ? "-" : string_getBuffer(version), responseCode, bytesSent);
 
   if (methodString != 0)
     string_free(methodString);
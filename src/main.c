@@ -1,7 +1,9 @@
 #include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -12,6 +14,7 @@
 #include "config/config.h"
 #include "daemon/daemon.h"
 #include "logging/logging.h"
+#include "resources/mime.h"
 #include "resources/resources.h"
 #include "server/server.h"
 #include "string/string.h"
@@ -20,7 +23,17 @@
 #include "main.h"
 
 bool main_serverShouldRun = true;
-pid_t main_serverInstance = 0;
+// Set when SIGUSR2 asks for the server instances to be replaced
+volatile bool main_serverShouldReload = false;
+// Set when SIGHUP asks for the config to be reloaded
+volatile bool main_configShouldReload = false;
+// One process per server instance (0 if not running)
+pid_t *main_serverInstances = 0;
+// The listening sockets of each instance, kept open across restarts
+list_t **main_serverListeningSockets = 0;
+size_t main_serverInstanceCount = 0;
+// Replaced instances that are finishing in-flight work
+list_t *main_drainingInstances = 0;
 
 int main(int argc, char const *argv[]) {
   // Start internal time keeping
@@ -106,7 +119,11 @@ int main(int argc, char const *argv[]) {
       config = config_parse(string_getBuffer(configFile));
       string_free(configFile);
     }
-    string_free(configFilePath);
+    // Keep the path in order to reload the config (see SIGHUP)
+    if (config != 0)
+      config_setFilePath(config, configFilePath);
+    else
+      string_free(configFilePath);
   }
 
   if (config == 0) {
@@ -125,6 +142,16 @@ int main(int argc, char const *argv[]) {
     config_setLoggingLevel(config, LOG_DEBUG);
   config_setGlobalConfig(config);
 
+  // The MIME types are only read at start, before any lookups are made
+  hash_table_t *mimeTypes = config_getMIMETypes(config);
+  if (mimeTypes != 0) {
+    for (size_t i = 0; i < hash_table_getLength(mimeTypes); i++) {
+      string_t *extension = hash_table_getKeyByIndex(mimeTypes, i);
+      string_t *type = hash_table_getValueByIndex(mimeTypes, i);
+      mime_addType(string_getBuffer(extension), string_getBuffer(type));
+    }
+  }
+
   LOGGING_LEVEL = config_getLoggingLevel(config);
   logfile = config_getLogfile(config);
   if (logfile != 0)
@@ -164,15 +191,48 @@ int main(int argc, char const *argv[]) {
     set_addValue(ports, (void *)serverConfig->port);
   }
 
-  main_serverInstance = server_createInstance(ports);
-  if (main_serverInstance == 0) {
-    log(LOG_ERROR, "Unable to create server instance");
-    exit(EXIT_FAILURE);
+  main_serverInstanceCount = config_getNumberOfInstances(config);
+#ifndef SO_REUSEPORT
+  if (main_serverInstanceCount > 1) {
+    log(LOG_WARNING, "SO_REUSEPORT is not supported by the system - using a single server instance");
+    main_serverInstanceCount = 1;
+  }
+#endif
+  main_serverInstances = malloc(sizeof(pid_t) * main_serverInstanceCount);
+  main_serverListeningSockets = malloc(sizeof(list_t *) * main_serverInstanceCount);
+  main_drainingInstances = list_create();
+  if (main_serverInstances == 0 || main_serverListeningSockets == 0 || main_drainingInstances == 0) {
+    log(LOG_ERROR, "Unable to allocate server instances");
+    return EXIT_FAILURE;
+  }
+  memset(main_serverInstances, 0, sizeof(pid_t) * main_serverInstanceCount);
+  memset(main_serverListeningSockets, 0, sizeof(list_t *) * main_serverInstanceCount);
+
+  // Bind the ports in the main process so that the sockets (and their backlogs) survive restarts of the instances
+  for (size_t i = 0; i < main_serverInstanceCount; i++) {
+    main_serverListeningSockets[i] = server_listenToPorts(ports);
+    if (main_serverListeningSockets[i] == 0 || list_getLength(main_serverListeningSockets[i]) == 0) {
+      log(LOG_ERROR, "No ports bound by the server, closing");
+      main_closeListeningSockets();
+      return EXIT_FAILURE;
+    }
+  }
+
+  log(LOG_DEBUG, "Starting %zu server instances", main_serverInstanceCount);
+  for (size_t i = 0; i < main_serverInstanceCount; i++) {
+    main_serverInstances[i] = server_createInstance(main_serverListeningSockets[i]);
+    if (main_serverInstances[i] == 0) {
+      log(LOG_ERROR, "Unable to create server instance");
+      main_stopServerInstances();
+      exit(EXIT_FAILURE);
+    }
   }
 
   // Setup signal handling for main process
   signal(SIGINT, handleSignalSIGINT);
   signal(SIGTERM, handleSignalSIGTERM);
+  signal(SIGUSR2, handleSignalSIGUSR2);
+  signal(SIGHUP, handleSignalSIGHUP);
   // If a child exits, it will interrupt the sleep and check statuses directly
   signal(SIGCHLD, handleSignalSIGCHLD);
 
@@ -180,37 +240,61 @@ int main(int argc, char const *argv[]) {
   while (main_serverShouldRun) {
     // If a child exits, or another signal is caught it will interrupt the sleep
     sleep(10);
+    log(LOG_DEBUG, "Got interrupted by a signal or sleep timeout");
+
+    if (main_configShouldReload && main_serverShouldRun) {
+      main_configShouldReload = false;
+      main_reloadConfig();
+    }
+
+    if (main_serverShouldReload && main_serverShouldRun) {
+      main_serverShouldReload = false;
+      main_reloadServerInstances();
+    }
+
+    // Restart each instance that has exited - the others keep serving meanwhile
     int status;
-    if (waitpid(main_serverInstance, &status, WNOHANG) != 0) {
+    pid_t pid;
+    while (main_serverShouldRun && (pid = waitpid(-1, &status, WNOHANG)) > 0) {
+      ssize_t drainingIndex = list_findIndex(main_drainingInstances, (void *)(intptr_t)pid);
+      if (drainingIndex >= 0) {
+        log(LOG_DEBUG, "Replaced server instance with pid %d has exited", pid);
+        list_removeValue(main_drainingInstances, drainingIndex);
+        continue;
+      }
+
+      size_t i = 0;
+      for (; i < main_serverInstanceCount && main_serverInstances[i] != pid; i++)
+        ;
+      if (i == main_serverInstanceCount)
+        continue;
+
       bool exited = WIFEXITED(status);
-      log(LOG_DEBUG, "Got interrupted by a signal or sleep timeout");
-      if (exited && main_serverShouldRun) {
+      if (exited) {
         // If the server should be running but it exited with a code, restart it if non-fatal
         int exitCode = WEXITSTATUS(status);
         if (exitCode == SERVER_EXIT_FATAL) {
-          log(LOG_DEBUG, "Got a fatal exit code from instance, quitting");
-          exit(EXIT_FAILURE);
-        }
-
-        log(LOG_WARNING, "Server instance has exited with code %d. Restarting", exitCode);
-        pid_t newInstance = server_createInstance(ports);
-        if (newInstance == 0) {
-          log(LOG_ERROR, "Unable to restart server instance, quitting");
+          log(LOG_DEBUG, "Got a fatal exit code from instance %zu, quitting", i);
+          main_serverInstances[i] = 0;
+          main_stopServerInstances();
           exit(EXIT_FAILURE);
         }
 
-        main_serverInstance = newInstance;
-      } else if (!exited && main_serverInstance) {
+        log(LOG_WARNING, "Server instance %zu has exited with code %d. Restarting", i, exitCode);
+      } else {
         // If the server should be running but it crashed, restart it
-        log(LOG_WARNING, "Server instance crashed. Restarting");
-        pid_t newInstance = server_createInstance(ports);
-        if (newInstance == 0) {
-          log(LOG_ERROR, "Unable to restart server instance, quitting");
-          exit(EXIT_FAILURE);
-        }
+        log(LOG_WARNING, "Server instance %zu crashed. Restarting", i);
+      }
 
-        main_serverInstance = newInstance;
+      pid_t newInstance = server_createInstance(main_serverListeningSockets[i]);
+      if (newInstance == 0) {
+        log(LOG_ERROR, "Unable to restart server instance, quitting");
+        main_serverInstances[i] = 0;
+        main_stopServerInstances();
+        exit(EXIT_FAILURE);
       }
+
+      main_serverInstances[i] = newInstance;
     }
   }
 
@@ -221,6 +305,9 @@ int main(int argc, char const *argv[]) {
     ;
 
   list_free(ports);
+  main_closeListeningSockets();
+  free(main_serverInstances);
+  list_free(main_drainingInstances);
 
   log(LOG_DEBUG, "Freeing global config");
   config_freeGlobalConfig();
@@ -246,6 +333,11 @@ void main_printHelp() {
   printf("help\t\tShow this help text\n");
   printf("version\t\tShow current version\n");
   printf("\n");
+  printf("\x1b[1mSIGNALS\x1b[0m\n");
+  printf("SIGINT, SIGTERM\tClose the server gracefully\n");
+  printf("SIGHUP\t\tReload the config file\n");
+  printf("SIGUSR2\t\tReplace the server instances without closing the listening sockets\n");
+  printf("\n");
   printf("\x1b[1mARGUMENTS\x1b[0m\n");
   printf("-d\t--daemon\t\tRun the server as a deamon\n");
   printf("-l\t--logfile\t\tSpecify the logfile to write logs to\n");
@@ -268,8 +360,8 @@ void handleSignalSIGINT(int signalNumber) {
   signal(SIGCHLD, main_emptySignalHandler);
 
   log(LOG_INFO, "Got SIGINT - exiting cleanly");
-  // Send signal to server
-  kill(main_serverInstance, SIGINT);
+  // Send signal to servers
+  main_stopServerInstances();
   main_serverShouldRun = false;
 }
 
@@ -279,8 +371,8 @@ void handleSignalSIGTERM(int signalNumber) {
   signal(SIGCHLD, main_emptySignalHandler);
 
   log(LOG_INFO, "Got SIGTERM - exiting cleanly");
-  // Send signal to server
-  kill(main_serverInstance, SIGINT);
+  // Send signal to servers
+  main_stopServerInstances();
   main_serverShouldRun = false;
 }
 
@@ -290,6 +382,73 @@ void handleSignalSIGCHLD(int signalNumber) {
   log(LOG_WARNING, "Got SIGCHLD - child exited");
 }
 
+void handleSignalSIGUSR2(int signalNumber) {
+  log(LOG_INFO, "Got SIGUSR2 - replacing server instances");
+  main_serverShouldReload = true;
+}
+
+void handleSignalSIGHUP(int signalNumber) {
+  log(LOG_INFO, "Got SIGHUP - reloading config");
+  main_configShouldReload = true;
+}
+
+void main_reloadConfig() {
+  // Validate the config before asking the instances to reload it. Instances started later will use it directly
+  if (!config_reloadGlobalConfig())
+    return;
+
+  log(LOG_INFO, "Reloaded config");
+  for (size_t i = 0; i < main_serverInstanceCount; i++) {
+    if (main_serverInstances[i] != 0)
+      kill(main_serverInstances[i], SIGHUP);
+  }
+}
+
+void main_stopServerInstances() {
+  for (size_t i = 0; i < main_serverInstanceCount; i++) {
+    if (main_serverInstances[i] != 0)
+      kill(main_serverInstances[i], SIGINT);
+  }
+
+  for (size_t i = 0; i < list_getLength(main_drainingInstances); i++)
+    kill((pid_t)(intptr_t)list_getValue(main_drainingInstances, i), SIGINT);
+}
+
+void main_reloadServerInstances() {
+  for (size_t i = 0; i < main_serverInstanceCount; i++) {
+    // Start the replacement first so that the listening sockets are always being accepted from
+    pid_t newInstance = server_createInstance(main_serverListeningSockets[i]);
+    if (newInstance == 0) {
+      log(LOG_ERROR, "Unable to create replacement for server instance %zu, keeping the old one", i);
+      continue;
+    }
+
+    pid_t oldInstance = main_serverInstances[i];
+    main_serverInstances[i] = newInstance;
+    if (oldInstance != 0) {
+      log(LOG_DEBUG, "Draining server instance %zu with pid %d", i, oldInstance);
+      list_addValue(main_drainingInstances, (void *)(intptr_t)oldInstance);
+      kill(oldInstance, SERVER_SIGNAL_DRAIN);
+    }
+  }
+}
+
+void main_closeListeningSockets() {
+  for (size_t i = 0; i < main_serverInstanceCount; i++) {
+    list_t *listeningSockets = main_serverListeningSockets[i];
+    if (listeningSockets == 0)
+      continue;
+
+    for (size_t j = 0; j < list_getLength(listeningSockets); j++)
+      close((int)(intptr_t)list_getValue(listeningSockets, j));
+    list_free(listeningSockets);
+    main_serverListeningSockets[i] = 0;
+  }
+
+  free(main_serverListeningSockets);
+  main_serverListeningSockets = 0;
+}
+
 void main_emptySignalHandler() {
   // Do nothing
 }
@@ -10,6 +10,18 @@ void handleSignalSIGINT(int signalNumber);
 void handleSignalSIGTERM(int signalNumber);
 // Handle SIGCHLD (a child exited)
 void handleSignalSIGCHLD(int signalNumber);
+// Handle SIGUSR2 (replace the server instances)
+void handleSignalSIGUSR2(int signalNumber);
+// Handle SIGHUP (reload the config)
+void handleSignalSIGHUP(int signalNumber);
+// Reload the config and ask the server instances to do the same
+void main_reloadConfig();
+// Ask all running server instances to close gracefully
+void main_stopServerInstances();
+// Start new server instances on the same listening sockets and let the old ones drain
+void main_reloadServerInstances();
+// Close the listening sockets owned by the main process
+void main_closeListeningSockets();
 // Do nothing
 void main_emptySignalHandler();
 
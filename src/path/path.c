@@ -19,22 +19,15 @@ string_t *path_resolve(const string_t *relativePath, const string_t *root) {
   string_t *resolvedPath = string_fromBuffer(resolvedPathBuffer);
   free(resolvedPathBuffer);
 
-  // Get the substring of the resolved path that should be equal to the root path
-  string_t *resolvedRoot = string_substring(resolvedPath, 0, string_getSize(root));
-  // If the substring is 0, it was likely out of bounds
-  if (resolvedRoot == 0) {
-    string_free(resolvedPath);
-    return 0;
-  }
+  // Get the part of the resolved path that should be equal to the root path
+  string_view_t resolvedRoot = string_getSubview(resolvedPath, 0, string_getSize(root));
 
-  // If the resolved root is not the same as the actual root, the path is not within the root directory
-  if (!string_equals(resolvedRoot, root)) {
-    string_free(resolvedRoot);
+  // If the resolved root is not the same as the actual root (or out of bounds), the path is not within the root directory
+  if (string_getSize(resolvedPath) == 0 || !string_view_equals(resolvedRoot, string_getView(root))) {
     string_free(resolvedPath);
     return 0;
   }
 
-  string_free(resolvedRoot);
   return resolvedPath;
 }
 
@@ -47,23 +40,16 @@ string_t *path_relativeTo(const string_t *path, const string_t *root) {
   string_t *resolvedPath = string_fromBuffer(resolvedPathBuffer);
   free(resolvedPathBuffer);
 
-  // Get the substring of the resolved path that should be equal to the root path
-  string_t *resolvedRoot = string_substring(resolvedPath, 0, string_getSize(root));
-  // If the substring is 0, it was likely out of bounds
-  if (resolvedRoot == 0) {
-    string_free(resolvedPath);
-    return 0;
-  }
+  // Get the part of the resolved path that should be equal to the root path
+  string_view_t resolvedRoot = string_getSubview(resolvedPath, 0, string_getSize(root));
 
-  // If the resolved root is not the same as the actual root, the path is not within the root directory
-  if (!string_equals(resolvedRoot, root)) {
-    string_free(resolvedRoot);
+  // If the resolved root is not the same as the actual root (or out of bounds), the path is not within the root directory
+  if (string_getSize(resolvedPath) == 0 || !string_view_equals(resolvedRoot, string_getView(root))) {
     string_free(resolvedPath);
     return 0;
   }
 
   string_t *relativePath = string_substring(resolvedPath, string_getSize(root), string_getSize(resolvedPath));
   string_free(resolvedPath);
-  string_free(resolvedRoot);
   return relativePath;
 }
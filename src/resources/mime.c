@@ -1,5 +1,25 @@
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../logging/logging.h"
+
 #include "mime.h"
 
+// The extensions and types in the lookup table: the ones above followed by the added ones
+static const char *mime_tableExtensions[MIME_TYPES + MIME_MAX_ADDED_TYPES];
+static const char *mime_tableTypes[MIME_TYPES + MIME_MAX_ADDED_TYPES];
+static size_t mime_tableLength = 0;
+// The index of an entry plus one in each slot (0 for empty slots)
+static uint16_t mime_tableSlots[MIME_TABLE_SIZE];
+
+// Hash an extension, ignoring the case of ASCII letters (FNV-1a)
+uint32_t mime_hashExtension(const char *extension, size_t length);
+// Get the slot of an extension - either the one holding it or the empty slot it would go into
+size_t mime_findSlot(const char *extension, size_t length);
+// Add the built-in types to the lookup table
+void mime_initialize() __attribute__((constructor));
+
 const char *mime_extensions[MIME_TYPES] = {
     ".html",   // Hyper Text Markup Language
     ".aac",    // AAC audio
@@ -131,3 +151,106 @@ const char *mime_types[MIME_TYPES] = {
     "application/zip",                                                           // ZIP archive
     "application/x-7z-compressed"                                                // 7-zip archive
 };
+
+const char *mime_getType(string_view_t extension) {
+  if (extension.size == 0 || extension.size > MIME_MAX_EXTENSION_LENGTH)
+    return 0;
+
+  uint16_t entry = mime_tableSlots[mime_findSlot(extension.buffer, extension.size)];
+  if (entry == 0)
+    return 0;
+
+  return mime_tableTypes[entry - 1];
+}
+
+bool mime_addType(const char *extension, const char *type) {
+  size_t length = strlen(extension);
+  if (length == 0 || length > MIME_MAX_EXTENSION_LENGTH) {
+    log(LOG_ERROR, "Unsupported extension '%s' for MIME type '%s'", extension, type);
+    return false;
+  }
+
+  size_t slot = mime_findSlot(extension, length);
+  // Replace the type of an existing extension
+  if (mime_tableSlots[slot] != 0) {
+    size_t index = mime_tableSlots[slot] - 1;
+    char *typeCopy = strdup(type);
+    if (typeCopy == 0)
+      return false;
+    // The built-in types are not allocated
+    if (index >= MIME_TYPES)
+      free((char *)mime_tableTypes[index]);
+    mime_tableTypes[index] = typeCopy;
+    return true;
+  }
+
+  if (mime_tableLength >= MIME_TYPES + MIME_MAX_ADDED_TYPES) {
+    log(LOG_ERROR, "Too many MIME types - cannot add '%s'", extension);
+    return false;
+  }
+
+  char *extensionCopy = strdup(extension);
+  char *typeCopy = strdup(type);
+  if (extensionCopy == 0 || typeCopy == 0) {
+    free(extensionCopy);
+    free(typeCopy);
+    return false;
+  }
+
+  mime_tableExtensions[mime_tableLength] = extensionCopy;
+  mime_tableTypes[mime_tableLength] = typeCopy;
+  mime_tableSlots[slot] = ++mime_tableLength;
+  return true;
+}
+
+bool mime_isCompressible(const char *type) {
+  if (strncmp(type, "text/", 5) == 0)
+    return true;
+
+  // Structured syntax suffixes such as "+xml" and "+json"
+  const char *suffix = strrchr(type, '+');
+  if (suffix != 0 && (strcmp(suffix, "+xml") == 0 || strcmp(suffix, "+json") == 0))
+    return true;
+
+  static const char *compressibleTypes[] = {"application/javascript", "application/json", "application/xml", "application/x-csh", "application/x-sh", "application/rtf", "application/vnd.ms-fontobject", "font/ttf", "font/otf", "image/bmp", "image/x-icon", "image/vnd.microsoft.icon"};
+  for (size_t i = 0; i < sizeof(compressibleTypes) / sizeof(compressibleTypes[0]); i++) {
+    if (strcmp(type, compressibleTypes[i]) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+uint32_t mime_hashExtension(const char *extension, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    char character = extension[i];
+    if (character >= 'A' && character <= 'Z')
+      character += 'a' - 'A';
+    hash = (hash ^ (uint8_t)character) * 16777619u;
+  }
+
+  return hash;
+}
+
+size_t mime_findSlot(const char *extension, size_t length) {
+  size_t slot = mime_hashExtension(extension, length) & (MIME_TABLE_SIZE - 1);
+  // The table is never more than half full, so there is always an empty slot to stop at
+  while (mime_tableSlots[slot] != 0) {
+    const char *candidate = mime_tableExtensions[mime_tableSlots[slot] - 1];
+    if (strlen(candidate) == length && strncasecmp(candidate, extension, length) == 0)
+      break;
+    slot = (slot + 1) & (MIME_TABLE_SIZE - 1);
+  }
+
+  return slot;
+}
+
+void mime_initialize() {
+  for (size_t i = 0; i < MIME_TYPES; i++) {
+    size_t slot = mime_findSlot(mime_extensions[i], strlen(mime_extensions[i]));
+    mime_tableExtensions[mime_tableLength] = mime_extensions[i];
+    mime_tableTypes[mime_tableLength] = mime_types[i];
+    mime_tableSlots[slot] = ++mime_tableLength;
+  }
+}
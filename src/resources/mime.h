@@ -1,17 +1,37 @@
 #ifndef MIME_H
 #define MIME_H
 
+#include <stdbool.h>
+
+#include "../string/string.h"
+
 /**
 * The supported types were parsed from Mozilla's list available here:
 * https://developer.mozilla.org/en-US/docs/Web/HTTP/Basics_of_HTTP/MIME_types/Complete_list_of_MIME_types
+* The types are looked up through an open addressing hash table keyed on the case-folded extension.
+* The table is built before main with the types below and may be extended at start (see mime_addType).
 */
 
 // The number of supported MIME types
 #define MIME_TYPES 63
+// The maximum number of types added at start
+#define MIME_MAX_ADDED_TYPES 192
+// The number of slots in the lookup table. A power of two, at least twice the number of types
+#define MIME_TABLE_SIZE 512
+// The maximum length of an extension, including the dot
+#define MIME_MAX_EXTENSION_LENGTH 32
 
 // An array of all supported file extensions
 extern const char *mime_extensions[MIME_TYPES];
 // An array of all MIME types
 extern const char *mime_types[MIME_TYPES];
 
+// Get the MIME type of an extension such as ".html", ignoring case. Returns 0 if unknown
+const char *mime_getType(string_view_t extension);
+// Add or replace the type of an extension such as ".wasm". The strings are copied.
+// NOTE: Not thread safe - only meant to be called at start before any lookups are made
+bool mime_addType(const char *extension, const char *type) __attribute__((nonnull(1, 2)));
+// Whether or not a MIME type is text-based and worth compressing, such as "text/html" or "image/svg+xml"
+bool mime_isCompressible(const char *type) __attribute__((nonnull(1)));
+
 #endif
@@ -1,4 +1,5 @@
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -54,39 +55,53 @@ string_t *resources_loadFile(const string_t *filePath) {
   return content;
 }
 
-string_t *resources_getMIMEType(const string_t *filePath) {
-  // Get the extension of the file
-  string_cursor_t *cursor = string_createCursor(filePath);
-  if (cursor == 0)
-    return 0;
+int resources_openFile(const string_t *filePath, struct stat *info) {
+  int file = open(string_getBuffer(filePath), O_RDONLY);
+  if (file == -1) {
+    log(LOG_ERROR, "Could not open file '%s' - got error %d", string_getBuffer(filePath), errno);
+    return -1;
+  }
 
-  ssize_t dotIndex = string_findNextChar(cursor, '.');
-  string_freeCursor(cursor);
-  // There's no "extension" in the path
-  if (dotIndex == -1) {
-    log(LOG_DEBUG, "No extension found in file path '%s'", string_getBuffer(filePath));
-    return 0;
+  if (fstat(file, info) == -1) {
+    log(LOG_ERROR, "Could not get status of file '%s' - got error %d", string_getBuffer(filePath), errno);
+    close(file);
+    return -1;
   }
 
-  string_t *extension = string_substring(filePath, dotIndex, string_getSize(filePath));
-  if (extension == 0) {
-    log(LOG_DEBUG, "The extension could not be extracted from '%s' using start index %zd", string_getBuffer(filePath), dotIndex);
-    return 0;
+  // Fail if the path is a directory (or some other special file)
+  if (!S_ISREG(info->st_mode)) {
+    log(LOG_ERROR, "Could not open file '%s' - not a regular file", string_getBuffer(filePath));
+    close(file);
+    return -1;
   }
 
-  log(LOG_DEBUG, "Extension of '%s' is '%s'", string_getBuffer(filePath), string_getBuffer(extension));
+  return file;
+}
 
-  for (size_t i = 0; i < MIME_TYPES; i++) {
-    if (string_equalsBuffer(extension, mime_extensions[i])) {
-      string_free(extension);
-      log(LOG_DEBUG, "Found mime type '%s'", mime_types[i]);
-      return string_fromBuffer(mime_types[i]);
-    }
+string_view_t resources_getExtension(const string_t *filePath) {
+  // Get the last extension of the file name, ignoring dots in the directories
+  string_view_t path = string_getView(filePath);
+  for (size_t i = path.size; i > 0 && path.buffer[i - 1] != '/'; i--) {
+    if (path.buffer[i - 1] == '.')
+      return string_view_substring(path, i - 1, path.size);
   }
 
-  log(LOG_DEBUG, "Unknown MIME type for extension '%s'", string_getBuffer(extension));
-  string_free(extension);
-  return 0;
+  return string_view_substring(path, path.size, path.size);
+}
+
+const char *resources_getMIMEType(const string_t *filePath) {
+  string_view_t extension = resources_getExtension(filePath);
+  // There's no "extension" in the path
+  if (extension.size == 0) {
+    log(LOG_DEBUG, "No extension found in file path '%s'", string_getBuffer(filePath));
+    return 0;
+  }
+
+  const char *mimeType = mime_getType(extension);
+  if (mimeType == 0)
+    log(LOG_DEBUG, "Unknown MIME type for extension '%s'", extension.buffer);
+
+  return mimeType;
 }
 
 bool resources_isExecutable(const string_t *filePath) {
@@ -1,12 +1,16 @@
 #ifndef RESOURCES_H
 #define RESOURCES_H
 
+#include <sys/stat.h>
+
 #include "../string/string.h"
 
 #include "resources/www/400.html.h"
 #include "resources/www/403.html.h"
 #include "resources/www/413.html.h"
+#include "resources/www/414.html.h"
 #include "resources/www/417.html.h"
+#include "resources/www/431.html.h"
 #include "resources/www/404.html.h"
 #include "resources/www/500.html.h"
 #include "resources/www/501.html.h"
@@ -20,8 +24,12 @@
 
 // Read a file as a string (does not follow symlinks)
 string_t *resources_loadFile(const string_t *filePath) __attribute__((nonnull(1)));
-// Try to get the MIME type of a file (does not follow symlinks)
-string_t *resources_getMIMEType(const string_t *filePath) __attribute__((nonnull(1)));
+// Open a file for reading and get its status. Returns the file descriptor or -1 if failed
+int resources_openFile(const string_t *filePath, struct stat *info) __attribute__((nonnull(1, 2)));
+// Get the last extension of a file name, including the dot (empty if there is none)
+string_view_t resources_getExtension(const string_t *filePath) __attribute__((nonnull(1)));
+// Try to get the MIME type of a file from its last extension, ignoring case. The type is static (0 if unknown)
+const char *resources_getMIMEType(const string_t *filePath) __attribute__((nonnull(1)));
 // Whether or not the user can execute the file path (does not follow symlinks, works for files and directories)
 bool resources_isExecutable(const string_t *filePath) __attribute__((nonnull(1)));
 // Whether or not a path is a regular file (does not follow symlinks)
@@ -1,35 +1,144 @@
+#ifdef __linux__
+// Required for accept4
+#define _GNU_SOURCE
+#endif
+
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <netinet/tcp.h>
 #include <poll.h>
 #include <signal.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 
 #include "../cgi/cgi.h"
+#include "../client-limits/client-limits.h"
 #include "../config/config.h"
 #include "../datastructures/hash-table/hash-table.h"
 #include "../datastructures/list/list.h"
-#include "../datastructures/message-queue/message-queue.h"
+#include "../datastructures/timer-wheel/timer-wheel.h"
+#include "../datastructures/work-queue/work-queue.h"
 #include "../http/http.h"
+#include "../io-pool/io-pool.h"
 #include "../logging/logging.h"
+#include "../time/time.h"
+#include "../uring/uring.h"
 #include "../worker/worker.h"
 
 #include "server.h"
 
+// A connection waiting for its first data or for its TLS handshake before being queued for the workers
+typedef struct {
+  connection_t *connection;
+  // The events waited for (POLLIN or POLLOUT)
+  short events;
+  // The position in server_pendingConnections
+  size_t index;
+  // Whether the connection was turned away and only waits for the peer to close it (see server_lingerConnection)
+  bool isLingering;
+} server_pending_connection_t;
+
 static struct pollfd *socketDescriptors = 0;
 static size_t socketDescriptorCount = 0;
-static message_queue_t *server_connectionQueue = 0;
+// The connections owned by the main thread until they're ready for a worker. Idle and slow clients don't hold a worker meanwhile
+static server_pending_connection_t **server_pendingConnections = 0;
+static size_t server_pendingConnectionCount = 0;
+static size_t server_pendingConnectionCapacity = 0;
+// The listening sockets followed by the pending connections, as polled when not using io_uring
+static struct pollfd *server_pollDescriptors = 0;
+static size_t server_pollDescriptorCapacity = 0;
+// The io_uring accepting connections from the listening sockets (0 if poll is used)
+static uring_t *server_ring = 0;
+// The run queues of the workers, one deque for each slot of the pool
+static work_queue_t *server_connectionQueue = 0;
+// Deadlines of the connections being handled
+static timer_wheel_t *server_timers = 0;
+// The open connections and request rates of clients (see config_getMaxClientConnections)
+static client_limits_t *server_clientLimits = 0;
+// Set when the instance is asked to close (SIGINT or SIGTERM, see server_closeGracefully)
+static volatile sig_atomic_t server_shouldClose = 0;
+// Set when the instance is asked to stop accepting connections (see server_drain)
+static volatile sig_atomic_t server_shouldDrain = 0;
+// Set when the instance is asked to reload the config (SIGHUP)
+static volatile sig_atomic_t server_shouldReloadConfig = 0;
 
 static worker_t **server_workerPool = 0;
+// The maximum number of workers (the size of the pool)
+static size_t server_workerPoolSize = 0;
+// The number of spawned workers, including those asked to retire
+static size_t server_workers = 0;
+// The number of workers asked to retire that have not yet been joined
+static size_t server_retiringWorkers = 0;
+static int server_nextWorkerId = 0;
+// State used to limit the rate of spawning and retiring workers
+static uint64_t server_scalingIntervalStart = 0;
+static size_t server_spawnedWorkersInInterval = 0;
+static uint64_t server_surplusSince = 0;
+static uint64_t server_lastRetirement = 0;
+// Accept counters. The rate is measured over each scaling interval (see server_measureAcceptRate)
+static size_t server_acceptedConnections = 0;
+static size_t server_failedAccepts = 0;
+static int server_lastAcceptError = 0;
+static uint64_t server_acceptRateStart = 0;
+static size_t server_acceptedConnectionsAtRateStart = 0;
+static size_t server_failedAcceptsAtRateStart = 0;
+static size_t server_peakAcceptRate = 0;
+// The number of connections answered with 503 at the start of the current interval (see worker_getShedConnections)
+static size_t server_shedConnectionsAtRateStart = 0;
+// The number of connections and requests of clients over their limits refused at the start of the current interval
+static size_t server_refusedConnectionsAtRateStart = 0;
+static size_t server_refusedRequestsAtRateStart = 0;
 
 int server_handleServerNameIdentification(SSL *ssl, int *alert, void *arg);
 DH *server_handleDiffieHellmanParameters(SSL *ssl, int isExport, int keyLength);
 
-// Signal handlers
+// Stop the workers, free the instance's resources and exit (see server_handleCloseSignal)
 void server_closeGracefully();
+// Stop accepting connections and close once in-flight work is done
+void server_drain();
+// Set up callbacks for the TLS contexts of a config
+void server_setupTLS(config_t *config);
+// Accept connections on all listening sockets using io_uring. Returns 0 if not supported by the kernel
+uring_t *server_createRing();
+// Wait for and handle the completions of the io_uring (see server_acceptConnections)
+int server_acceptFromRing();
+// Close the io_uring, if any, cancelling the accepts
+void server_closeRing();
+// Count an error returned by accept
+void server_countAcceptError(int error);
+// Update the accept rate once per scaling interval, warn about failed accepts and connections answered with 503 or refused
+// as their clients are over their limits and forget idle clients
+void server_measureAcceptRate(uint64_t now);
+// Get the number of connections answered with 503 for any reason
+size_t server_getShedConnections();
+// Move a pending connection towards the workers: detect TLS, continue the handshake and queue the connection once ready.
+// Returns true if the connection waits for pending->events, false if it's done waiting (queued or freed)
+bool server_progressConnection(server_pending_connection_t *pending);
+// Track a pending connection. Returns false if failed
+bool server_addPendingConnection(server_pending_connection_t *pending);
+// Stop tracking a pending connection and free it (but not its connection)
+void server_removePendingConnection(server_pending_connection_t *pending);
+// Wait for the events of a tracked pending connection using the io_uring, if any. The connection is freed if it can't be waited for
+void server_watchConnection(server_pending_connection_t *pending);
+// Progress a tracked pending connection whose events have occurred (see server_progressConnection)
+void server_resumeConnection(server_pending_connection_t *pending);
+// Free all pending connections, such as when closing
+void server_freePendingConnections();
+// Queue the connection of a pending connection for the workers, unless too many connections are already queued. Returns true
+// if it was turned away and lingers, waiting for pending->events (see server_progressConnection)
+bool server_queueConnection(server_pending_connection_t *pending);
+// Discard what the peer of a connection that was turned away still sends until it closes the connection or the deadline
+// passes. Returns true if it waits for pending->events, false if it was freed
+bool server_lingerConnection(server_pending_connection_t *pending);
+
+// Signal handlers
+void server_handleCloseSignal();
+void server_handleDrainSignal();
+void server_handleReloadSignal();
 void server_emptySignalHandler();
 
 bool server_setNonBlocking(int socketDescriptor) {
@@ -49,7 +158,7 @@ bool server_setNonBlocking(int socketDescriptor) {
   return true;
 }
 
-pid_t server_createInstance(const set_t *ports) {
+pid_t server_createInstance(const list_t *listeningSockets) {
   // Fork the process
   fflush(stdout);
   fflush(stderr);
@@ -60,7 +169,7 @@ pid_t server_createInstance(const set_t *ports) {
     return 0;
   } else if (pid == 0) {
     // Start a server in the child process (blocking call)
-    int exitCode = server_start(ports);
+    int exitCode = server_start(listeningSockets);
     // We only get here if there's an error
     log(LOG_ERROR, "The server exited with code %d", exitCode);
     exit(exitCode);
@@ -70,71 +179,120 @@ pid_t server_createInstance(const set_t *ports) {
   }
 }
 
-int server_start(const set_t *ports) {
-  // Setup signal handling for main process
-  signal(SIGINT, server_closeGracefully);
-  signal(SIGTERM, server_closeGracefully);
+int server_start(const list_t *listeningSockets) {
+  // Setup signal handling for main process. The handlers only set flags, the main loop acts on them as the handler may
+  // interrupt it while it holds a lock
+  signal(SIGINT, server_handleCloseSignal);
+  signal(SIGTERM, server_handleCloseSignal);
+  signal(SERVER_SIGNAL_DRAIN, server_handleDrainSignal);
+  signal(SIGHUP, server_handleReloadSignal);
 
   // Set up signals
   signal(SIGPIPE, server_emptySignalHandler);
 
   // Set up file structures necessary for polling state of socket queues
-  size_t descriptorsSize = sizeof(struct pollfd) * set_getLength(ports);
+  size_t descriptorsSize = sizeof(struct pollfd) * list_getLength(listeningSockets);
   socketDescriptors = malloc(descriptorsSize);
   memset(socketDescriptors, 0, descriptorsSize);
 
-  server_connectionQueue = message_queue_create();
-  if (server_connectionQueue == 0) {
-    log(LOG_ERROR, "Could not create a connection queue");
+  server_timers = timer_wheel_create(SERVER_TIMER_RESOLUTION, time_getMilliseconds());
+  if (server_timers == 0) {
+    log(LOG_ERROR, "Could not create timers for connection deadlines");
     return EXIT_FAILURE;
   }
 
-  // Setup worker pool
+  server_clientLimits = client_limits_create();
+  if (server_clientLimits == 0) {
+    log(LOG_ERROR, "Could not create client limits");
+    return EXIT_FAILURE;
+  }
+
+  // Setup worker pool. It starts at the minimum size and grows on demand (see server_scaleWorkerPool)
   config_t *config = config_getGlobalConfig();
-  size_t threads = config_getNumberOfThreads(config);
-  log(LOG_DEBUG, "Setting up %zu workers in the pool", threads);
-  server_workerPool = malloc(sizeof(worker_t *) * threads);
+  server_workerPoolSize = config_getNumberOfThreads(config);
+  size_t threads = config_getMinimumNumberOfThreads(config);
+  log(LOG_DEBUG, "Setting up %zu workers in the pool (maximum %zu)", threads, server_workerPoolSize);
+  server_workerPool = malloc(sizeof(worker_t *) * server_workerPoolSize);
   if (server_workerPool == 0) {
     log(LOG_ERROR, "Unable to create worker pool");
     return EXIT_FAILURE;
   }
+  memset(server_workerPool, 0, sizeof(worker_t *) * server_workerPoolSize);
+  // Each worker owns the deque of its slot in the pool
+  server_connectionQueue = work_queue_create(server_workerPoolSize);
+  if (server_connectionQueue == 0) {
+    log(LOG_ERROR, "Could not create a connection queue");
+    return EXIT_FAILURE;
+  }
   for (size_t i = 0; i < threads; i++) {
-    worker_t *worker = worker_spawn(i, 0, server_connectionQueue);
+    worker_t *worker = worker_spawn(server_nextWorkerId++, 0, server_connectionQueue, i);
     if (worker == 0) {
       log(LOG_ERROR, "Failed to set up worker for the pool. Could not spawn worker %zu", i);
       return EXIT_FAILURE;
     }
 
     server_workerPool[i] = worker;
+    server_workers++;
   }
   log(LOG_DEBUG, "Set up %zu workers", threads);
 
-  size_t backlog = config_getBacklogSize(config);
-  // Set up listening sockets for each port
-  for (size_t i = 0; i < list_getLength(ports); i++) {
-    uint16_t port = (uint16_t)list_getValue(ports, i);
-    log(LOG_DEBUG, "Setting up port %d for listening (backlog size of %zu)", port, backlog);
-    int socketDescriptor = server_listen(port, backlog);
-    if (socketDescriptor != 0) {
-      socketDescriptors[i].fd = socketDescriptor;
-      // Listen for incoming data
-      socketDescriptors[i].events = POLLIN;
-      socketDescriptorCount++;
-    } else {
-      log(LOG_ERROR, "Unable to make the server listen on port %d", port);
-    }
+  // The listening sockets are owned by the main process and inherited by each instance
+  for (size_t i = 0; i < list_getLength(listeningSockets); i++) {
+    socketDescriptors[i].fd = (int)(intptr_t)list_getValue(listeningSockets, i);
+    // Listen for incoming data
+    socketDescriptors[i].events = POLLIN;
+    socketDescriptorCount++;
   }
 
   if (socketDescriptorCount == 0) {
-    log(LOG_ERROR, "No ports bound by the server, closing");
+    log(LOG_ERROR, "No listening sockets given to the server, closing");
     free(socketDescriptors);
     return SERVER_EXIT_FATAL;
   }
 
-  if (socketDescriptorCount != list_getLength(ports))
-    log(LOG_WARNING, "Not all required ports could be successfully bound (%zu out of %zu)", socketDescriptorCount, list_getLength(ports));
+  server_setupTLS(config);
+
+  // Accept using io_uring if supported by the kernel, unless disabled
+  if (config_getIOUring(config) != 0) {
+    server_ring = server_createRing();
+    if (server_ring != 0)
+      log(LOG_DEBUG, "Accepting connections using io_uring");
+    else if (config_getIOUring(config) == 1)
+      log(LOG_WARNING, "The kernel does not support accepting connections using io_uring - using poll");
+  }
+
+  // Start accepting connections
+  while (true) {
+    if (server_shouldClose)
+      server_closeGracefully();
+
+    if (server_shouldDrain)
+      server_drain();
+
+    // In-flight requests keep using the previous config until they're done
+    if (server_shouldReloadConfig) {
+      server_shouldReloadConfig = 0;
+      if (config_reloadGlobalConfig()) {
+        log(LOG_INFO, "Reloaded config");
+        server_setupTLS(config_getGlobalConfig());
+      }
+    }
+
+    int acceptedPorts = server_acceptConnections();
+    log(LOG_DEBUG, "There were %d port with incoming sockets", acceptedPorts);
+    server_measureAcceptRate(time_getMilliseconds());
 
-  // Setup TLS
+    size_t expiredDeadlines = timer_wheel_advance(server_timers, time_getMilliseconds());
+    if (expiredDeadlines > 0)
+      log(LOG_DEBUG, "%zu connections passed their deadline", expiredDeadlines);
+
+    server_scaleWorkerPool();
+  }
+
+  free(socketDescriptors);
+}
+
+void server_setupTLS(config_t *config) {
   for (size_t i = 0; i < config_getServers(config); i++) {
     server_config_t *serverConfig = config_getServerConfig(config, i);
     SSL_CTX *sslContext = config_getSSLContext(serverConfig);
@@ -145,20 +303,47 @@ int server_start(const set_t *ports) {
         SSL_CTX_set_tmp_dh_callback(sslContext, server_handleDiffieHellmanParameters);
     }
   }
+}
 
-  // Start accepting connections
-  while (true) {
-    int acceptedPorts = server_acceptConnections();
-    log(LOG_DEBUG, "There were %d port with incoming sockets", acceptedPorts);
+list_t *server_listenToPorts(const set_t *ports) {
+  list_t *listeningSockets = list_create();
+  if (listeningSockets == 0)
+    return 0;
 
-    // TODO: We can handle scaling of number of workers here
+  config_t *config = config_getGlobalConfig();
+  size_t backlog = config_getBacklogSize(config);
+  for (size_t i = 0; i < set_getLength(ports); i++) {
+    uint16_t port = (uint16_t)list_getValue(ports, i);
+
+    // Servers sharing the port share the socket and its options
+    int deferAccept = 0;
+    int fastOpen = 0;
+    for (size_t j = 0; j < config_getServers(config); j++) {
+      server_config_t *serverConfig = config_getServerConfig(config, j);
+      if (config_getPort(serverConfig) != port)
+        continue;
+      if (config_getDeferAccept(serverConfig) > deferAccept)
+        deferAccept = config_getDeferAccept(serverConfig);
+      if (config_getFastOpen(serverConfig) > fastOpen)
+        fastOpen = config_getFastOpen(serverConfig);
+    }
+
+    log(LOG_DEBUG, "Setting up port %d for listening (backlog size of %zu)", port, backlog);
+    int socketDescriptor = server_listen(port, backlog, deferAccept, fastOpen);
+    if (socketDescriptor != 0)
+      list_addValue(listeningSockets, (void *)(intptr_t)socketDescriptor);
+    else
+      log(LOG_ERROR, "Unable to make the server listen on port %d", port);
   }
 
-  free(socketDescriptors);
+  if (list_getLength(listeningSockets) != set_getLength(ports))
+    log(LOG_WARNING, "Not all required ports could be successfully bound (%zu out of %zu)", list_getLength(listeningSockets), set_getLength(ports));
+
+  return listeningSockets;
 }
 
-int server_listen(uint16_t port, size_t backlog) {
-  int socketDescriptor = socket(AF_INET, SOCK_STREAM, PROTOCOL);
+int server_listen(uint16_t port, size_t backlog, int deferAccept, int fastOpen) {
+  int socketDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, PROTOCOL);
   // Test to see if socket is created
   if (socketDescriptor < 0) {
     log(LOG_ERROR, "Could not create socket for port %d", port);
@@ -173,12 +358,33 @@ int server_listen(uint16_t port, size_t backlog) {
     return 0;
   }
 
+#ifdef SO_REUSEPORT
+  // Let every server instance bind its own socket to the port. The kernel spreads incoming connections between them
+  int enablePortReuse = 1;
+  if (setsockopt(socketDescriptor, SOL_SOCKET, SO_REUSEPORT, &enablePortReuse, sizeof(int)) < 0) {
+    log(LOG_ERROR, "Could not make socket reuse port for port %d", port);
+    return 0;
+  }
+#endif
+
   bool isNonBlocking = server_setNonBlocking(socketDescriptor);
   if (!isNonBlocking) {
     log(LOG_ERROR, "Failed to make listening socket non-blocking");
     return 0;
   }
 
+#ifdef TCP_DEFER_ACCEPT
+  // Only wake the server once the client has sent its request (or TLS hello), sparing the wait for it
+  if (deferAccept > 0 && setsockopt(socketDescriptor, IPPROTO_TCP, TCP_DEFER_ACCEPT, &deferAccept, sizeof(int)) < 0)
+    log(LOG_WARNING, "Could not defer accepting connections for port %d", port);
+#endif
+
+#ifdef TCP_FASTOPEN
+  // Let returning clients send their request along with the SYN
+  if (fastOpen > 0 && setsockopt(socketDescriptor, IPPROTO_TCP, TCP_FASTOPEN, &fastOpen, sizeof(int)) < 0)
+    log(LOG_WARNING, "Could not enable TCP Fast Open for port %d", port);
+#endif
+
   // Host address info
   struct sockaddr_in hostAddress;
   hostAddress.sin_family = AF_INET;
@@ -206,68 +412,543 @@ int server_listen(uint16_t port, size_t backlog) {
 }
 
 int server_acceptConnections() {
-  // Wait indefinitely for any incoming socket
-  int status = poll(socketDescriptors, socketDescriptorCount, -1);
-  if (status <= 0) {
+  if (server_ring != 0)
+    return server_acceptFromRing();
+
+  // Poll the listening sockets along with the pending connections
+  size_t descriptorCount = socketDescriptorCount + server_pendingConnectionCount;
+  if (descriptorCount > server_pollDescriptorCapacity) {
+    struct pollfd *descriptors = realloc(server_pollDescriptors, sizeof(struct pollfd) * descriptorCount);
+    if (descriptors == 0) {
+      log(LOG_ERROR, "Unable to allocate descriptors for polling");
+      return 0;
+    }
+    server_pollDescriptors = descriptors;
+    server_pollDescriptorCapacity = descriptorCount;
+  }
+  memcpy(server_pollDescriptors, socketDescriptors, sizeof(struct pollfd) * socketDescriptorCount);
+  for (size_t i = 0; i < server_pendingConnectionCount; i++) {
+    struct pollfd *descriptor = &server_pollDescriptors[socketDescriptorCount + i];
+    descriptor->fd = connection_getSocket(server_pendingConnections[i]->connection);
+    descriptor->events = server_pendingConnections[i]->events;
+    descriptor->revents = 0;
+  }
+
+  // Wait for any incoming socket. Time out in order to scale the worker pool while idle and to handle deadlines
+  int timeout = timer_wheel_getLength(server_timers) > 0 ? SERVER_TIMER_RESOLUTION : SERVER_SCALING_INTERVAL;
+  int status = poll(server_pollDescriptors, descriptorCount, timeout);
+  if (status == 0)
+    return 0;
+
+  // Interrupted by a signal such as SERVER_SIGNAL_DRAIN
+  if (status < 0 && errno == EINTR)
+    return 0;
+
+  if (status < 0) {
     const char *reason = strerror(errno);
     log(LOG_ERROR, "An error occured while waiting for an incoming socket: %d (%s)", errno, reason);
     return 0;
   }
 
-  if (status == 1)
-    log(LOG_DEBUG, "There's an incoming socket ready to be handled");
-  else if (status > 1)
-    log(LOG_DEBUG, "There are multiple incoming sockets ready to be handled");
+  // Handle the pending connections before accepting new ones, which are added to the end. Going backwards, a removed
+  // connection is replaced by one already handled
+  for (size_t i = descriptorCount - socketDescriptorCount; i > 0; i--) {
+    if (server_pollDescriptors[socketDescriptorCount + i - 1].revents != 0)
+      server_resumeConnection(server_pendingConnections[i - 1]);
+  }
 
+  int readyPorts = 0;
   for (size_t i = 0; i < socketDescriptorCount; i++) {
     // Ignore sockets that don't have a connection
-    if ((socketDescriptors[i].revents & POLLIN) == 0)
+    if ((server_pollDescriptors[i].revents & POLLIN) == 0)
+      continue;
+    readyPorts++;
+
+    // Accept the waiting sockets up to the budget. Any remaining sockets are accepted once the other ports have had their turn
+    for (size_t accepted = 0; accepted < SERVER_ACCEPT_BUDGET; accepted++) {
+      struct sockaddr_storage peerAddress;
+      socklen_t peerAddressLength = sizeof(peerAddress);
+      int socket = server_acceptNextSocket(socketDescriptors[i].fd, &peerAddress, &peerAddressLength);
+      if (socket == -1)
+        break;
+
+      server_acceptedConnections++;
+      server_setupConnection(socket, &peerAddress, peerAddressLength);
+    }
+  }
+
+  return readyPorts;
+}
+
+int server_acceptSocket(int listeningSocket, struct sockaddr_storage *peerAddress, socklen_t *peerAddressLength) {
+#ifdef __linux__
+  return accept4(listeningSocket, (struct sockaddr *)peerAddress, peerAddressLength, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+  int socket = accept(listeningSocket, (struct sockaddr *)peerAddress, peerAddressLength);
+  if (socket == -1)
+    return -1;
+
+  if (!server_setNonBlocking(socket)) {
+    int error = errno;
+    close(socket);
+    errno = error;
+    return -1;
+  }
+
+  return socket;
+#endif
+}
+
+int server_acceptNextSocket(int listeningSocket, struct sockaddr_storage *peerAddress, socklen_t *peerAddressLength) {
+  socklen_t addressCapacity = *peerAddressLength;
+  while (true) {
+    *peerAddressLength = addressCapacity;
+    int socket = server_acceptSocket(listeningSocket, peerAddress, peerAddressLength);
+    if (socket != -1)
+      return socket;
+
+    // The backlog is empty
+    int error = errno;
+    if (error == EAGAIN || error == EWOULDBLOCK)
+      return -1;
+
+    server_countAcceptError(error);
+    // Connections aborted while in the backlog don't affect the rest of it
+    if (error != ECONNABORTED && error != EINTR) {
+      errno = error;
+      return -1;
+    }
+  }
+}
+
+void server_countAcceptError(int error) {
+  server_failedAccepts++;
+  server_lastAcceptError = error;
+  log(LOG_DEBUG, "Failed to accept connection: %d (%s)", error, strerror(error));
+}
+
+void server_measureAcceptRate(uint64_t now) {
+  uint64_t elapsed = now - server_acceptRateStart;
+  if (elapsed < SERVER_SCALING_INTERVAL)
+    return;
+
+  size_t acceptedConnections = server_acceptedConnections - server_acceptedConnectionsAtRateStart;
+  size_t failedAccepts = server_failedAccepts - server_failedAcceptsAtRateStart;
+  size_t acceptRate = acceptedConnections * 1000 / elapsed;
+  if (acceptRate > server_peakAcceptRate)
+    server_peakAcceptRate = acceptRate;
+
+  if (acceptedConnections > 0)
+    log(LOG_DEBUG, "Accepted %zu connections per second", acceptRate);
+  // Warn at most once per interval, as accepts may keep failing such as when out of file descriptors
+  if (failedAccepts > 0)
+    log(LOG_WARNING, "Failed to accept %zu connections in %llums: %d (%s)", failedAccepts, (unsigned long long)elapsed, server_lastAcceptError, strerror(server_lastAcceptError));
+  size_t shedConnections = server_getShedConnections();
+  if (shedConnections > server_shedConnectionsAtRateStart)
+    log(LOG_WARNING, "Answered %zu connections with 503 in %llums as the workers could not keep up", shedConnections - server_shedConnectionsAtRateStart, (unsigned long long)elapsed);
+  size_t refusedConnections = __atomic_load_n(&server_clientLimits->rejectedConnections, __ATOMIC_RELAXED);
+  size_t refusedRequests = __atomic_load_n(&server_clientLimits->rejectedRequests, __ATOMIC_RELAXED);
+  if (refusedConnections > server_refusedConnectionsAtRateStart || refusedRequests > server_refusedRequestsAtRateStart)
+    log(LOG_WARNING, "Refused %zu connections and answered %zu requests with 429 in %llums as their clients were over their limits", refusedConnections - server_refusedConnectionsAtRateStart, refusedRequests - server_refusedRequestsAtRateStart, (unsigned long long)elapsed);
+
+  size_t expiredClients = client_limits_expire(server_clientLimits, now);
+  if (expiredClients > 0)
+    log(LOG_DEBUG, "Forgot %zu idle clients", expiredClients);
+
+  server_acceptRateStart = now;
+  server_shedConnectionsAtRateStart = shedConnections;
+  server_refusedConnectionsAtRateStart = refusedConnections;
+  server_refusedRequestsAtRateStart = refusedRequests;
+  server_acceptedConnectionsAtRateStart = server_acceptedConnections;
+  server_failedAcceptsAtRateStart = server_failedAccepts;
+}
+
+void server_setupConnection(int socket, const struct sockaddr_storage *peerAddress, socklen_t peerAddressLength) {
+  connection_t *connection = connection_create();
+  if (connection == 0) {
+    log(LOG_ERROR, "Failed to create connection");
+    close(socket);
+    return;
+  }
+  connection_setSocket(connection, socket);
+  connection_setTimerWheel(connection, server_timers);
+  connection_setSourceAddress(connection, (const struct sockaddr *)peerAddress, peerAddressLength);
+
+  log(LOG_DEBUG, "Setting up connection for %s:%i", connection_getSourceAddress(connection), connection_getSourcePort(connection));
+
+  // Refuse clients with too many open connections before spending a TLS handshake on them. Allowed clients are never tracked
+  config_t *config = config_getGlobalConfig();
+  size_t maxClientConnections = config_getMaxClientConnections(config);
+  size_t allowedNetworks = 0;
+  const client_limits_network_t *allowList = config_getClientAllowList(config, &allowedNetworks);
+  bool isLimited = maxClientConnections > 0 || config_getClientRequestRate(config) > 0;
+  if (isLimited && !client_limits_isAllowed(allowList, allowedNetworks, (const struct sockaddr *)peerAddress)) {
+    if (!client_limits_acquireConnection(server_clientLimits, (const struct sockaddr *)peerAddress, maxClientConnections, time_getMilliseconds(), &connection->client)) {
+      log(LOG_DEBUG, "Refusing connection as %s already has %zu open connections", connection_getSourceAddress(connection), maxClientConnections);
+      connection_free(connection);
+      return;
+    }
+  }
+
+  // The header must be received within the header timeout from now, or the connection is shut down
+  connection->acceptedAt = time_getMilliseconds();
+  connection_setDeadline(connection, config_getHeaderTimeout(config), SHUT_RDWR);
+
+  server_pending_connection_t *pending = malloc(sizeof(server_pending_connection_t));
+  if (pending == 0) {
+    log(LOG_ERROR, "Failed to allocate pending connection");
+    connection_free(connection);
+    return;
+  }
+  pending->connection = connection;
+  pending->events = POLLIN;
+  pending->isLingering = false;
+
+  // Clients usually send their request (or TLS hello) right away, in which case there's no need to wait
+  if (!server_progressConnection(pending)) {
+    free(pending);
+    return;
+  }
+
+  if (!server_addPendingConnection(pending)) {
+    connection_free(connection);
+    free(pending);
+    return;
+  }
+
+  server_watchConnection(pending);
+}
+
+bool server_progressConnection(server_pending_connection_t *pending) {
+  if (pending->isLingering)
+    return server_lingerConnection(pending);
+
+  connection_t *connection = pending->connection;
+  if (connection_hasTimedOut(connection)) {
+    log(LOG_DEBUG, "%s:%i did not send a request in time", connection_getSourceAddress(connection), connection_getSourcePort(connection));
+    connection_free(connection);
+    return false;
+  }
+
+  if (connection->ssl == 0) {
+    // A TLS client hello starts with a handshake record (0x16), which no HTTP request does. Only the first byte is
+    // peeked as the socket would stay readable while waiting for more, the handshake itself consumes the record
+    unsigned char header;
+    ssize_t bytesReceived = recv(connection_getSocket(connection), &header, sizeof(header), MSG_PEEK);
+    if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      pending->events = POLLIN;
+      return true;
+    } else if (bytesReceived <= 0) {
+      log(LOG_DEBUG, "%s:%i closed the connection before sending a request", connection_getSourceAddress(connection), connection_getSourcePort(connection));
+      connection_free(connection);
+      return false;
+    }
+
+    if (header != 0x16)
+      return server_queueConnection(pending);
+
+    log(LOG_DEBUG, "Handling TLS setup for %s:%d", connection_getSourceAddress(connection), connection_getSourcePort(connection));
+    connection->ssl = server_createSSL(connection);
+    if (connection->ssl == 0) {
+      connection_free(connection);
+      return false;
+    }
+  }
+
+  // The socket is non-blocking, so the handshake continues whenever the client has sent more
+  int status = SSL_accept(connection->ssl);
+  if (status == 1) {
+    log(LOG_DEBUG, "Successfully setup TLS for connection");
+    // Kernel TLS is only enabled if the kernel supports the negotiated cipher (and has the tls module loaded)
+    if (connection_isKernelTLS(connection))
+      log(LOG_DEBUG, "Kernel TLS is enabled for the connection");
+    return server_queueConnection(pending);
+  }
+
+  int error = SSL_get_error(connection->ssl, status);
+  if (error == SSL_ERROR_WANT_READ) {
+    pending->events = POLLIN;
+    return true;
+  } else if (error == SSL_ERROR_WANT_WRITE) {
+    pending->events = POLLOUT;
+    return true;
+  }
+
+  log(LOG_DEBUG, "Unable to accept TLS socket. Got code %d", error);
+  connection_free(connection);
+  return false;
+}
+
+bool server_addPendingConnection(server_pending_connection_t *pending) {
+  if (server_pendingConnectionCount == server_pendingConnectionCapacity) {
+    size_t capacity = server_pendingConnectionCapacity == 0 ? SERVER_PENDING_CAPACITY : server_pendingConnectionCapacity * 2;
+    server_pending_connection_t **pendingConnections = realloc(server_pendingConnections, sizeof(server_pending_connection_t *) * capacity);
+    if (pendingConnections == 0) {
+      log(LOG_ERROR, "Unable to allocate pending connections");
+      return false;
+    }
+    server_pendingConnections = pendingConnections;
+    server_pendingConnectionCapacity = capacity;
+  }
+
+  pending->index = server_pendingConnectionCount;
+  server_pendingConnections[server_pendingConnectionCount++] = pending;
+  return true;
+}
+
+void server_removePendingConnection(server_pending_connection_t *pending) {
+  // Move the last connection into the freed position
+  server_pending_connection_t *last = server_pendingConnections[--server_pendingConnectionCount];
+  last->index = pending->index;
+  server_pendingConnections[pending->index] = last;
+  free(pending);
+}
+
+void server_watchConnection(server_pending_connection_t *pending) {
+  if (server_ring == 0)
+    return;
+
+  uint64_t userData = SERVER_RING_CONNECTION | (uint64_t)(uintptr_t)pending;
+  int socket = connection_getSocket(pending->connection);
+  if (uring_pollAdd(server_ring, socket, (uint32_t)pending->events, userData))
+    return;
+
+  // Make room by passing the queued submissions to the kernel
+  if (uring_submit(server_ring) && uring_pollAdd(server_ring, socket, (uint32_t)pending->events, userData))
+    return;
+
+  log(LOG_ERROR, "Unable to wait for connection using io_uring");
+  connection_free(pending->connection);
+  server_removePendingConnection(pending);
+}
+
+void server_resumeConnection(server_pending_connection_t *pending) {
+  if (server_progressConnection(pending))
+    server_watchConnection(pending);
+  else
+    server_removePendingConnection(pending);
+}
+
+void server_freePendingConnections() {
+  for (size_t i = 0; i < server_pendingConnectionCount; i++) {
+    connection_free(server_pendingConnections[i]->connection);
+    free(server_pendingConnections[i]);
+  }
+  free(server_pendingConnections);
+  server_pendingConnections = 0;
+  server_pendingConnectionCount = 0;
+  server_pendingConnectionCapacity = 0;
+}
+
+bool server_queueConnection(server_pending_connection_t *pending) {
+  // Turn connections away once the workers are too far behind rather than letting every request wait. The request is
+  // left unread, so the connection lingers rather than being reset before the client has read the response
+  connection_t *connection = pending->connection;
+  config_t *config = config_getGlobalConfig();
+  size_t maxQueuedConnections = config_getMaxQueuedConnections(config);
+  if (work_queue_getLength(server_connectionQueue) >= maxQueuedConnections) {
+    log(LOG_DEBUG, "Turning away connection as %zu connections are already queued", maxQueuedConnections);
+    worker_shedConnection(connection, WORKER_SHED_QUEUE_FULL);
+    connection_setDeadline(connection, CONNECTION_LINGER_TIMEOUT, SHUT_RDWR);
+    pending->isLingering = true;
+    return server_lingerConnection(pending);
+  }
+
+  // Add the connection to the worker pool. Connections of the same client prefer the same worker.
+  // The header deadline is paused while queued, the worker resumes it with what's left (see worker_handleConnection).
+  // Meanwhile, the connection is answered with 503 once it has waited for the queue timeout
+  connection->queuedAt = time_getMilliseconds();
+  worker_setQueueDeadline(connection, config_getQueueTimeout(config));
+  if (!work_queue_push(server_connectionQueue, connection, connection_getAffinity(connection)))
+    connection_free(connection);
+  return false;
+}
+
+bool server_lingerConnection(server_pending_connection_t *pending) {
+  connection_t *connection = pending->connection;
+  if (connection_hasTimedOut(connection) || !connection_discard(connection)) {
+    connection_free(connection);
+    return false;
+  }
+
+  pending->events = POLLIN;
+  return true;
+}
+
+uring_t *server_createRing() {
+  if (socketDescriptorCount > SERVER_RING_ENTRIES)
+    return 0;
+
+  uring_t *ring = uring_create(SERVER_RING_ENTRIES);
+  if (ring == 0)
+    return 0;
+
+  // Each listening socket is accepted from until the accept fails (see server_acceptFromRing)
+  for (size_t i = 0; i < socketDescriptorCount; i++)
+    uring_acceptMultishot(ring, socketDescriptors[i].fd, i, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+  return ring;
+}
+
+int server_acceptFromRing() {
+  // Time out in order to scale the worker pool while idle and to handle deadlines
+  int timeout = timer_wheel_getLength(server_timers) > 0 ? SERVER_TIMER_RESOLUTION : SERVER_SCALING_INTERVAL;
+  if (uring_wait(server_ring, timeout) <= 0)
+    return 0;
+
+  int acceptedSockets = 0;
+  uring_completion_t completion;
+  while (server_ring != 0 && uring_getCompletion(server_ring, &completion)) {
+    if ((completion.userData & SERVER_RING_CONNECTION) != 0) {
+      server_pending_connection_t *pending = (server_pending_connection_t *)(uintptr_t)(completion.userData & ~SERVER_RING_CONNECTION);
+      if (completion.result < 0) {
+        log(LOG_ERROR, "Unable to wait for connection: %d (%s)", -completion.result, strerror(-completion.result));
+        connection_free(pending->connection);
+        server_removePendingConnection(pending);
+      } else {
+        server_resumeConnection(pending);
+      }
       continue;
+    }
 
-    // Accept each waiting socket
-    struct sockaddr_in peerAddress;
-    socklen_t addressLength = sizeof(peerAddress);
-    int socket = -1;
-    while ((socket = accept(socketDescriptors[i].fd, (struct sockaddr *)&peerAddress, &addressLength)) != -1) {
-      bool isNonBlocking = server_setNonBlocking(socket);
-      if (!isNonBlocking) {
-        log(LOG_ERROR, "Unable to make socket non-blocking");
+    size_t listener = (size_t)completion.userData;
+    if (completion.result >= 0) {
+      int socket = completion.result;
+      // The sockets are already non-blocking, but the peer's address must be requested
+      struct sockaddr_storage peerAddress;
+      socklen_t peerAddressLength = sizeof(peerAddress);
+      if (getpeername(socket, (struct sockaddr *)&peerAddress, &peerAddressLength) == 0) {
+        server_acceptedConnections++;
+        server_setupConnection(socket, &peerAddress, peerAddressLength);
+        acceptedSockets++;
+      } else {
         close(socket);
-        continue;
       }
+    } else if (completion.result == -EINVAL) {
+      // Multishot accepts require Linux 5.19
+      log(LOG_WARNING, "The kernel does not support accepting connections using io_uring - using poll");
+      server_closeRing();
+      break;
+    } else {
+      server_countAcceptError(-completion.result);
+    }
+
+    // Accept again once the kernel stops accepting, such as when out of file descriptors
+    if (!completion.hasMore && listener < socketDescriptorCount)
+      uring_acceptMultishot(server_ring, socketDescriptors[listener].fd, listener, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  }
+
+  return acceptedSockets;
+}
+
+size_t server_getShedConnections() {
+  size_t shedConnections = 0;
+  for (size_t i = 0; i < WORKER_SHED_REASONS; i++)
+    shedConnections += worker_getShedConnections(i);
+  return shedConnections;
+}
+
+void server_closeRing() {
+  if (server_ring == 0)
+    return;
+
+  uring_free(server_ring);
+  server_ring = 0;
+}
+
+void server_scaleWorkerPool() {
+  uint64_t now = time_getMilliseconds();
+
+  // Join workers that have retired
+  for (size_t i = 0; i < server_workerPoolSize && server_retiringWorkers > 0; i++) {
+    worker_t *worker = server_workerPool[i];
+    if (worker == 0 || worker_getStatus(worker) != WORKER_STATUS_EXITED)
+      continue;
+
+    log(LOG_DEBUG, "Joining retired worker %d", worker->id);
+    worker_waitForExit(worker);
+    worker_free(worker);
+    server_workerPool[i] = 0;
+    server_workers--;
+    server_retiringWorkers--;
+  }
+
+  size_t idleWorkers = 0;
+  size_t retiredWorkers = 0;
+  for (size_t i = 0; i < server_workerPoolSize; i++) {
+    worker_t *worker = server_workerPool[i];
+    if (worker == 0)
+      continue;
 
-      // Setup the connection
-      connection_t *connection = connection_create();
-      if (connection == 0) {
-        log(LOG_ERROR, "Failed to create connection");
+    uint8_t status = worker_getStatus(worker);
+    if (status == WORKER_STATUS_IDLE)
+      idleWorkers++;
+    else if (status == WORKER_STATUS_RETIRING || status == WORKER_STATUS_EXITED)
+      retiredWorkers++;
+  }
+
+  // Messages to retire that have not been taken yet are not connections. They go to idle workers, which will not handle
+  // any new connections once they have taken them
+  size_t pendingRetirements = server_retiringWorkers > retiredWorkers ? server_retiringWorkers - retiredWorkers : 0;
+  size_t queueDepth = work_queue_getLength(server_connectionQueue);
+  queueDepth = queueDepth > pendingRetirements ? queueDepth - pendingRetirements : 0;
+  idleWorkers = idleWorkers > pendingRetirements ? idleWorkers - pendingRetirements : 0;
+  size_t activeWorkers = server_workers - server_retiringWorkers;
+
+  if (now - server_scalingIntervalStart >= SERVER_SCALING_INTERVAL) {
+    server_scalingIntervalStart = now;
+    server_spawnedWorkersInInterval = 0;
+  }
+
+  // Grow if there are more connections waiting than there are workers to take them
+  if (queueDepth > idleWorkers) {
+    server_surplusSince = 0;
+
+    size_t workersToSpawn = queueDepth - idleWorkers;
+    if (workersToSpawn > SERVER_WORKER_SPAWN_LIMIT - server_spawnedWorkersInInterval)
+      workersToSpawn = SERVER_WORKER_SPAWN_LIMIT - server_spawnedWorkersInInterval;
+    if (workersToSpawn > server_workerPoolSize - server_workers)
+      workersToSpawn = server_workerPoolSize - server_workers;
+
+    size_t spawnedWorkers = 0;
+    for (size_t i = 0; i < server_workerPoolSize && spawnedWorkers < workersToSpawn; i++) {
+      if (server_workerPool[i] != 0)
         continue;
-      }
-      connection_setSocket(connection, socket);
-      connection_setSourcePort(connection, ntohs(peerAddress.sin_port));
-      connection_setSourceAddress(connection, string_fromBuffer(inet_ntoa(peerAddress.sin_addr)));
-
-      log(LOG_DEBUG, "Setting up connection for %s:%i", string_getBuffer(connection->sourceAddress), connection->sourcePort);
-
-      connection_pollForData(connection, 100);
-      bool isSSL = connection_isSSL(connection);
-      if (isSSL) {
-        log(LOG_DEBUG, "Handling TLS setup for %s:%d", string_getBuffer(connection_getSourceAddress(connection)), connection_getSourcePort(connection));
-        connection->ssl = server_handleSSL(connection);
-        if (connection->ssl == 0) {
-          log(LOG_DEBUG, "Failed to setup TLS");
-          connection_free(connection);
-          continue;
-        }
-
-        log(LOG_DEBUG, "Successfully setup TLS for connection");
+
+      worker_t *worker = worker_spawn(server_nextWorkerId++, 0, server_connectionQueue, i);
+      if (worker == 0) {
+        log(LOG_ERROR, "Unable to grow the worker pool");
+        break;
       }
 
-      // Add the connection to the worker pool
-      message_queue_push(server_connectionQueue, connection);
+      server_workerPool[i] = worker;
+      server_workers++;
+      server_spawnedWorkersInInterval++;
+      spawnedWorkers++;
     }
+
+    if (spawnedWorkers > 0)
+      log(LOG_DEBUG, "Grew the worker pool to %zu workers (%zu connections waiting)", server_workers - server_retiringWorkers, queueDepth);
+    return;
+  }
+
+  // Shrink if there have been surplus idle workers for a while, one worker at a time
+  size_t minimumWorkers = config_getMinimumNumberOfThreads(config_getGlobalConfig());
+  bool hasSurplus = queueDepth == 0 && idleWorkers > SERVER_WORKER_SPARE && activeWorkers > minimumWorkers;
+  if (!hasSurplus) {
+    server_surplusSince = 0;
+    return;
   }
 
-  return status;
+  if (server_surplusSince == 0)
+    server_surplusSince = now;
+
+  if (now - server_surplusSince >= SERVER_WORKER_RETIRE_DELAY && now - server_lastRetirement >= SERVER_SCALING_INTERVAL) {
+    log(LOG_DEBUG, "Shrinking the worker pool to %zu workers (%zu idle)", activeWorkers - 1, idleWorkers);
+    worker_retire(server_connectionQueue);
+    server_retiringWorkers++;
+    server_lastRetirement = now;
+  }
 }
 
 int server_handleServerNameIdentification(SSL *ssl, int *alert, void *arg) {
@@ -291,6 +972,13 @@ int server_handleServerNameIdentification(SSL *ssl, int *alert, void *arg) {
   SSL_CTX_free(SSL_get_SSL_CTX(ssl));
   SSL_set_SSL_CTX(ssl, sslContext);
 
+#ifdef SSL_OP_ENABLE_KTLS
+  // Options are not inherited when switching context. They must be set before the keys are
+  // derived for OpenSSL to enable kernel TLS as soon as the handshake is done
+  if ((SSL_CTX_get_options(sslContext) & SSL_OP_ENABLE_KTLS) != 0)
+    SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+#endif
+
   return SSL_TLSEXT_ERR_OK;
 }
 
@@ -308,61 +996,25 @@ DH *server_handleDiffieHellmanParameters(SSL *ssl, int isExport, int keyLength)
   return dhparams;
 }
 
-SSL *server_handleSSL(connection_t *connection) {
+SSL *server_createSSL(connection_t *connection) {
   // Create a temporary TLS context used only to receive a client hello
   // It is then replaced by server_handleServerNameIdentification with
   // the appropriate certificate before sending server hello
-  const SSL_METHOD *method = TLS_method();
-  SSL_CTX *context = SSL_CTX_new(method);
+  SSL_CTX *context = SSL_CTX_new(TLS_method());
+  if (context == 0) {
+    log(LOG_ERROR, "Unable to create TLS context");
+    return 0;
+  }
   SSL_CTX_set_tlsext_servername_callback(context, server_handleServerNameIdentification);
-  SSL *ssl = SSL_new(context);
-  SSL_set_fd(ssl, connection->socket);
-
-  // Set up structures necessary for polling
-  struct pollfd readDescriptors[1];
-  memset(readDescriptors, 0, sizeof(struct pollfd));
-  readDescriptors[0].fd = connection->socket;
-  readDescriptors[0].events = POLLIN;
 
-  struct pollfd writeDescriptors[1];
-  memset(writeDescriptors, 0, sizeof(struct pollfd));
-  writeDescriptors[0].fd = connection->socket;
-  writeDescriptors[0].events = POLLOUT;
-
-  while (true) {
-    int status = SSL_accept(ssl);
-    if (status == 0) {
-      log(LOG_ERROR, "Unable to accept TLS socket");
-      SSL_free(ssl);
-    } else if (status < 0) {
-      int error = SSL_get_error(ssl, status);
-      if (error == SSL_ERROR_WANT_READ) {
-        log(LOG_DEBUG, "Waiting for TLS connection to be readable");
-        // Wait for the connection to be ready to read
-        int status = poll(readDescriptors, 1, -1);
-        if (status < -1) {
-          log(LOG_ERROR, "Could not wait for connection to be readable");
-          SSL_free(ssl);
-          return 0;
-        }
-      } else if (error == SSL_ERROR_WANT_WRITE) {
-        log(LOG_DEBUG, "Waiting for TLS connection to be writable");
-        // Wait for the connection to be ready to write
-        int status = poll(writeDescriptors, 1, -1);
-        if (status < -1) {
-          log(LOG_ERROR, "Could not wait for connection to be writable");
-          SSL_free(ssl);
-          return 0;
-        }
-      } else {
-        log(LOG_ERROR, "Unable to accept TLS socket. Got code %d", error);
-        SSL_free(ssl);
-        return 0;
-      }
-    } else {
-      return ssl;
-    }
+  SSL *ssl = SSL_new(context);
+  if (ssl == 0) {
+    log(LOG_ERROR, "Unable to create TLS state");
+    SSL_CTX_free(context);
+    return 0;
   }
+  SSL_set_fd(ssl, connection->socket);
+  return ssl;
 }
 
 void server_closeGracefully() {
@@ -370,20 +1022,26 @@ void server_closeGracefully() {
   // Remove graceful signal handlers as they could interfere with shutdown process
   signal(SIGINT, server_emptySignalHandler);
   signal(SIGTERM, server_emptySignalHandler);
+  signal(SERVER_SIGNAL_DRAIN, server_emptySignalHandler);
+  signal(SIGHUP, server_emptySignalHandler);
 
+  // The sockets are shared with the main process and other instances - only close this instance's descriptors
   log(LOG_DEBUG, "Closing listening sockets");
-  for (size_t i = 0; i < socketDescriptorCount; i++) {
-    int socket = socketDescriptors[i].fd;
-    shutdown(socket, SHUT_RDWR);
-    close(socket);
-  }
+  server_closeRing();
+  for (size_t i = 0; i < socketDescriptorCount; i++)
+    close(socketDescriptors[i].fd);
+  socketDescriptorCount = 0;
+
+  // Pending connections have not sent a request yet
+  log(LOG_DEBUG, "Closing %zu pending connections", server_pendingConnectionCount);
+  server_freePendingConnections();
 
   log(LOG_DEBUG, "Suspending worker threads");
   // Cancel all threads before joining them (see deferred cancellation points)
-  config_t *config = config_getGlobalConfig();
-  size_t threads = config_getNumberOfThreads(config);
-  for (size_t i = 0; i < threads; i++) {
+  for (size_t i = 0; i < server_workerPoolSize; i++) {
     worker_t *worker = server_workerPool[i];
+    if (worker == 0)
+      continue;
     log(LOG_DEBUG, "Suspending thread %zu (status was %d)", i, worker->status);
     // Let the workers exit when ready (let's them handle the current request)
     worker_closeGracefully(worker);
@@ -391,10 +1049,12 @@ void server_closeGracefully() {
 
   // Unlock all threads
   log(LOG_DEBUG, "Unlocking all threads");
-  message_queue_unlock(server_connectionQueue);
+  work_queue_unlock(server_connectionQueue);
 
-  for (size_t i = 0; i < threads; i++) {
+  for (size_t i = 0; i < server_workerPoolSize; i++) {
     worker_t *worker = server_workerPool[i];
+    if (worker == 0)
+      continue;
     // Wait for the thread to join
     log(LOG_DEBUG, "Joining thread %zu", i);
     worker_waitForExit(worker);
@@ -406,27 +1066,103 @@ void server_closeGracefully() {
   // in detecting memory leaks
   server_workerPool = 0;
 
+  log(LOG_INFO, "Accepted %zu connections (at most %zu per second), %zu failed accepts", server_acceptedConnections, server_peakAcceptRate, server_failedAccepts);
+  log(LOG_INFO, "Workers took %zu connections from the queues of busy workers", work_queue_getSteals(server_connectionQueue));
+  log(LOG_INFO, "Answered %zu connections with 503: %zu with a full queue, %zu after waiting too long and %zu over the CGI limit", server_getShedConnections(), worker_getShedConnections(WORKER_SHED_QUEUE_FULL), worker_getShedConnections(WORKER_SHED_QUEUE_TIMEOUT), worker_getShedConnections(WORKER_SHED_CGI_LIMIT));
+  if (server_clientLimits != 0)
+    log(LOG_INFO, "Refused %zu connections and answered %zu requests with 429 of clients over their limits (%zu connections not limited)", server_clientLimits->rejectedConnections, server_clientLimits->rejectedRequests, server_clientLimits->untrackedConnections);
+
+  // The I/O pool is only created once a worker serves a file
+  if (io_pool_hasGlobalPool()) {
+    io_pool_t *ioPool = io_pool_getGlobalPool();
+    pthread_mutex_lock(&ioPool->mutex);
+    log(LOG_INFO, "Disk I/O: %zu jobs completed, %zu timed out, %zu dropped, at most %zu queued", ioPool->completedJobs, ioPool->timedOutJobs, ioPool->droppedJobs, ioPool->maxQueueLength);
+    pthread_mutex_unlock(&ioPool->mutex);
+  }
+
   // Free after all workers are stopped (they may be using the sockets up until that point)
   log(LOG_DEBUG, "Freeing socket descriptors");
   free(socketDescriptors);
+  free(server_pollDescriptors);
 
   log(LOG_DEBUG, "Cleaning up OpenSSL");
   FIPS_mode_set(0);
   CRYPTO_cleanup_all_ex_data();
   ERR_free_strings();
 
-  log(LOG_DEBUG, "Freeing message queue");
-  message_queue_free(server_connectionQueue);
+  // Connections still queued were never taken by a worker. They're freed before the timers their deadlines use
+  size_t queuedConnections = worker_freeQueuedConnections(server_connectionQueue);
+  log(LOG_DEBUG, "Closed %zu queued connections", queuedConnections);
+  log(LOG_DEBUG, "Freeing connection queue");
+  work_queue_free(server_connectionQueue);
+
+  // All connections have been freed along with the workers and the queue
+  log(LOG_DEBUG, "Freeing timers");
+  timer_wheel_free(server_timers);
+  log(LOG_DEBUG, "Freeing client limits");
+  if (server_clientLimits != 0)
+    client_limits_free(server_clientLimits);
+  log(LOG_DEBUG, "Freeing connection pool");
+  connection_freePool();
 
   // This helps mark the memory as non-reachable which aids memory analyzers
   // in detecting memory leaks
   socketDescriptors = 0;
+  server_pollDescriptors = 0;
   server_connectionQueue = 0;
+  server_timers = 0;
+  server_clientLimits = 0;
 
   log(LOG_DEBUG, "Exiting from server");
   exit(0);
 }
 
+void server_drain() {
+  log(LOG_INFO, "Draining server instance");
+  // Stop accepting connections. Pending connections remain in the shared sockets for the replacement instance
+  server_closeRing();
+  for (size_t i = 0; i < socketDescriptorCount; i++)
+    close(socketDescriptors[i].fd);
+  socketDescriptorCount = 0;
+
+  // Wait for queued connections to be handled by the workers
+  uint64_t drainStart = time_getMilliseconds();
+  while (time_getMilliseconds() - drainStart < SERVER_DRAIN_TIMEOUT && !server_shouldClose) {
+    size_t busyWorkers = 0;
+    for (size_t i = 0; i < server_workerPoolSize; i++) {
+      worker_t *worker = server_workerPool[i];
+      if (worker != 0 && worker_getStatus(worker) == WORKER_STATUS_WORKING)
+        busyWorkers++;
+    }
+
+    size_t queueDepth = work_queue_getLength(server_connectionQueue);
+    if (busyWorkers == 0 && queueDepth == 0 && server_pendingConnectionCount == 0)
+      break;
+
+    log(LOG_DEBUG, "Waiting for %zu busy workers, %zu queued connections and %zu pending connections", busyWorkers, queueDepth, server_pendingConnectionCount);
+    // Pending connections are polled until they're ready or their deadline has passed
+    if (server_pendingConnectionCount > 0)
+      server_acceptConnections();
+    else
+      usleep(SERVER_DRAIN_INTERVAL * 1000);
+    timer_wheel_advance(server_timers, time_getMilliseconds());
+  }
+
+  server_closeGracefully();
+}
+
+void server_handleCloseSignal() {
+  server_shouldClose = 1;
+}
+
+void server_handleDrainSignal() {
+  server_shouldDrain = 1;
+}
+
+void server_handleReloadSignal() {
+  server_shouldReloadConfig = 1;
+}
+
 void server_emptySignalHandler() {
   // Do nothing
 }
@@ -1,11 +1,13 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+#include <signal.h>
 #include <stdbool.h>
 #include <unistd.h>
 #include <stdint.h>
 
 #include "../connection/connection.h"
+#include "../datastructures/list/list.h"
 #include "../datastructures/set/set.h"
 
 /* The protocol specifies a particular protocol to be used with the
@@ -17,14 +19,59 @@
 
 #define SERVER_EXIT_FATAL 10
 
-pid_t server_createInstance(const set_t *ports) __attribute__((nonnull(1)));
+// Signal asking an instance to stop accepting connections, finish in-flight work and exit
+#define SERVER_SIGNAL_DRAIN SIGUSR2
+// The maximum number of connections accepted from one listening socket at a time, so that a busy port can't starve the others
+#define SERVER_ACCEPT_BUDGET 16
+
+// The number of submissions the io_uring accepting connections has room for. At least the number of listening sockets
+#define SERVER_RING_ENTRIES 64
+// Marks the io_uring completions of pending connections, the remaining bits being the address of the connection
+#define SERVER_RING_CONNECTION 0x8000000000000000ULL
+// The number of pending connections (waiting for data or a TLS handshake) room is first made for
+#define SERVER_PENDING_CAPACITY 64
+
+// The maximum time in milliseconds a draining instance waits for in-flight work before closing
+#define SERVER_DRAIN_TIMEOUT 30000
+// How often in milliseconds a draining instance checks whether in-flight work is done
+#define SERVER_DRAIN_INTERVAL 100
+
+// How often (at least) the worker pool is scaled in milliseconds
+#define SERVER_SCALING_INTERVAL 1000
+// The resolution of connection deadlines in milliseconds
+#define SERVER_TIMER_RESOLUTION 100
+// The maximum number of workers to spawn during one scaling interval
+#define SERVER_WORKER_SPAWN_LIMIT 8
+// The number of idle workers to keep in addition to the minimum when shrinking the pool
+#define SERVER_WORKER_SPARE 2
+// How long in milliseconds there must be surplus idle workers before the pool starts shrinking
+#define SERVER_WORKER_RETIRE_DELAY 10000
+
+// Fork a server instance accepting connections from the (inherited) listening sockets. Returns the pid or 0 if failed
+pid_t server_createInstance(const list_t *listeningSockets) __attribute__((nonnull(1)));
 // Main entrypoint for a server instance
-int server_start(const set_t *ports) __attribute__((nonnull(1)));
-// Start listening on a port. Returns the listening socket or 0 if failed
-int server_listen(uint16_t port, size_t backlog);
-// Block until at least one of the bound ports receives a request. Returns the number of sockets to handle (0 if failed)
+int server_start(const list_t *listeningSockets) __attribute__((nonnull(1)));
+// Start listening on each port. Returns a list of listening sockets (empty if no port could be bound) or 0 if failed
+list_t *server_listenToPorts(const set_t *ports) __attribute__((nonnull(1)));
+// Start listening on a port. TCP_DEFER_ACCEPT and TCP_FASTOPEN are used if deferAccept and fastOpen are not 0 (see config_getDeferAccept).
+// Returns the listening socket or 0 if failed
+int server_listen(uint16_t port, size_t backlog, int deferAccept, int fastOpen);
+// Block until at least one of the bound ports receives a request, a pending connection is ready or a deadline may have passed.
+// Returns the number of ports with incoming sockets when using poll, or the number of accepted sockets when using io_uring
+// (0 if failed or timed out)
 int server_acceptConnections();
-SSL *server_handleSSL(connection_t *connection) __attribute__((nonnull(1)));
+// Accept a socket from a listening socket, made non-blocking and closed on exec. Returns -1 if failed (see errno)
+int server_acceptSocket(int listeningSocket, struct sockaddr_storage *peerAddress, socklen_t *peerAddressLength) __attribute__((nonnull(2, 3)));
+// Accept the next socket of a listening socket's backlog, skipping connections aborted while waiting in it. Returns -1 once
+// the backlog is empty (errno is EAGAIN or EWOULDBLOCK) or if failed (see errno)
+int server_acceptNextSocket(int listeningSocket, struct sockaddr_storage *peerAddress, socklen_t *peerAddressLength) __attribute__((nonnull(2, 3)));
+// Set up a connection for an accepted non-blocking socket. It's queued for the workers once it has sent data and
+// completed any TLS handshake, which the main thread waits for along with accepting connections
+void server_setupConnection(int socket, const struct sockaddr_storage *peerAddress, socklen_t peerAddressLength) __attribute__((nonnull(2)));
+// Grow or shrink the worker pool depending on the queue depth and the number of idle workers
+void server_scaleWorkerPool();
+// Create the TLS state of a connection, using a temporary context until the client hello names the server. Returns 0 if failed
+SSL *server_createSSL(connection_t *connection) __attribute__((nonnull(1)));
 void server_closeConnection(connection_t *connection) __attribute__((nonnull(1)));
 
 void server_close();
@@ -1,34 +1,36 @@
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../datastructures/arena/arena.h"
+#include "../format/format.h"
+
 #include "string.h"
 
+// Resize the buffer to bufferSize bytes (including null termination), moving between the inline buffer and an
+// allocated buffer as needed. The content is kept up until the new size
+bool string_resizeBuffer(string_t *string, size_t bufferSize);
+
 string_t *string_create() {
-  string_t *string = malloc(sizeof(string_t));
+  string_t *string = arena_malloc(sizeof(string_t));
   if (string == 0)
     return 0;
 
-  string->buffer = 0;
-  string->bufferSize = 0;
+  string->buffer = string->inlineBuffer;
+  string->bufferSize = STRING_INLINE_SIZE;
   string->size = 0;
+  string->inlineBuffer[0] = 0;
 
   return string;
 }
 
 void string_setBufferSize(string_t *string, size_t bufferSize) {
-  if (bufferSize == string->bufferSize)
+  if (bufferSize + 1 == string->bufferSize)
     return;
 
   // Reallocate with null termination included in the buffer size
-  char *newBuffer = realloc(string->buffer, bufferSize + 1);
-  if (newBuffer == 0)
+  if (!string_resizeBuffer(string, bufferSize + 1))
     return;
 
-  // Update the buffer and size
-  string->bufferSize = bufferSize + 1;
-  string->buffer = newBuffer;
-
   // Shrink the string size if larger than the buffer size
   if (string->size + 1 >= string->bufferSize)
     string->size = string->bufferSize - 1;
@@ -44,7 +46,7 @@ void string_clear(string_t *string) {
 }
 
 string_cursor_t *string_createCursor(const string_t *string) {
-  string_cursor_t *cursor = malloc(sizeof(string_cursor_t));
+  string_cursor_t *cursor = arena_malloc(sizeof(string_cursor_t));
   if (cursor == 0)
     return 0;
 
@@ -64,16 +66,15 @@ string_t *string_fromBufferWithLength(const char *buffer, size_t length) {
   if (string == 0)
     return 0;
 
-  string->size = length;
-  string->bufferSize = length + 1;
-  string->buffer = malloc(sizeof(char) * (string->bufferSize));
-  if (string->buffer == 0) {
-    free(string);
+  // Short strings fit in the inline buffer
+  if (length + 1 > string->bufferSize && !string_resizeBuffer(string, length + 1)) {
+    arena_release(string);
     return 0;
   }
 
+  string->size = length;
   memcpy(string->buffer, buffer, string->size);
-  string->buffer[string->bufferSize - 1] = 0;
+  string->buffer[length] = 0;
 
   return string;
 }
@@ -90,34 +91,13 @@ string_t *string_copy(const string_t *string) {
 }
 
 string_t *string_fromInt(int number) {
-  if (number == 0)
-    return string_fromBuffer("0");
-
-  string_t *string = string_create();
-  if (string == 0)
-    return 0;
-  // Get the rough number of digits in the number
-  int digits = (int)log10(abs(number)) + 1;
-  // Pre-allocate the rough number of necessary digits
-  string_setBufferSize(string, digits);
-
-  // Parse sign
-  if (number < 0) {
-    string_appendChar(string, '-');
-    number = abs(number);
-  }
-
-  // Parse the integer left to right
-  for (int offset = digits; offset > 0; offset--) {
-    int digit = (int)(number / pow(10, offset - 1)) % 10;
-    string_appendChar(string, (char)('0' + digit));
-  }
-
-  return string;
+  char buffer[FORMAT_INTEGER_LENGTH];
+  size_t length = format_integer(buffer, number);
+  return string_fromBufferWithLength(buffer, length);
 }
 
 void string_append(string_t *string, const string_t *string2) {
-  string_appendBuffer(string, string2->buffer);
+  string_appendBufferWithLength(string, string2->buffer, string2->size);
 }
 
 void string_appendBuffer(string_t *string, const char *buffer) {
@@ -128,20 +108,20 @@ void string_appendBuffer(string_t *string, const char *buffer) {
 void string_appendBufferWithLength(string_t *string, const char *buffer, size_t bufferSize) {
   size_t newSize = string->size + bufferSize;
 
-  // Expand if necessary
+  // Expand if necessary. Grow geometrically to keep repeated appends (and arena copies) amortized
   if (newSize >= string->bufferSize) {
-    char *expandedBuffer = realloc(string->buffer, sizeof(char) * (newSize + 1));
-    if (expandedBuffer == 0)
+    size_t expandedSize = newSize + 1;
+    if (string->bufferSize > 0 && expandedSize < string->bufferSize * 2)
+      expandedSize = string->bufferSize * 2;
+    if (!string_resizeBuffer(string, expandedSize))
       return;
-    string->buffer = expandedBuffer;
-    string->bufferSize = newSize + 1;
   }
 
   if (bufferSize > 0 && buffer[bufferSize - 1] == 0)
     memcpy(string->buffer + string->size, buffer, bufferSize - 1);
   else
     memcpy(string->buffer + string->size, buffer, bufferSize);
-  string->buffer[string->bufferSize - 1] = 0;
+  string->buffer[newSize] = 0;
   string->size = newSize;
 }
 
@@ -255,13 +235,14 @@ string_t *string_getNextLine(string_cursor_t *cursor) {
 }
 
 ssize_t string_findNextChar(string_cursor_t *cursor, char needle) {
-  ssize_t index = -1;
-  char current = 0;
-  while ((current = string_getNextChar(cursor)) != 0) {
-    if (current == needle) {
-      index = cursor->offset - 1;
-      break;
-    }
+  ssize_t index = string_view_findChar(string_getView(cursor->string), cursor->offset, needle);
+
+  // Move past the character, or to the end if not found
+  if (index == -1) {
+    if (cursor->offset < cursor->string->size)
+      cursor->offset = cursor->string->size;
+  } else {
+    cursor->offset = index + 1;
   }
 
   return index;
@@ -276,20 +257,133 @@ void string_setOffset(string_cursor_t *cursor, size_t offset) {
 }
 
 bool string_equalsBuffer(const string_t *string, const char *buffer) {
-  return strcmp(string->buffer, buffer) == 0;
+  return string_view_equalsBuffer(string_getView(string), buffer);
 }
 
 bool string_equals(const string_t *string, const string_t *string2) {
-  return string_equalsBuffer(string, string2->buffer);
+  return string_view_equals(string_getView(string), string_getView(string2));
+}
+
+string_view_t string_getView(const string_t *string) {
+  string_view_t view = {string->buffer, string->size};
+  return view;
+}
+
+string_view_t string_getSubview(const string_t *string, size_t firstIndex, size_t lastIndex) {
+  return string_view_substring(string_getView(string), firstIndex, lastIndex);
+}
+
+string_t *string_fromView(string_view_t view) {
+  if (view.buffer == 0)
+    return string_create();
+
+  return string_fromBufferWithLength(view.buffer, view.size);
+}
+
+string_view_t string_view_fromBuffer(const char *buffer) {
+  string_view_t view = {buffer, strlen(buffer)};
+  return view;
+}
+
+string_view_t string_view_substring(string_view_t view, size_t firstIndex, size_t lastIndex) {
+  string_view_t substring = {0, 0};
+  // Out of bounds
+  if (firstIndex > lastIndex || lastIndex > view.size)
+    return substring;
+
+  substring.buffer = view.buffer + firstIndex;
+  substring.size = lastIndex - firstIndex;
+  return substring;
+}
+
+ssize_t string_view_findChar(string_view_t view, size_t offset, char needle) {
+  if (offset >= view.size)
+    return -1;
+
+  const char *match = memchr(view.buffer + offset, needle, view.size - offset);
+  if (match == 0)
+    return -1;
+
+  return match - view.buffer;
+}
+
+bool string_view_equals(string_view_t view, string_view_t view2) {
+  // Sizes are known - only compare the contents of equally sized views
+  if (view.size != view2.size)
+    return false;
+
+  return view.size == 0 || memcmp(view.buffer, view2.buffer, view.size) == 0;
+}
+
+bool string_view_equalsBuffer(string_view_t view, const char *buffer) {
+  return string_view_equals(view, string_view_fromBuffer(buffer));
+}
+
+bool string_view_equalsCaseInsensitive(string_view_t view, string_view_t view2) {
+  if (view.size != view2.size)
+    return false;
+
+  // Only ASCII letters are folded. Unlike strncasecmp, this doesn't depend on the locale or stop at null characters
+  for (size_t i = 0; i < view.size; i++) {
+    char character = view.buffer[i];
+    char character2 = view2.buffer[i];
+    if (character == character2)
+      continue;
+    if ((character | 0x20) != (character2 | 0x20) || (uint8_t)((character | 0x20) - 'a') > 'z' - 'a')
+      return false;
+  }
+
+  return true;
+}
+
+bool string_view_equalsBufferCaseInsensitive(string_view_t view, const char *buffer) {
+  return string_view_equalsCaseInsensitive(view, string_view_fromBuffer(buffer));
+}
+
+bool string_view_startsWithBuffer(string_view_t view, const char *buffer) {
+  size_t length = strlen(buffer);
+  return view.size >= length && memcmp(view.buffer, buffer, length) == 0;
 }
 
 void string_free(string_t *string) {
-  if (string->buffer != 0)
-    free(string->buffer);
+  if (string->buffer != string->inlineBuffer)
+    arena_release(string->buffer);
+
+  arena_release(string);
+}
+
+bool string_resizeBuffer(string_t *string, size_t bufferSize) {
+  bool isInline = string->buffer == string->inlineBuffer;
+
+  if (bufferSize <= STRING_INLINE_SIZE) {
+    // Move short strings back into the inline buffer
+    if (!isInline) {
+      memcpy(string->inlineBuffer, string->buffer, string->size + 1 < bufferSize ? string->size + 1 : bufferSize);
+      arena_release(string->buffer);
+      string->buffer = string->inlineBuffer;
+    }
 
-  free(string);
+    string->bufferSize = bufferSize;
+    return true;
+  }
+
+  char *newBuffer = 0;
+  if (isInline) {
+    newBuffer = arena_malloc(sizeof(char) * bufferSize);
+    if (newBuffer != 0)
+      memcpy(newBuffer, string->inlineBuffer, string->size + 1 < bufferSize ? string->size + 1 : bufferSize);
+  } else {
+    newBuffer = arena_realloc(string->buffer, sizeof(char) * bufferSize);
+  }
+
+  if (newBuffer == 0)
+    return false;
+
+  string->buffer = newBuffer;
+  string->bufferSize = bufferSize;
+  return true;
 }
 
 void string_freeCursor(string_cursor_t *cursor) {
-  free(cursor);
+  arena_release(cursor);
 }
@@ -9,18 +9,30 @@
 * A 'string' is a string_t defined by this library
 * A 'buffer' is a char buffer allocated to hold raw bytes
 * A 'buffer-based string' is a null-terminated, "regular c string" buffer
+* A 'view' is a non-owning slice of a buffer, which is not necessarily null-terminated
 * Notes:
 * The buffer size is the full size of the buffer - including null byte
+* Short strings are stored within the string_t itself, so the buffer is only valid as long as the string is
 */
 
+// Strings of up to STRING_INLINE_SIZE - 1 characters don't allocate a separate buffer
+#define STRING_INLINE_SIZE 24
+
 typedef struct {
   char *buffer;
   // The buffer's total size (for internal use only)
   size_t bufferSize;
   // The current size of the string (content length, not buffer size)
   size_t size;
+  // The buffer used for short strings (for internal use only)
+  char inlineBuffer[STRING_INLINE_SIZE];
 } string_t;
 
+typedef struct {
+  const char *buffer;
+  size_t size;
+} string_view_t;
+
 typedef struct {
   const string_t *string;
   size_t offset;
@@ -78,6 +90,28 @@ void string_setOffset(string_cursor_t *cursor, size_t offset) __attribute__((non
 bool string_equalsBuffer(const string_t *string, const char *buffer) __attribute__((nonnull(1, 2)));
 // Compare a string to another
 bool string_equals(const string_t *string, const string_t *string2) __attribute__((nonnull(1, 2)));
+
+// Get a view of an entire string. Valid until the string is modified or freed
+string_view_t string_getView(const string_t *string) __attribute__((nonnull(1)));
+// Get a view of a string with inclusive first index and exclusive last index. Empty if out of bounds
+string_view_t string_getSubview(const string_t *string, size_t firstIndex, size_t lastIndex) __attribute__((nonnull(1)));
+// Create a string by copying a view
+string_t *string_fromView(string_view_t view);
+// Get a view of a buffer-based string
+string_view_t string_view_fromBuffer(const char *buffer) __attribute__((nonnull(1)));
+// Get a view with inclusive first index and exclusive last index. Empty if out of bounds
+string_view_t string_view_substring(string_view_t view, size_t firstIndex, size_t lastIndex);
+// Get the index of the first occurance of a character at or after offset (-1 if not found)
+ssize_t string_view_findChar(string_view_t view, size_t offset, char needle);
+// Compare two views
+bool string_view_equals(string_view_t view, string_view_t view2);
+// Compare a view to a buffer-based string
+bool string_view_equalsBuffer(string_view_t view, const char *buffer) __attribute__((nonnull(2)));
+// Compare two views, ignoring the case of ASCII letters
+bool string_view_equalsCaseInsensitive(string_view_t view, string_view_t view2);
+bool string_view_equalsBufferCaseInsensitive(string_view_t view, const char *buffer) __attribute__((nonnull(2)));
+// Whether or not a view starts with a buffer-based string
+bool string_view_startsWithBuffer(string_view_t view, const char *buffer) __attribute__((nonnull(2)));
 // Free a string
 void string_free(string_t *string) __attribute__((nonnull(1)));
 // Free a cursor
@@ -72,6 +72,13 @@ bool time_getTimeSinceStart(uint64_t *nanoseconds, uint64_t *seconds) {
   }
 }
 
+uint64_t time_getMilliseconds() {
+  struct timespec now;
+  time_getTimeSinceStartOfEpoch(&now);
+
+  return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
 uint64_t time_getElapsedTime(const struct timespec *timespec) {
   struct timespec start;
   time_getTimeSinceStartOfEpoch(&start);
@@ -30,5 +30,8 @@ void time_getFormattedElapsedTime(uint64_t nanoseconds, uint64_t seconds, uint64
 // Time since time_reset() was called. Undefined behaviour if it hasn't been called
 bool time_getTimeSinceStart(uint64_t *nanoseconds, uint64_t *seconds);
 
+// Milliseconds since the start of epoch as defined by time_getTimeSinceStartOfEpoch. Only use for telling time difference
+uint64_t time_getMilliseconds();
+
 uint64_t time_getElapsedTime(const struct timespec *timespec) __attribute__((nonnull(1)));
 #endif
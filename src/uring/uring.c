@@ -0,0 +1,228 @@
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "../logging/logging.h"
+
+#include "uring.h"
+
+#ifdef __linux__
+
+// Get a free submission entry, cleared. Returns 0 if the queue is full
+struct io_uring_sqe *uring_getSubmissionEntry(uring_t *ring);
+// Map the rings of a newly set up io_uring. Returns false if failed
+bool uring_map(uring_t *ring, const struct io_uring_params *parameters);
+
+uring_t *uring_create(unsigned entries) {
+  uring_t *ring = malloc(sizeof(uring_t));
+  if (ring == 0) {
+    log(LOG_ERROR, "Failed to allocate io_uring");
+    return 0;
+  }
+  memset(ring, 0, sizeof(uring_t));
+
+  struct io_uring_params parameters;
+  memset(&parameters, 0, sizeof(struct io_uring_params));
+  ring->descriptor = (int)syscall(__NR_io_uring_setup, entries, &parameters);
+  if (ring->descriptor < 0) {
+    log(LOG_DEBUG, "Unable to set up io_uring: %d (%s)", errno, strerror(errno));
+    free(ring);
+    return 0;
+  }
+
+  // Waiting with a timeout requires Linux 5.11
+  if ((parameters.features & IORING_FEAT_EXT_ARG) == 0) {
+    log(LOG_DEBUG, "The kernel's io_uring does not support waiting with a timeout");
+    close(ring->descriptor);
+    free(ring);
+    return 0;
+  }
+
+  if (!uring_map(ring, &parameters)) {
+    log(LOG_ERROR, "Unable to map io_uring: %d (%s)", errno, strerror(errno));
+    uring_free(ring);
+    return 0;
+  }
+
+  return ring;
+}
+
+bool uring_acceptMultishot(uring_t *ring, int socket, uint64_t userData, int flags) {
+  struct io_uring_sqe *entry = uring_getSubmissionEntry(ring);
+  if (entry == 0)
+    return false;
+
+  // The peer's address is not requested as every completion would write to the same buffer
+  entry->opcode = IORING_OP_ACCEPT;
+  entry->fd = socket;
+  entry->ioprio = IORING_ACCEPT_MULTISHOT;
+  entry->accept_flags = (uint32_t)flags;
+  entry->user_data = userData;
+  return true;
+}
+
+bool uring_pollAdd(uring_t *ring, int socket, uint32_t events, uint64_t userData) {
+  struct io_uring_sqe *entry = uring_getSubmissionEntry(ring);
+  if (entry == 0)
+    return false;
+
+  entry->opcode = IORING_OP_POLL_ADD;
+  entry->fd = socket;
+  entry->poll32_events = events;
+  entry->user_data = userData;
+  return true;
+}
+
+bool uring_submit(uring_t *ring) {
+  if (ring->pendingSubmissions == 0)
+    return true;
+
+  int submitted = (int)syscall(__NR_io_uring_enter, ring->descriptor, ring->pendingSubmissions, 0, 0, NULL, 0);
+  if (submitted < 0) {
+    log(LOG_ERROR, "Unable to submit to io_uring: %d (%s)", errno, strerror(errno));
+    return false;
+  }
+
+  ring->pendingSubmissions -= (unsigned)submitted;
+  return true;
+}
+
+int uring_wait(uring_t *ring, int timeout) {
+  struct __kernel_timespec deadline = {timeout / 1000, (timeout % 1000) * 1000000LL};
+  struct io_uring_getevents_arg arguments;
+  memset(&arguments, 0, sizeof(struct io_uring_getevents_arg));
+  arguments.sigmask_sz = _NSIG / 8;
+  arguments.ts = (uint64_t)(uintptr_t)&deadline;
+
+  // Submitting and waiting takes a single system call
+  int submitted = (int)syscall(__NR_io_uring_enter, ring->descriptor, ring->pendingSubmissions, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arguments, sizeof(struct io_uring_getevents_arg));
+  if (submitted < 0 && errno != ETIME && errno != EINTR) {
+    log(LOG_ERROR, "An error occured while waiting for io_uring: %d (%s)", errno, strerror(errno));
+    return -1;
+  }
+  if (submitted > 0)
+    ring->pendingSubmissions -= (unsigned)submitted;
+
+  unsigned head = *ring->completionHead;
+  unsigned tail = __atomic_load_n(ring->completionTail, __ATOMIC_ACQUIRE);
+  return (int)(tail - head);
+}
+
+bool uring_getCompletion(uring_t *ring, uring_completion_t *completion) {
+  unsigned head = *ring->completionHead;
+  if (head == __atomic_load_n(ring->completionTail, __ATOMIC_ACQUIRE))
+    return false;
+
+  const struct io_uring_cqe *entry = &ring->completionEntries[head & ring->completionMask];
+  completion->userData = entry->user_data;
+  completion->result = entry->res;
+  completion->hasMore = (entry->flags & IORING_CQE_F_MORE) != 0;
+  // Hand the entry back to the kernel
+  __atomic_store_n(ring->completionHead, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void uring_free(uring_t *ring) {
+  if (ring->submissionEntries != 0)
+    munmap(ring->submissionEntries, ring->submissionEntriesSize);
+  if (ring->completionRing != 0 && ring->completionRing != ring->submissionRing)
+    munmap(ring->completionRing, ring->completionRingSize);
+  if (ring->submissionRing != 0)
+    munmap(ring->submissionRing, ring->submissionRingSize);
+  close(ring->descriptor);
+  free(ring);
+}
+
+struct io_uring_sqe *uring_getSubmissionEntry(uring_t *ring) {
+  unsigned tail = *ring->submissionTail;
+  if (tail - __atomic_load_n(ring->submissionHead, __ATOMIC_ACQUIRE) >= ring->submissionEntryCount)
+    return 0;
+
+  unsigned index = tail & ring->submissionMask;
+  struct io_uring_sqe *entry = &ring->submissionEntries[index];
+  memset(entry, 0, sizeof(struct io_uring_sqe));
+  ring->submissionArray[index] = index;
+  // The entry is filled in before the kernel reads it, which is not until the next io_uring_enter
+  __atomic_store_n(ring->submissionTail, tail + 1, __ATOMIC_RELEASE);
+  ring->pendingSubmissions++;
+  return entry;
+}
+
+bool uring_map(uring_t *ring, const struct io_uring_params *parameters) {
+  ring->submissionRingSize = parameters->sq_off.array + parameters->sq_entries * sizeof(unsigned);
+  ring->completionRingSize = parameters->cq_off.cqes + parameters->cq_entries * sizeof(struct io_uring_cqe);
+  // Both rings are mapped at once since Linux 5.4
+  bool isSingleMap = (parameters->features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (isSingleMap && ring->completionRingSize > ring->submissionRingSize)
+    ring->submissionRingSize = ring->completionRingSize;
+
+  void *submissionRing = mmap(0, ring->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_SQ_RING);
+  if (submissionRing == MAP_FAILED)
+    return false;
+  ring->submissionRing = submissionRing;
+
+  if (isSingleMap) {
+    ring->completionRing = ring->submissionRing;
+  } else {
+    void *completionRing = mmap(0, ring->completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_CQ_RING);
+    if (completionRing == MAP_FAILED)
+      return false;
+    ring->completionRing = completionRing;
+  }
+
+  ring->submissionEntriesSize = parameters->sq_entries * sizeof(struct io_uring_sqe);
+  void *submissionEntries = mmap(0, ring->submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_SQES);
+  if (submissionEntries == MAP_FAILED)
+    return false;
+  ring->submissionEntries = submissionEntries;
+
+  char *submissionBase = ring->submissionRing;
+  ring->submissionHead = (unsigned *)(submissionBase + parameters->sq_off.head);
+  ring->submissionTail = (unsigned *)(submissionBase + parameters->sq_off.tail);
+  ring->submissionMask = *(unsigned *)(submissionBase + parameters->sq_off.ring_mask);
+  ring->submissionArray = (unsigned *)(submissionBase + parameters->sq_off.array);
+  ring->submissionEntryCount = parameters->sq_entries;
+
+  char *completionBase = ring->completionRing;
+  ring->completionHead = (unsigned *)(completionBase + parameters->cq_off.head);
+  ring->completionTail = (unsigned *)(completionBase + parameters->cq_off.tail);
+  ring->completionMask = *(unsigned *)(completionBase + parameters->cq_off.ring_mask);
+  ring->completionEntries = (struct io_uring_cqe *)(completionBase + parameters->cq_off.cqes);
+  return true;
+}
+#else
+uring_t *uring_create(unsigned entries) {
+  return 0;
+}
+
+bool uring_acceptMultishot(uring_t *ring, int socket, uint64_t userData, int flags) {
+  return false;
+}
+
+bool uring_pollAdd(uring_t *ring, int socket, uint32_t events, uint64_t userData) {
+  return false;
+}
+
+bool uring_submit(uring_t *ring) {
+  return false;
+}
+
+int uring_wait(uring_t *ring, int timeout) {
+  return -1;
+}
+
+bool uring_getCompletion(uring_t *ring, uring_completion_t *completion) {
+  return false;
+}
+
+void uring_free(uring_t *ring) {
+  free(ring);
+}
+#endif
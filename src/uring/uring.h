@@ -0,0 +1,72 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+* A minimal io_uring wrapper using the system calls directly (no liburing).
+* Only used from a single thread: the main thread of a server instance accepting connections and waiting for them to be ready.
+* Rings can only be created on Linux.
+*/
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+typedef struct {
+  uint64_t userData;
+  // The result of the operation, such as the accepted socket, or a negated errno
+  int32_t result;
+  // Whether or not the operation produces more completions (IORING_CQE_F_MORE)
+  bool hasMore;
+} uring_completion_t;
+
+typedef struct {
+  int descriptor;
+
+  // The submission queue, shared with the kernel
+  unsigned *submissionHead;
+  unsigned *submissionTail;
+  unsigned submissionMask;
+  unsigned *submissionArray;
+  struct io_uring_sqe *submissionEntries;
+  unsigned submissionEntryCount;
+  // The number of queued entries not yet passed to the kernel
+  unsigned pendingSubmissions;
+
+  // The completion queue, shared with the kernel
+  unsigned *completionHead;
+  unsigned *completionTail;
+  unsigned completionMask;
+  struct io_uring_cqe *completionEntries;
+
+  // The mapped memory of the rings (the completion ring is the submission ring if mapped once)
+  void *submissionRing;
+  size_t submissionRingSize;
+  void *completionRing;
+  size_t completionRingSize;
+  size_t submissionEntriesSize;
+} uring_t;
+
+// Create a ring with room for at least entries submissions. Returns 0 if io_uring is not supported by the system
+// (or disabled, such as by seccomp) or lacks the features used
+uring_t *uring_create(unsigned entries);
+// Queue an accept of connections on a listening socket, producing one completion per connection until it fails
+// or is cancelled (see uring_completion_t.hasMore). The sockets are accepted with flags such as SOCK_NONBLOCK.
+// Returns false if the submission queue is full
+bool uring_acceptMultishot(uring_t *ring, int socket, uint64_t userData, int flags) __attribute__((nonnull(1)));
+// Queue a wait for a socket to have any of the poll events (such as POLLIN), producing a single completion with the
+// events that occurred. Returns false if the submission queue is full (see uring_submit)
+bool uring_pollAdd(uring_t *ring, int socket, uint32_t events, uint64_t userData) __attribute__((nonnull(1)));
+// Pass the queued submissions to the kernel without waiting. Returns false if failed
+bool uring_submit(uring_t *ring) __attribute__((nonnull(1)));
+// Pass the queued submissions to the kernel and wait for at least one completion for at most timeout milliseconds.
+// Returns the number of available completions (0 if timed out or interrupted by a signal) or -1 if failed
+int uring_wait(uring_t *ring, int timeout) __attribute__((nonnull(1)));
+// Take the next completion. Returns false if there is none
+bool uring_getCompletion(uring_t *ring, uring_completion_t *completion) __attribute__((nonnull(1, 2)));
+// Close the ring, cancelling any queued operations
+void uring_free(uring_t *ring) __attribute__((nonnull(1)));
+
+#endif
@@ -2,12 +2,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../datastructures/arena/arena.h"
 #include "../logging/logging.h"
 
 #include "url.h"
 
 url_t *url_create() {
-  url_t *url = malloc(sizeof(url_t));
+  url_t *url = arena_malloc(sizeof(url_t));
   if (url == 0)
     return 0;
 
@@ -15,7 +16,7 @@ url_t *url_create() {
 
   url->parameters = hash_table_create();
   if (url->parameters == 0) {
-    free(url);
+    arena_release(url);
     return 0;
   }
 
@@ -179,5 +180,5 @@ void url_free(url_t *url) {
     string_free(value);
   }
   hash_table_free(url->parameters);
-  free(url);
+  arena_release(url);
 }
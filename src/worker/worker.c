@@ -2,22 +2,44 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "../compression/compression.h"
 #include "../config/config.h"
+#include "../datastructures/arena/arena.h"
+#include "../file-cache/file-cache.h"
+#include "../format/format.h"
 #include "../http/http.h"
 #include "../logging/logging.h"
 #include "../path/path.h"
+#include "../resources/mime.h"
 #include "../resources/resources.h"
 #include "../string/string.h"
+#include "../time/time.h"
 #include "../www/www.h"
 
 #include "worker.h"
 
+// Pushed onto the queue by worker_retire. Only the address is used
+static char worker_retireMessage = 0;
+// Sent as is to connections turned away (see worker_shedConnection)
+#define WORKER_STRINGIFY(value) #value
+#define WORKER_STRINGIFY_VALUE(value) WORKER_STRINGIFY(value)
+static const char worker_serviceUnavailable[] = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: " WORKER_STRINGIFY_VALUE(WORKER_RETRY_AFTER) "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+// Sent as is to clients over their request rate (see worker_return429)
+static const char worker_tooManyRequests[] = "HTTP/1.1 429 Too Many Requests\r\nRetry-After: " WORKER_STRINGIFY_VALUE(WORKER_RATE_LIMIT_RETRY_AFTER) "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+// The number of connections answered with 503 by reason, shared by all threads
+static size_t worker_shedConnections[WORKER_SHED_REASONS];
+// The number of CGI requests being handled by this process (see config_getMaxCGIRequests)
+static size_t worker_cgiRequests = 0;
+
 // Private methods
 // The main entry point of a worker
 void *worker_entryPoint(worker_t *worker);
+// Handle the worker's connection using the worker's arena and the current config
+int worker_runConnection(worker_t *worker);
 // The function will own the connection
 int worker_handleConnection(worker_t *worker, connection_t *connection);
 hash_table_t *worker_createEnvironment(const connection_t *connection, const http_t *request, const string_t *rootDirectory, const string_t *resolvedPath);
@@ -26,10 +48,46 @@ size_t worker_return404(const connection_t *connection, const http_t *request, c
 size_t worker_return400(const connection_t *connection, const http_t *request, const string_t *path, string_t *description);
 size_t worker_return417(const connection_t *connection, const http_t *request, const string_t *path);
 size_t worker_return413(const connection_t *connection, const http_t *request, const string_t *path);
-size_t worker_return200(const connection_t *connection, const http_t *request, const string_t *resolvedPath);
-size_t worker_returnCGI(worker_t *worker, const connection_t *connection, const http_t *request, const string_t *resolvedPath, const string_t *rootDirectory, const string_t *body);
-
-worker_t *worker_spawn(int id, connection_t *connection, message_queue_t *queue) {
+size_t worker_return414(const connection_t *connection, const http_t *request);
+size_t worker_return431(const connection_t *connection, const http_t *request);
+// Answer a client over its request rate with a pre-serialised 429 and Retry-After
+size_t worker_return429(const connection_t *connection, const http_t *request);
+// Send an error page, which is 0 for HEAD requests. The page is owned
+size_t worker_returnPage(const connection_t *connection, const http_t *request, const string_t *path, uint16_t code, page_t *page);
+// The file entry must be an open regular file
+size_t worker_return200(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, file_cache_entry_t *fileEntry);
+// Serve a static file as is, or the requested ranges of it
+size_t worker_returnFile(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, file_cache_entry_t *fileEntry, const struct stat *info, const char *contentType, const char *contentEncoding);
+// Serve a static file compressed on the fly. Returns false if the file could not be compressed
+bool worker_returnCompressedFile(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, size_t *bytesWritten);
+size_t worker_return206(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, file_cache_entry_t *fileEntry, const struct stat *info, const char *contentEncoding, const http_range_t *ranges, size_t rangeCount);
+// Write a part of an open file, reading the next window ahead on the I/O pool while the current one is sent
+size_t worker_writeFile(const connection_t *connection, file_cache_entry_t *fileEntry, off_t offset, size_t length);
+// Serve a copy of a static file compressed on the fly (see compression_getGzip). The entry is 0 for HEAD requests
+// when the copy is not cached, in which case the length is not known
+size_t worker_returnCompressed(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, const compression_entry_t *entry);
+size_t worker_return304(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, const char *contentEncoding);
+size_t worker_return416(const connection_t *connection, const http_t *request, const struct stat *info);
+// Get the MIME type of a static file, defaulting to text/plain
+const char *worker_getContentType(const string_t *resolvedPath);
+// Format a Content-Range value such as "bytes 0-99/1000". Returns the length
+size_t worker_formatContentRange(char *buffer, const http_range_t *range, uint64_t size);
+// Whether or not the validator of If-Range (if any) matches the file, meaning that ranges may be served
+bool worker_isRangeFresh(const http_t *request, const struct stat *info, const char *contentEncoding);
+// Format the entity tag of a file from its inode, size and modification time, suffixed by the content coding if any. Returns the length
+size_t worker_formatETag(char *buffer, const struct stat *info, const char *contentEncoding);
+// Whether or not the conditional headers of a request (If-None-Match, If-Modified-Since) are fulfilled by the file
+bool worker_isNotModified(const http_t *request, const struct stat *info, const char *contentEncoding);
+// Set the ETag, Last-Modified, Cache-Control and Vary headers of a static file
+void worker_setCacheHeaders(http_t *response, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, const char *contentEncoding);
+// Find a precompressed copy of a static file (.br or .gz) accepted by the client and at least as new as the file.
+// Returns the file cache entry of the copy (to be released), setting the content coding, or 0 if there is none
+file_cache_entry_t *worker_findPrecompressedFile(const string_t *resolvedPath, const struct stat *info, uint8_t encodings, const char **contentEncoding);
+size_t worker_returnCGI(worker_t *worker, connection_t *connection, const http_t *request, const string_t *resolvedPath, const string_t *rootDirectory, const string_t *body);
+// Run a CGI script unless the process already handles the maximum number of CGI requests, in which case 503 is returned
+size_t worker_returnLimitedCGI(worker_t *worker, connection_t *connection, const http_t *request, const string_t *resolvedPath, const string_t *rootDirectory, const string_t *body);
+
+worker_t *worker_spawn(int id, connection_t *connection, work_queue_t *queue, size_t queueIndex) {
   worker_t *worker = malloc(sizeof(worker_t));
   if (worker == 0)
     return 0;
@@ -38,12 +96,32 @@ worker_t *worker_spawn(int id, connection_t *connection, message_queue_t *queue)
   worker->id = id;
   worker->connection = connection;
   worker->queue = queue;
+  worker->queueIndex = queueIndex;
   worker->shouldRun = true;
 
-  pthread_t thread;
+  worker->arena = arena_create(WORKER_ARENA_BLOCK_SIZE);
+  if (worker->arena == 0) {
+    free(worker);
+    return 0;
+  }
+
+  // Leave the close, reload and drain signals to the server's main thread. The thread inherits the mask, so it's blocked
+  // before the thread is created in order for no signal to be delivered to it before it could block them itself
+  sigset_t signals;
+  sigset_t previousSignals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigaddset(&signals, SIGHUP);
+  sigaddset(&signals, SIGUSR2);
+  pthread_sigmask(SIG_BLOCK, &signals, &previousSignals);
 
-  if (pthread_create(&thread, NULL, (void *(*)(void *))worker_entryPoint, worker) != 0) {
+  pthread_t thread;
+  int created = pthread_create(&thread, NULL, (void *(*)(void *))worker_entryPoint, worker);
+  pthread_sigmask(SIG_SETMASK, &previousSignals, 0);
+  if (created != 0) {
     log(LOG_ERROR, "Unable to start thread for worker");
+    arena_free(worker->arena);
     free(worker);
     return 0;
   }
@@ -71,7 +149,7 @@ void *worker_entryPoint(worker_t *worker) {
   if (worker->connection != 0) {
     log(LOG_DEBUG, "Handling a connection in immediate mode");
     worker->status = WORKER_STATUS_WORKING;
-    int exitCode = worker_handleConnection(worker, worker->connection);
+    int exitCode = worker_runConnection(worker);
     log(LOG_DEBUG, "Connection handling exited with code %d", exitCode);
     if (exitCode != 0)
       log(LOG_ERROR, "Handling the connection resulted in a non-zero exit code: %d", exitCode);
@@ -81,6 +159,7 @@ void *worker_entryPoint(worker_t *worker) {
   }
 
   log(LOG_DEBUG, "Initializing worker");
+  work_queue_open(worker->queue, worker->queueIndex);
 
   // Run the thread continously to handle multiple connections (pool mode)
   while (true) {
@@ -88,7 +167,7 @@ void *worker_entryPoint(worker_t *worker) {
     worker->status = WORKER_STATUS_IDLE;
 
     // Lock, waiting for a connection
-    worker->connection = message_queue_pop(worker->queue);
+    worker->connection = work_queue_pop(worker->queue, worker->queueIndex);
 
     // Exit if the worker was unlocked and should no longer run
     if (!worker->shouldRun) {
@@ -96,6 +175,17 @@ void *worker_entryPoint(worker_t *worker) {
       pthread_exit(0);
     }
 
+    // Exit if the pool is shrinking (see worker_retire)
+    if (worker->connection == (connection_t *)&worker_retireMessage) {
+      log(LOG_DEBUG, "Retiring worker %d", worker->id);
+      worker->status = WORKER_STATUS_RETIRING;
+      worker->connection = 0;
+      work_queue_close(worker->queue, worker->queueIndex);
+      worker_closeGracefully(worker);
+      worker->status = WORKER_STATUS_EXITED;
+      pthread_exit(0);
+    }
+
     // Go back to sleep if the worker was unlocked without receiving a connection
     if (worker->connection == 0) {
       log(LOG_DEBUG, "Worker %d was woken up without receiving a connection, going back to sleep", worker->id);
@@ -106,7 +196,7 @@ void *worker_entryPoint(worker_t *worker) {
 
     worker->status = WORKER_STATUS_WORKING;
 
-    worker_handleConnection(worker, worker->connection);
+    worker_runConnection(worker);
     log(LOG_DEBUG, "Handled connection - closing it");
     // Free the connection as it's of no further use
     connection_free(worker->connection);
@@ -116,19 +206,75 @@ void *worker_entryPoint(worker_t *worker) {
   return 0;
 }
 
+int worker_runConnection(worker_t *worker) {
+  // Keep the config alive for the connection even if it is reloaded meanwhile
+  worker->config = config_acquireGlobalConfig();
+
+  // Connections that waited too long for a worker are turned away rather than served late. The queue deadline has usually
+  // answered them already, once cancelled it's known whether it has
+  connection_t *connection = worker->connection;
+  connection_clearDeadline(connection);
+  bool wasAnswered = connection_hasTimedOut(connection);
+  if (wasAnswered || (connection->queuedAt != 0 && time_getMilliseconds() - connection->queuedAt > config_getQueueTimeout(worker->config))) {
+    log(LOG_DEBUG, "Connection waited %llums for a worker", (unsigned long long)(time_getMilliseconds() - connection->queuedAt));
+    if (wasAnswered)
+      __atomic_add_fetch(&worker_shedConnections[WORKER_SHED_QUEUE_TIMEOUT], 1, __ATOMIC_RELAXED);
+    else
+      worker_shedConnection(connection, WORKER_SHED_QUEUE_TIMEOUT);
+    connection_linger(connection, CONNECTION_LINGER_TIMEOUT);
+    config_releaseConfig(worker->config);
+    worker->config = 0;
+    return 0;
+  }
+
+  // Parsing and response building allocate from the arena, which is released as a whole afterwards
+  arena_setCurrent(worker->arena);
+  int exitCode = worker_handleConnection(worker, connection);
+  arena_setCurrent(0);
+  log(LOG_DEBUG, "Request used %zu arena allocations (%zu bytes), %zu heap allocations and %zu new arena blocks", worker->arena->arenaAllocations, worker->arena->allocatedBytes, worker->arena->heapAllocations, worker->arena->blockAllocations);
+  arena_reset(worker->arena);
+
+  config_releaseConfig(worker->config);
+  worker->config = 0;
+
+  return exitCode;
+}
+
 int worker_handleConnection(worker_t *worker, connection_t *connection) {
   http_t *request = http_create();
   if (request == 0)
     return 1;
 
-  // Start reading the header from the client
+  // Start reading the header from the client. The deadline covers the entire header, not just a line, including the
+  // time spent waiting for it before the connection was queued (but not the time spent queued)
+  size_t headerTimeout = config_getHeaderTimeout(worker->config);
+  if (connection->acceptedAt != 0 && connection->queuedAt > connection->acceptedAt) {
+    uint64_t pendingTime = connection->queuedAt - connection->acceptedAt;
+    headerTimeout = headerTimeout > pendingTime ? headerTimeout - pendingTime : 0;
+  }
+  connection_setDeadline(connection, headerTimeout, SHUT_RD);
   string_t *currentLine = 0;
   size_t line = 0;
   size_t headerSize = 0;
   while (true) {
-    currentLine = connection_readLine(connection, REQUEST_READ_TIMEOUT, REQUEST_MAX_HEADER_SIZE - headerSize);
+    size_t maxLineSize = REQUEST_MAX_HEADER_SIZE - headerSize;
+    if (maxLineSize > REQUEST_MAX_LINE_SIZE)
+      maxLineSize = REQUEST_MAX_LINE_SIZE;
+    bool isTooLong = false;
+    currentLine = connection_readLine(connection, headerTimeout, maxLineSize, &isTooLong);
     if (currentLine != 0)
       log(LOG_DEBUG, "Got line %s", string_getBuffer(currentLine));
+    if (isTooLong || (currentLine != 0 && string_getSize(currentLine) > 0 && line > REQUEST_MAX_HEADERS)) {
+      log(LOG_DEBUG, "Got too long of a request line or header from %s", connection_getSourceAddress(connection));
+      if (line == 0)
+        worker_return414(connection, request);
+      else
+        worker_return431(connection, request);
+      if (currentLine != 0)
+        string_free(currentLine);
+      http_free(request);
+      return 0;
+    }
     // Stop if there was no line read or the line was empty (all headers were read)
     if (currentLine == 0)
       break;
@@ -181,7 +327,18 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
     return 0;
   }
 
-  config_t *config = config_getGlobalConfig();
+  // The request has been read, limit the time spent responding
+  config_t *config = worker->config;
+  connection_setDeadline(connection, config_getWriteTimeout(config), SHUT_RDWR);
+
+  // Clients over their request rate are turned away before any work is done for them
+  if (connection->client != 0 && !client_limits_consumeRequest(connection->client, config_getClientRequestRate(config), config_getClientRequestBurst(config), time_getMilliseconds())) {
+    log(LOG_DEBUG, "Turning away request as %s is over its request rate", connection_getSourceAddress(connection));
+    worker_return429(connection, request);
+    http_free(request);
+    return 0;
+  }
+
   string_t *domainName = url_getDomainName(http_getUrl(request));
   uint16_t port = url_getPort(http_getUrl(request));
 
@@ -209,9 +366,7 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
     return 0;
   }
 
-  string_t *upgradeInsecureRequestsHeaders = string_fromBuffer("Upgrade-Insecure-Requests");
-  string_t *upgradeInsecureRequests = http_getHeader(request, upgradeInsecureRequestsHeaders);
-  string_free(upgradeInsecureRequestsHeaders);
+  string_t *upgradeInsecureRequests = http_getHeaderById(request, HTTP_HEADER_UPGRADE_INSECURE_REQUESTS);
   // Handle Upgrade Insecure Requests if it is 1 and the request is not already served over HTTPS
   if (upgradeInsecureRequests != 0 && string_equalsBuffer(upgradeInsecureRequests, "1") && serverConfig->sslContext == 0) {
     http_t *response = http_create();
@@ -226,12 +381,13 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
     if (httpsConfig != 0) {
       http_setResponseCode(response, 301);
       http_setVersion(response, string_fromBuffer("1.1"));
-      http_setHeader(response, string_fromBuffer("Vary"), string_fromBuffer("Upgrade-Insecure-Requests"));
+      http_setDate(response);
+      http_setHeaderById(response, HTTP_HEADER_VARY, string_fromBuffer("Upgrade-Insecure-Requests"));
 
       url_t *url = url_copy(http_getUrl(request));
       url_setProtocol(url, string_fromBuffer("https"));
       url_setPort(url, config_getPort(httpsConfig));
-      http_setHeader(response, string_fromBuffer("Location"), url_toString(url));
+      http_setHeaderById(response, HTTP_HEADER_LOCATION, url_toString(url));
       url_free(url);
 
       string_t *responseString = http_toResponseString(response);
@@ -262,8 +418,17 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
 
   log(LOG_DEBUG, "Got request for file '%s'", string_getBuffer(resolvedPath));
 
-  bool isFile = resources_isFile(resolvedPath);
-  bool isExecutable = resources_isExecutable(resolvedPath);
+  // Served files are kept open between requests (see file_cache_open)
+  file_cache_t *fileCache = file_cache_getGlobalCache();
+  file_cache_entry_t *fileEntry = file_cache_open(fileCache, string_getBuffer(resolvedPath), string_getSize(resolvedPath));
+  if (fileEntry == 0) {
+    worker_return500(connection, request, string_fromBuffer("Unable to access requested file"));
+    http_free(request);
+    string_free(resolvedPath);
+    return 0;
+  }
+  bool isFile = file_cache_isFile(fileEntry);
+  bool isExecutable = file_cache_isExecutable(fileEntry);
 
   // If the request is to a directory that exists, try to handle directory index
   if (!isFile) {
@@ -276,11 +441,17 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
 
         // If the resolved directory index exists, handle it as a regular file
         if (indexPath != 0) {
-          if (resolvedPath != 0)
-            string_free(resolvedPath);
+          file_cache_entry_t *indexEntry = file_cache_open(fileCache, string_getBuffer(indexPath), string_getSize(indexPath));
+          if (indexEntry == 0) {
+            string_free(indexPath);
+            continue;
+          }
+          string_free(resolvedPath);
           resolvedPath = indexPath;
-          isFile = resources_isFile(resolvedPath);
-          isExecutable = resources_isExecutable(resolvedPath);
+          file_cache_release(fileEntry);
+          fileEntry = indexEntry;
+          isFile = file_cache_isFile(fileEntry);
+          isExecutable = file_cache_isExecutable(fileEntry);
           break;
         }
       }
@@ -290,15 +461,11 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
   // CGI can handle any method
   if (isFile && isExecutable) {
     // Handle expect header
-    string_t *expectHeader = string_fromBuffer("Expect");
-    string_t *expects = http_getHeader(request, expectHeader);
-    string_free(expectHeader);
+    string_t *expects = http_getHeaderById(request, HTTP_HEADER_EXPECT);
 
     // Read the body if one exists
     string_t *body = 0;
-    string_t *contentLengthHeader = string_fromBuffer("Content-Length");
-    string_t *contentLengthString = http_getHeader(request, contentLengthHeader);
-    string_free(contentLengthHeader);
+    string_t *contentLengthString = http_getHeaderById(request, HTTP_HEADER_CONTENT_LENGTH);
     if (contentLengthString != 0) {
       log(LOG_DEBUG, "Content-Length: %s", string_getBuffer(contentLengthString));
       int contentLength = atoi(string_getBuffer(contentLengthString));
@@ -314,6 +481,7 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
 
         http_free(request);
         string_free(resolvedPath);
+        file_cache_release(fileEntry);
         return 0;
       } else if (contentLength == 0) {
         log(LOG_WARNING, "Got empty body");
@@ -326,28 +494,41 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
 
         http_free(request);
         string_free(resolvedPath);
+        file_cache_release(fileEntry);
         return 0;
       } else {
-        body = connection_read(connection, REQUEST_READ_TIMEOUT, contentLength);
+        // A client sending slower than the minimum rate is given less time than the body timeout
+        size_t bodyTimeout = config_getBodyTimeout(config);
+        size_t minBodyRate = config_getMinBodyRate(config);
+        if (minBodyRate > 0) {
+          size_t rateTimeout = REQUEST_BODY_GRACE_PERIOD + (size_t)contentLength * 1000 / minBodyRate;
+          if (rateTimeout < bodyTimeout)
+            bodyTimeout = rateTimeout;
+        }
+        connection_setDeadline(connection, bodyTimeout, SHUT_RD);
+        body = connection_read(connection, bodyTimeout, contentLength);
+        // The CGI process has its own timeout
+        connection_clearDeadline(connection);
         if (body == 0) {
           log(LOG_ERROR, "Reading body timed out or failed");
           worker_return400(connection, request, path, string_fromBuffer("Request timed out"));
           http_free(request);
           string_free(resolvedPath);
+          file_cache_release(fileEntry);
           return 0;
         }
       }
     }
 
     // The file exists, is a regular file and executable - run it
-    worker_returnCGI(worker, connection, request, resolvedPath, rootDirectory, body);
+    worker_returnLimitedCGI(worker, connection, request, resolvedPath, rootDirectory, body);
     if (body != 0)
       string_free(body);
   } else {
     if (request->method == HTTP_METHOD_GET || request->method == HTTP_METHOD_HEAD) {
       if (isFile) {
         // The file exists and is a regular file, serve it
-        worker_return200(connection, request, resolvedPath);
+        worker_return200(connection, request, serverConfig, resolvedPath, fileEntry);
       } else {
         // The file exists but is not a regular file - 404 as per
         // https://en.wikipedia.org/wiki/Webserver_directory_index
@@ -361,6 +542,7 @@ int worker_handleConnection(worker_t *worker, connection_t *connection) {
 
   http_free(request);
   string_free(resolvedPath);
+  file_cache_release(fileEntry);
   return 0;
 }
 
@@ -371,8 +553,9 @@ hash_table_t *worker_createEnvironment(const connection_t *connection, const htt
 
   hash_table_setValue(environment, string_fromBuffer("HTTPS"), string_fromBuffer("off"));
   hash_table_setValue(environment, string_fromBuffer("SERVER_SOFTWARE"), string_fromBuffer("WSIC"));
-  if (connection->sourceAddress != 0)
-    hash_table_setValue(environment, string_fromBuffer("REMOTE_ADDR"), string_copy(connection->sourceAddress));
+  const char *sourceAddress = connection_getSourceAddress(connection);
+  if (sourceAddress != 0)
+    hash_table_setValue(environment, string_fromBuffer("REMOTE_ADDR"), string_fromBuffer(sourceAddress));
   hash_table_setValue(environment, string_fromBuffer("REMOTE_PORT"), string_fromInt(connection->sourcePort));
 
   uint8_t method = http_getMethod(request);
@@ -381,21 +564,15 @@ hash_table_t *worker_createEnvironment(const connection_t *connection, const htt
   else if (method == HTTP_METHOD_POST)
     hash_table_setValue(environment, string_fromBuffer("REQUEST_METHOD"), string_fromBuffer("POST"));
 
-  string_t *cookieHeader = string_fromBuffer("Cookie");
-  string_t *cookie = http_getHeader(request, cookieHeader);
-  string_free(cookieHeader);
+  string_t *cookie = http_getHeaderById(request, HTTP_HEADER_COOKIE);
   if (cookie != 0)
     hash_table_setValue(environment, string_fromBuffer("HTTP_COOKIE"), string_copy(cookie));
 
-  string_t *refererHeader = string_fromBuffer("Referer");
-  string_t *referer = http_getHeader(request, refererHeader);
-  string_free(refererHeader);
+  string_t *referer = http_getHeaderById(request, HTTP_HEADER_REFERER);
   if (referer != 0)
     hash_table_setValue(environment, string_fromBuffer("HTTP_REFERER"), string_copy(referer));
 
-  string_t *userAgentHeader = string_fromBuffer("User-Agent");
-  string_t *userAgent = http_getHeader(request, userAgentHeader);
-  string_free(userAgentHeader);
+  string_t *userAgent = http_getHeaderById(request, HTTP_HEADER_USER_AGENT);
   if (userAgent != 0)
     hash_table_setValue(environment, string_fromBuffer("HTTP_USER_AGENT"), string_copy(userAgent));
 
@@ -432,214 +609,567 @@ hash_table_t *worker_createEnvironment(const connection_t *connection, const htt
 }
 
 size_t worker_return500(const connection_t *connection, const http_t *request, string_t *description) {
-  http_t *response = http_create();
-  if (response == 0)
-    return 0;
+  // Error pages are not rendered for HEAD requests as only the headers are sent
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    page = page_create500(description);
+    if (page == 0)
+      return 0;
+  } else {
+    string_free(description);
+  }
+
+  return worker_returnPage(connection, request, url_getPath(http_getUrl(request)), 500, page);
+}
+
+size_t worker_return404(const connection_t *connection, const http_t *request, const string_t *path) {
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    // Copy the path since we want to keep ownership
+    page = page_create404(string_copy(path));
+    if (page == 0)
+      return 0;
+  }
+
+  return worker_returnPage(connection, request, path, 404, page);
+}
+
+size_t worker_return400(const connection_t *connection, const http_t *request, const string_t *path, string_t *description) {
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    page = page_create400(description);
+    if (page == 0)
+      return 0;
+  } else {
+    string_free(description);
+  }
+
+  return worker_returnPage(connection, request, path, 400, page);
+}
 
-  page_t *page = page_create500(description);
-  if (page == 0) {
-    http_free(response);
+size_t worker_return417(const connection_t *connection, const http_t *request, const string_t *path) {
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    page = page_create417();
+    if (page == 0)
+      return 0;
+  }
+
+  return worker_returnPage(connection, request, path, 417, page);
+}
+
+size_t worker_return413(const connection_t *connection, const http_t *request, const string_t *path) {
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    page = page_create413();
+    if (page == 0)
+      return 0;
+  }
+
+  return worker_returnPage(connection, request, path, 413, page);
+}
+
+size_t worker_return414(const connection_t *connection, const http_t *request) {
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    page = page_create414();
+    if (page == 0)
+      return 0;
+  }
+
+  return worker_returnPage(connection, request, 0, 414, page);
+}
+
+size_t worker_return431(const connection_t *connection, const http_t *request) {
+  page_t *page = 0;
+  if (http_getMethod(request) != HTTP_METHOD_HEAD) {
+    page = page_create431();
+    if (page == 0)
+      return 0;
+  }
+
+  return worker_returnPage(connection, request, 0, 431, page);
+}
+
+size_t worker_return429(const connection_t *connection, const http_t *request) {
+  size_t bytesWritten = connection_write(connection, worker_tooManyRequests, sizeof(worker_tooManyRequests) - 1);
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), url_getPath(http_getUrl(request)), http_getVersion(request), 429, bytesWritten);
+  return bytesWritten;
+}
+
+size_t worker_returnPage(const connection_t *connection, const http_t *request, const string_t *path, uint16_t code, page_t *page) {
+  http_t *response = http_create();
+  if (response == 0) {
+    if (page != 0)
+      page_free(page);
     return 0;
   }
 
-  string_t *source = page_getSource(page);
-  http_setBody(response, source);
-  // Remove the body if HEAD was used
-  if (http_getMethod(request) == HTTP_METHOD_HEAD)
-    response->body = 0;
-  http_setResponseCode(response, 500);
+  // Sets the Content-Length. Without a page (HEAD) it's left out, as allowed for headers only known from the body
+  if (page != 0)
+    http_setBody(response, page_getSource(page));
+  http_setResponseCode(response, code);
   http_setVersion(response, string_fromBuffer("1.1"));
-  http_setHeader(response, string_fromBuffer("Content-Type"), string_fromBuffer("text/html"));
+  http_setDate(response);
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_TYPE, string_fromBuffer("text/html"));
 
   string_t *responseString = http_toResponseString(response);
   size_t bytesWritten = connection_write(connection, string_getBuffer(responseString), string_getSize(responseString));
-  string_t *path = url_getPath(http_getUrl(request));
-  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 500, bytesWritten);
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), code, bytesWritten);
   string_free(responseString);
-  page_free(page);
-  // Freeing the page also frees the source, which we gave to http.
-  // Not having this line would cause a double free
-  response->body = 0;
+  if (page != 0) {
+    page_free(page);
+    // Freeing the page also frees the source, which we gave to http.
+    // Not having this line would cause a double free
+    response->body = 0;
+  }
   http_free(response);
 
   return bytesWritten;
 }
 
-size_t worker_return404(const connection_t *connection, const http_t *request, const string_t *path) {
-  http_t *response = http_create();
-  if (response == 0)
-    return 0;
+size_t worker_return200(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, file_cache_entry_t *fileEntry) {
+  // Negotiate the content coding of text-based files: a precompressed copy is preferred over compressing on the fly
+  const char *contentType = worker_getContentType(resolvedPath);
+  const char *contentEncoding = 0;
+  file_cache_entry_t *precompressedEntry = 0;
+  bool shouldCompress = false;
+  if (mime_isCompressible(contentType)) {
+    string_t *acceptEncoding = http_getHeaderById(request, HTTP_HEADER_ACCEPT_ENCODING);
+    uint8_t encodings = acceptEncoding == 0 ? 0 : http_parseAcceptEncoding(string_getView(acceptEncoding));
+    if (encodings != 0)
+      precompressedEntry = worker_findPrecompressedFile(resolvedPath, &fileEntry->info, encodings, &contentEncoding);
+    if (precompressedEntry == 0 && (encodings & HTTP_ENCODING_GZIP) && config_getCompress(serverConfig) == 1 && fileEntry->info.st_size >= COMPRESSION_MIN_FILE_SIZE && fileEntry->info.st_size <= COMPRESSION_MAX_FILE_SIZE) {
+      contentEncoding = "gzip";
+      shouldCompress = true;
+    }
+  }
 
-  // Copy the path since we want to keep ownership
-  page_t *page = page_create404(string_copy(path));
-  if (page == 0) {
-    http_free(response);
-    return 0;
+  // The file is already open and its status known (see file_cache_open)
+  file_cache_entry_t *servedEntry = precompressedEntry != 0 ? precompressedEntry : fileEntry;
+  const struct stat *info = &servedEntry->info;
+
+  // Answer conditional requests from the status of the file alone, without compressing it.
+  // Files that could not be compressed are served as is
+  size_t bytesWritten = 0;
+  if (worker_isNotModified(request, info, contentEncoding))
+    bytesWritten = worker_return304(connection, request, serverConfig, resolvedPath, info, contentEncoding);
+  else if (!shouldCompress || !worker_returnCompressedFile(connection, request, serverConfig, resolvedPath, info, &bytesWritten))
+    bytesWritten = worker_returnFile(connection, request, serverConfig, resolvedPath, servedEntry, info, contentType, shouldCompress ? 0 : contentEncoding);
+
+  if (precompressedEntry != 0)
+    file_cache_release(precompressedEntry);
+  return bytesWritten;
+}
+
+bool worker_returnCompressedFile(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, size_t *bytesWritten) {
+  // HEAD requests use a cached copy if there is one, but never compress the file just to learn the length
+  bool isHead = http_getMethod(request) == HTTP_METHOD_HEAD;
+  compression_cache_t *cache = compression_getGlobalCache();
+  compression_entry_t *entry = isHead ? compression_getCachedGzip(cache, info) : compression_getGzip(cache, string_getBuffer(resolvedPath), info);
+  if (entry == 0 && !isHead)
+    return false;
+
+  *bytesWritten = worker_returnCompressed(connection, request, serverConfig, resolvedPath, info, entry);
+  if (entry != 0)
+    compression_releaseEntry(entry);
+  return true;
+}
+
+size_t worker_returnFile(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, file_cache_entry_t *fileEntry, const struct stat *info, const char *contentType, const char *contentEncoding) {
+  // Serve only the requested ranges unless the file has changed since the client's copy (If-Range)
+  string_t *range = http_getHeaderById(request, HTTP_HEADER_RANGE);
+  if (range != 0 && worker_isRangeFresh(request, info, contentEncoding)) {
+    http_range_t ranges[HTTP_MAX_RANGES];
+    ssize_t rangeCount = http_parseRange(string_getView(range), (uint64_t)info->st_size, ranges, HTTP_MAX_RANGES);
+    if (rangeCount == 0)
+      return worker_return416(connection, request, info);
+    else if (rangeCount > 0)
+      return worker_return206(connection, request, serverConfig, resolvedPath, fileEntry, info, contentEncoding, ranges, rangeCount);
   }
 
-  string_t *source = page_getSource(page);
-  http_setBody(response, source);
-  // Remove the body if HEAD was used
-  if (http_getMethod(request) == HTTP_METHOD_HEAD)
-    response->body = 0;
-  http_setResponseCode(response, 404);
+  http_t *response = http_create();
+  if (response == 0)
+    return 0;
+  http_setResponseCode(response, 200);
   http_setVersion(response, string_fromBuffer("1.1"));
-  http_setHeader(response, string_fromBuffer("Content-Type"), string_fromBuffer("text/html"));
+  http_setDate(response);
+
+  char contentLength[FORMAT_INTEGER_LENGTH];
+  size_t contentLengthLength = format_unsignedInteger(contentLength, (uint64_t)info->st_size);
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_LENGTH, string_fromBufferWithLength(contentLength, contentLengthLength));
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_TYPE, string_fromBuffer(contentType));
+  if (contentEncoding != 0)
+    http_setHeaderById(response, HTTP_HEADER_CONTENT_ENCODING, string_fromBuffer(contentEncoding));
+  http_setHeaderById(response, HTTP_HEADER_ACCEPT_RANGES, string_fromBuffer("bytes"));
+  worker_setCacheHeaders(response, serverConfig, resolvedPath, info, contentEncoding);
 
   string_t *responseString = http_toResponseString(response);
   size_t bytesWritten = connection_write(connection, string_getBuffer(responseString), string_getSize(responseString));
-  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 404, bytesWritten);
+  // Only write the body if HEAD was not used. The body is written straight from the file
+  // (see connection_writeFile) so that sendfile and kernel TLS can be used
+  if (bytesWritten > 0 && http_getMethod(request) != HTTP_METHOD_HEAD)
+    bytesWritten += worker_writeFile(connection, fileEntry, 0, info->st_size);
+
+  string_t *path = url_getPath(http_getUrl(request));
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 200, bytesWritten);
   string_free(responseString);
-  page_free(page);
-  // Freeing the page also frees the source, which we gave to http.
-  // Not having this line would cause a double free
-  response->body = 0;
   http_free(response);
 
   return bytesWritten;
 }
 
-size_t worker_return400(const connection_t *connection, const http_t *request, const string_t *path, string_t *description) {
+size_t worker_return206(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, file_cache_entry_t *fileEntry, const struct stat *info, const char *contentEncoding, const http_range_t *ranges, size_t rangeCount) {
   http_t *response = http_create();
   if (response == 0)
     return 0;
-
-  page_t *page = page_create400(description);
-  if (page == 0) {
-    http_free(response);
-    return 0;
+  http_setResponseCode(response, 206);
+  http_setVersion(response, string_fromBuffer("1.1"));
+  http_setDate(response);
+  http_setHeaderById(response, HTTP_HEADER_ACCEPT_RANGES, string_fromBuffer("bytes"));
+  // The ranges are of the encoded representation
+  if (contentEncoding != 0)
+    http_setHeaderById(response, HTTP_HEADER_CONTENT_ENCODING, string_fromBuffer(contentEncoding));
+  worker_setCacheHeaders(response, serverConfig, resolvedPath, info, contentEncoding);
+
+  const char *contentType = worker_getContentType(resolvedPath);
+  char contentRange[WORKER_CONTENT_RANGE_LENGTH];
+  uint64_t contentLength = 0;
+
+  // Multiple ranges are sent as the parts of a multipart/byteranges body, each with headers of its own
+  string_t *partHeaders[HTTP_MAX_RANGES] = {0};
+  char boundary[FORMAT_INTEGER_LENGTH];
+  size_t boundaryLength = format_hexadecimal(boundary, (uint64_t)info->st_ino ^ (uint64_t)info->st_mtime ^ ((uint64_t)time(NULL) << 20));
+  if (rangeCount == 1) {
+    size_t contentRangeLength = worker_formatContentRange(contentRange, &ranges[0], info->st_size);
+    http_setHeaderById(response, HTTP_HEADER_CONTENT_RANGE, string_fromBufferWithLength(contentRange, contentRangeLength));
+    http_setHeaderById(response, HTTP_HEADER_CONTENT_TYPE, string_fromBuffer(contentType));
+    contentLength = ranges[0].length;
+  } else {
+    string_t *multipartType = string_fromBuffer("multipart/byteranges; boundary=");
+    string_appendBufferWithLength(multipartType, boundary, boundaryLength);
+    http_setHeaderById(response, HTTP_HEADER_CONTENT_TYPE, multipartType);
+
+    for (size_t i = 0; i < rangeCount; i++) {
+      partHeaders[i] = string_fromBuffer("\r\n--");
+      string_appendBufferWithLength(partHeaders[i], boundary, boundaryLength);
+      string_appendBuffer(partHeaders[i], "\r\nContent-Type: ");
+      string_appendBuffer(partHeaders[i], contentType);
+      string_appendBuffer(partHeaders[i], "\r\nContent-Range: ");
+      size_t contentRangeLength = worker_formatContentRange(contentRange, &ranges[i], info->st_size);
+      string_appendBufferWithLength(partHeaders[i], contentRange, contentRangeLength);
+      string_appendBuffer(partHeaders[i], "\r\n\r\n");
+      contentLength += string_getSize(partHeaders[i]) + ranges[i].length;
+    }
+    // The closing "\r\n--boundary--\r\n"
+    contentLength += boundaryLength + 8;
   }
 
-  string_t *source = page_getSource(page);
-  http_setBody(response, source);
-  // Remove the body if HEAD was used
-  if (http_getMethod(request) == HTTP_METHOD_HEAD)
-    response->body = 0;
-  http_setResponseCode(response, 400);
-  http_setVersion(response, string_fromBuffer("1.1"));
-  http_setHeader(response, string_fromBuffer("Content-Type"), string_fromBuffer("text/html"));
+  char contentLengthBuffer[FORMAT_INTEGER_LENGTH];
+  size_t contentLengthLength = format_unsignedInteger(contentLengthBuffer, contentLength);
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_LENGTH, string_fromBufferWithLength(contentLengthBuffer, contentLengthLength));
 
   string_t *responseString = http_toResponseString(response);
   size_t bytesWritten = connection_write(connection, string_getBuffer(responseString), string_getSize(responseString));
-  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 400, bytesWritten);
+  // Only write the body if HEAD was not used
+  if (bytesWritten > 0 && http_getMethod(request) != HTTP_METHOD_HEAD) {
+    if (rangeCount == 1) {
+      bytesWritten += worker_writeFile(connection, fileEntry, ranges[0].offset, ranges[0].length);
+    } else {
+      for (size_t i = 0; i < rangeCount; i++) {
+        bytesWritten += connection_write(connection, string_getBuffer(partHeaders[i]), string_getSize(partHeaders[i]));
+        bytesWritten += worker_writeFile(connection, fileEntry, ranges[i].offset, ranges[i].length);
+      }
+      string_t *closingBoundary = string_fromBuffer("\r\n--");
+      string_appendBufferWithLength(closingBoundary, boundary, boundaryLength);
+      string_appendBuffer(closingBoundary, "--\r\n");
+      bytesWritten += connection_write(connection, string_getBuffer(closingBoundary), string_getSize(closingBoundary));
+      string_free(closingBoundary);
+    }
+  }
+
+  for (size_t i = 0; i < rangeCount; i++) {
+    if (partHeaders[i] != 0)
+      string_free(partHeaders[i]);
+  }
+
+  string_t *path = url_getPath(http_getUrl(request));
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 206, bytesWritten);
   string_free(responseString);
-  page_free(page);
-  // Freeing the page also frees the source, which we gave to http.
-  // Not having this line would cause a double free
-  response->body = 0;
   http_free(response);
 
   return bytesWritten;
 }
 
-size_t worker_return417(const connection_t *connection, const http_t *request, const string_t *path) {
+size_t worker_writeFile(const connection_t *connection, file_cache_entry_t *fileEntry, off_t offset, size_t length) {
+  // Small files are read by the kernel as they are sent
+  if (length <= FILE_CACHE_READ_AHEAD_SIZE)
+    return connection_writeFile(connection, fileEntry->file, offset, length);
+
+  file_cache_t *fileCache = file_cache_getGlobalCache();
+  size_t bytesWritten = 0;
+  while (bytesWritten < length) {
+    size_t windowLength = length - bytesWritten < FILE_CACHE_READ_AHEAD_SIZE ? length - bytesWritten : FILE_CACHE_READ_AHEAD_SIZE;
+    off_t nextOffset = offset + bytesWritten + windowLength;
+    if (fileCache != 0 && bytesWritten + windowLength < length)
+      file_cache_readAhead(fileCache, fileEntry, nextOffset, FILE_CACHE_READ_AHEAD_SIZE);
+
+    size_t windowWritten = connection_writeFile(connection, fileEntry->file, offset + bytesWritten, windowLength);
+    bytesWritten += windowWritten;
+    // The connection failed
+    if (windowWritten < windowLength)
+      break;
+  }
+
+  return bytesWritten;
+}
+
+size_t worker_returnCompressed(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, const compression_entry_t *entry) {
   http_t *response = http_create();
   if (response == 0)
     return 0;
+  http_setResponseCode(response, 200);
+  http_setVersion(response, string_fromBuffer("1.1"));
+  http_setDate(response);
 
-  // Copy the path since we want to keep ownership
-  page_t *page = page_create417();
-  if (page == 0) {
-    http_free(response);
-    return 0;
+  // Ranges are not served of copies compressed on the fly, so Accept-Ranges is left out
+  if (entry != 0) {
+    char contentLength[FORMAT_INTEGER_LENGTH];
+    size_t contentLengthLength = format_unsignedInteger(contentLength, (uint64_t)entry->length);
+    http_setHeaderById(response, HTTP_HEADER_CONTENT_LENGTH, string_fromBufferWithLength(contentLength, contentLengthLength));
   }
-
-  string_t *source = page_getSource(page);
-  http_setBody(response, source);
-  // Remove the body if HEAD was used
-  if (http_getMethod(request) == HTTP_METHOD_HEAD)
-    response->body = 0;
-  http_setResponseCode(response, 417);
-  http_setVersion(response, string_fromBuffer("1.1"));
-  http_setHeader(response, string_fromBuffer("Content-Type"), string_fromBuffer("text/html"));
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_TYPE, string_fromBuffer(worker_getContentType(resolvedPath)));
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_ENCODING, string_fromBuffer("gzip"));
+  worker_setCacheHeaders(response, serverConfig, resolvedPath, info, "gzip");
 
   string_t *responseString = http_toResponseString(response);
   size_t bytesWritten = connection_write(connection, string_getBuffer(responseString), string_getSize(responseString));
-  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 417, bytesWritten);
+  // Only write the body if HEAD was not used
+  if (bytesWritten > 0 && entry != 0 && http_getMethod(request) != HTTP_METHOD_HEAD)
+    bytesWritten += connection_write(connection, entry->data, entry->length);
+
+  string_t *path = url_getPath(http_getUrl(request));
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 200, bytesWritten);
   string_free(responseString);
-  page_free(page);
-  // Freeing the page also frees the source, which we gave to http.
-  // Not having this line would cause a double free
-  response->body = 0;
   http_free(response);
 
   return bytesWritten;
 }
 
-size_t worker_return413(const connection_t *connection, const http_t *request, const string_t *path) {
+size_t worker_return304(const connection_t *connection, const http_t *request, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, const char *contentEncoding) {
   http_t *response = http_create();
   if (response == 0)
     return 0;
-
-  // Copy the path since we want to keep ownership
-  page_t *page = page_create413();
-  if (page == 0) {
-    http_free(response);
-    return 0;
-  }
-
-  string_t *source = page_getSource(page);
-  http_setBody(response, source);
-  // Remove the body if HEAD was used
-  if (http_getMethod(request) == HTTP_METHOD_HEAD)
-    response->body = 0;
-  http_setResponseCode(response, 413);
+  http_setResponseCode(response, 304);
   http_setVersion(response, string_fromBuffer("1.1"));
-  http_setHeader(response, string_fromBuffer("Content-Type"), string_fromBuffer("text/html"));
+  http_setDate(response);
+  worker_setCacheHeaders(response, serverConfig, resolvedPath, info, contentEncoding);
 
   string_t *responseString = http_toResponseString(response);
   size_t bytesWritten = connection_write(connection, string_getBuffer(responseString), string_getSize(responseString));
-  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 413, bytesWritten);
+
+  string_t *path = url_getPath(http_getUrl(request));
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 304, bytesWritten);
   string_free(responseString);
-  page_free(page);
-  // Freeing the page also frees the source, which we gave to http.
-  // Not having this line would cause a double free
-  response->body = 0;
   http_free(response);
 
   return bytesWritten;
 }
 
-size_t worker_return200(const connection_t *connection, const http_t *request, const string_t *resolvedPath) {
+size_t worker_return416(const connection_t *connection, const http_t *request, const struct stat *info) {
   http_t *response = http_create();
   if (response == 0)
     return 0;
-  http_setResponseCode(response, 200);
+  http_setResponseCode(response, 416);
   http_setVersion(response, string_fromBuffer("1.1"));
+  http_setDate(response);
 
-  string_t *fileContent = resources_loadFile(resolvedPath);
-  if (fileContent == 0) {
-    log(LOG_ERROR, "Could not read file '%s'", string_getBuffer(resolvedPath));
-    http_free(response);
-    worker_return500(connection, request, string_fromBuffer("Unable to access requested file"));
-    return 0;
-  }
-
-  http_setBody(response, fileContent);
-  string_t *mimeType = resources_getMIMEType(resolvedPath);
-  if (mimeType != 0)
-    log(LOG_DEBUG, "MIME type of '%s' is '%s'", string_getBuffer(resolvedPath), string_getBuffer(mimeType));
-  // Default to text/plain if no type was found
-  if (mimeType == 0)
-    mimeType = string_fromBuffer("text/plain");
-  http_setHeader(response, string_fromBuffer("Content-Type"), mimeType);
-  // Remove the body if HEAD was used
-  if (http_getMethod(request) == HTTP_METHOD_HEAD) {
-    string_free(response->body);
-    response->body = 0;
-  }
+  // The range is given as "bytes */size" to let the client know what it may request
+  string_t *contentRange = string_fromBuffer("bytes */");
+  char size[FORMAT_INTEGER_LENGTH];
+  size_t sizeLength = format_unsignedInteger(size, (uint64_t)info->st_size);
+  string_appendBufferWithLength(contentRange, size, sizeLength);
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_RANGE, contentRange);
+  http_setHeaderById(response, HTTP_HEADER_CONTENT_LENGTH, string_fromBuffer("0"));
 
   string_t *responseString = http_toResponseString(response);
   size_t bytesWritten = connection_write(connection, string_getBuffer(responseString), string_getSize(responseString));
+
   string_t *path = url_getPath(http_getUrl(request));
-  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 200, bytesWritten);
+  logging_request(connection_getSourceAddress(connection), http_getMethod(request), path, http_getVersion(request), 416, bytesWritten);
   string_free(responseString);
   http_free(response);
 
   return bytesWritten;
 }
 
-size_t worker_returnCGI(worker_t *worker, const connection_t *connection, const http_t *request, const string_t *resolvedPath, const string_t *rootDirectory, const string_t *body) {
+const char *worker_getContentType(const string_t *resolvedPath) {
+  const char *mimeType = resources_getMIMEType(resolvedPath);
+  if (mimeType != 0)
+    log(LOG_DEBUG, "MIME type of '%s' is '%s'", string_getBuffer(resolvedPath), mimeType);
+  // Default to text/plain if no type was found
+  if (mimeType == 0)
+    mimeType = "text/plain";
+  return mimeType;
+}
+
+size_t worker_formatContentRange(char *buffer, const http_range_t *range, uint64_t size) {
+  // bytes first-last/size
+  memcpy(buffer, "bytes ", 6);
+  size_t length = 6;
+  length += format_unsignedInteger(buffer + length, range->offset);
+  buffer[length++] = '-';
+  length += format_unsignedInteger(buffer + length, range->offset + range->length - 1);
+  buffer[length++] = '/';
+  length += format_unsignedInteger(buffer + length, size);
+  return length;
+}
+
+bool worker_isRangeFresh(const http_t *request, const struct stat *info, const char *contentEncoding) {
+  string_t *ifRange = http_getHeaderById(request, HTTP_HEADER_IF_RANGE);
+  if (ifRange == 0)
+    return true;
+
+  // Either an entity tag, which must match strongly, or the date the file was last modified
+  if (string_getSize(ifRange) > 0 && string_getBuffer(ifRange)[0] == '"') {
+    char eTag[WORKER_ETAG_LENGTH];
+    worker_formatETag(eTag, info, contentEncoding);
+    return string_equalsBuffer(ifRange, eTag);
+  }
+
+  time_t lastModified;
+  if (!format_parseHTTPDate(string_getBuffer(ifRange), string_getSize(ifRange), &lastModified))
+    return false;
+  return lastModified == info->st_mtime;
+}
+
+size_t worker_formatETag(char *buffer, const struct stat *info, const char *contentEncoding) {
+  // "inode-size-modification time" in hexadecimal, with "-coding" for encoded representations
+  size_t length = 0;
+  buffer[length++] = '"';
+  length += format_hexadecimal(buffer + length, (uint64_t)info->st_ino);
+  buffer[length++] = '-';
+  length += format_hexadecimal(buffer + length, (uint64_t)info->st_size);
+  buffer[length++] = '-';
+  length += format_hexadecimal(buffer + length, (uint64_t)info->st_mtime);
+  if (contentEncoding != 0) {
+    size_t contentEncodingLength = strlen(contentEncoding);
+    buffer[length++] = '-';
+    memcpy(buffer + length, contentEncoding, contentEncodingLength);
+    length += contentEncodingLength;
+  }
+  buffer[length++] = '"';
+  buffer[length] = 0;
+  return length;
+}
+
+bool worker_isNotModified(const http_t *request, const struct stat *info, const char *contentEncoding) {
+  // If-None-Match takes precedence over If-Modified-Since (RFC 7232 section 6)
+  string_t *ifNoneMatch = http_getHeaderById(request, HTTP_HEADER_IF_NONE_MATCH);
+  if (ifNoneMatch != 0) {
+    char eTag[WORKER_ETAG_LENGTH];
+    size_t eTagLength = worker_formatETag(eTag, info, contentEncoding);
+
+    // A list of tags such as "a", W/"b" - compared weakly
+    string_view_t tags = string_getView(ifNoneMatch);
+    size_t offset = 0;
+    while (offset < tags.size) {
+      ssize_t end = string_view_findChar(tags, offset, ',');
+      if (end == -1)
+        end = tags.size;
+      string_view_t tag = string_view_substring(tags, offset, end);
+      offset = end + 1;
+
+      while (tag.size > 0 && (tag.buffer[0] == ' ' || tag.buffer[0] == '\t'))
+        tag = string_view_substring(tag, 1, tag.size);
+      while (tag.size > 0 && (tag.buffer[tag.size - 1] == ' ' || tag.buffer[tag.size - 1] == '\t'))
+        tag.size--;
+      if (string_view_startsWithBuffer(tag, "W/"))
+        tag = string_view_substring(tag, 2, tag.size);
+
+      if (string_view_equalsBuffer(tag, "*") || (tag.size == eTagLength && memcmp(tag.buffer, eTag, eTagLength) == 0))
+        return true;
+    }
+
+    return false;
+  }
+
+  string_t *ifModifiedSince = http_getHeaderById(request, HTTP_HEADER_IF_MODIFIED_SINCE);
+  if (ifModifiedSince != 0) {
+    time_t since;
+    if (format_parseHTTPDate(string_getBuffer(ifModifiedSince), string_getSize(ifModifiedSince), &since))
+      return info->st_mtime <= since;
+  }
+
+  return false;
+}
+
+void worker_setCacheHeaders(http_t *response, const server_config_t *serverConfig, const string_t *resolvedPath, const struct stat *info, const char *contentEncoding) {
+  char eTag[WORKER_ETAG_LENGTH];
+  size_t eTagLength = worker_formatETag(eTag, info, contentEncoding);
+  http_setHeaderById(response, HTTP_HEADER_ETAG, string_fromBufferWithLength(eTag, eTagLength));
+
+  char lastModified[FORMAT_HTTP_DATE_LENGTH];
+  format_httpDate(lastModified, info->st_mtime);
+  http_setHeaderById(response, HTTP_HEADER_LAST_MODIFIED, string_fromBufferWithLength(lastModified, FORMAT_HTTP_DATE_LENGTH - 1));
+
+  string_t *cacheControl = config_getCacheControl(serverConfig, resources_getExtension(resolvedPath));
+  if (cacheControl != 0)
+    http_setHeaderById(response, HTTP_HEADER_CACHE_CONTROL, string_copy(cacheControl));
+
+  // The representation of text-based files depends on the codings accepted by the client
+  if (mime_isCompressible(worker_getContentType(resolvedPath)))
+    http_setHeaderById(response, HTTP_HEADER_VARY, string_fromBuffer("Accept-Encoding"));
+}
+
+file_cache_entry_t *worker_findPrecompressedFile(const string_t *resolvedPath, const struct stat *info, uint8_t encodings, const char **contentEncoding) {
+  // Brotli compresses better than gzip, so it's preferred
+  static const uint8_t precompressedEncodings[2] = {HTTP_ENCODING_BROTLI, HTTP_ENCODING_GZIP};
+  static const char *precompressedExtensions[2] = {".br", ".gz"};
+  static const char *precompressedCodings[2] = {"br", "gzip"};
+
+  for (size_t i = 0; i < 2; i++) {
+    if ((encodings & precompressedEncodings[i]) == 0)
+      continue;
+
+    // Missing copies are cached as well, so probing for them is usually free
+    string_t *path = string_copy(resolvedPath);
+    string_appendBuffer(path, precompressedExtensions[i]);
+    file_cache_entry_t *entry = file_cache_open(file_cache_getGlobalCache(), string_getBuffer(path), string_getSize(path));
+    string_free(path);
+    if (entry == 0)
+      continue;
+
+    // An outdated copy is ignored so that a changed file is never served stale
+    if (file_cache_isFile(entry) && entry->info.st_mtime >= info->st_mtime) {
+      *contentEncoding = precompressedCodings[i];
+      return entry;
+    }
+    file_cache_release(entry);
+  }
+
+  return 0;
+}
+
+size_t worker_returnLimitedCGI(worker_t *worker, connection_t *connection, const http_t *request, const string_t *resolvedPath, const string_t *rootDirectory, const string_t *body) {
+  // Keep the remaining workers available for static files when scripts are slow
+  size_t maxCGIRequests = config_getMaxCGIRequests(worker->config);
+  size_t cgiRequests = __atomic_add_fetch(&worker_cgiRequests, 1, __ATOMIC_ACQ_REL);
+  size_t bytesWritten = 0;
+  if (maxCGIRequests > 0 && cgiRequests > maxCGIRequests) {
+    log(LOG_DEBUG, "Turning away CGI request as %zu are already handled", maxCGIRequests);
+    bytesWritten = worker_shedConnection(connection, WORKER_SHED_CGI_LIMIT);
+    connection_linger(connection, CONNECTION_LINGER_TIMEOUT);
+    logging_request(connection_getSourceAddress(connection), http_getMethod(request), url_getPath(http_getUrl(request)), http_getVersion(request), 503, bytesWritten);
+  } else {
+    bytesWritten = worker_returnCGI(worker, connection, request, resolvedPath, rootDirectory, body);
+  }
+  __atomic_sub_fetch(&worker_cgiRequests, 1, __ATOMIC_ACQ_REL);
+
+  return bytesWritten;
+}
+
+size_t worker_returnCGI(worker_t *worker, connection_t *connection, const http_t *request, const string_t *resolvedPath, const string_t *rootDirectory, const string_t *body) {
   log(LOG_DEBUG, "Spawning CGI process");
   list_t *arguments = 0;
   hash_table_t *environment = worker_createEnvironment(connection, request, rootDirectory, resolvedPath);
@@ -666,7 +1196,8 @@ size_t worker_returnCGI(worker_t *worker, const connection_t *connection, const
   }
 
   log(LOG_DEBUG, "Reading response from CGI process");
-  string_t *response = cgi_read(worker->cgi, CGI_READ_TIMEOUT);
+  string_t *response = cgi_read(worker->cgi, config_getCGITimeout(worker->config));
+  connection_setDeadline(connection, config_getWriteTimeout(worker->config), SHUT_RDWR);
   if (response == 0 || response->buffer == 0) {
     log(LOG_ERROR, "Unable to read bytes from CGI process");
     cgi_freeProcess(worker->cgi);
@@ -707,11 +1238,46 @@ void worker_closeGracefully(worker_t *worker) {
   worker->shouldRun = false;
 }
 
+size_t worker_shedConnection(const connection_t *connection, enum workerShedReason reason) {
+  __atomic_add_fetch(&worker_shedConnections[reason], 1, __ATOMIC_RELAXED);
+  size_t bytesWritten = connection_write(connection, worker_serviceUnavailable, sizeof(worker_serviceUnavailable) - 1);
+  shutdown(connection_getSocket(connection), SHUT_WR);
+  return bytesWritten;
+}
+
+void worker_setQueueDeadline(connection_t *connection, uint64_t timeout) {
+  connection_setDeadlineResponse(connection, timeout, worker_serviceUnavailable, sizeof(worker_serviceUnavailable) - 1);
+}
+
+size_t worker_getShedConnections(enum workerShedReason reason) {
+  return __atomic_load_n(&worker_shedConnections[reason], __ATOMIC_RELAXED);
+}
+
+void worker_retire(work_queue_t *queue) {
+  work_queue_push(queue, &worker_retireMessage, 0);
+}
+
+size_t worker_freeQueuedConnections(work_queue_t *queue) {
+  size_t freedConnections = 0;
+  void *value = 0;
+  while ((value = work_queue_takeAny(queue)) != 0) {
+    // Messages to retire that no worker took are left as well
+    if (value == &worker_retireMessage)
+      continue;
+
+    connection_free((connection_t *)value);
+    freedConnections++;
+  }
+
+  return freedConnections;
+}
+
 void worker_free(worker_t *worker) {
   if (worker->connection != 0)
     connection_free(worker->connection);
   if (worker->cgi != 0)
     cgi_freeProcess(worker->cgi);
+  arena_free(worker->arena);
   // Free the worker itself
   free(worker);
 }
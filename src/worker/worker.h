@@ -6,9 +6,11 @@
 #include <stdint.h>
 #include <pthread.h>
 
-#include "../datastructures/message-queue/message-queue.h"
+#include "../datastructures/work-queue/work-queue.h"
 #include "../connection/connection.h"
 #include "../cgi/cgi.h"
+#include "../config/config.h"
+#include "../datastructures/arena/arena.h"
 
 // Before a worker has started, it is initializing (right after fork)
 #define WORKER_STATUS_INITIALIZING 0
@@ -16,16 +18,36 @@
 #define WORKER_STATUS_IDLE 1
 // When the worker is handling a connection, it is working
 #define WORKER_STATUS_WORKING 2
+// When the worker has retired (see worker_retire), it has exited and can be joined
+#define WORKER_STATUS_EXITED 3
+// When the worker has taken the message to retire, it is retiring and will not take any further connections
+#define WORKER_STATUS_RETIRING 4
 
 // Don't allow headers larger than 1 MB
 #define REQUEST_MAX_HEADER_SIZE 1048576
-// Don't allow connections to wait for more than one second without sending data when reading
-#define REQUEST_READ_TIMEOUT 1000
+// Don't allow request lines or header lines longer than 8 kB, nor more than 100 header lines
+#define REQUEST_MAX_LINE_SIZE 8192
+#define REQUEST_MAX_HEADERS 100
+// The time in milliseconds a client is given to start sending the body before the minimum rate applies (see config_getMinBodyRate)
+#define REQUEST_BODY_GRACE_PERIOD 5000
 // Don't allow bodies larger than 1 MB
 #define REQUEST_MAX_BODY_SIZE 1048576
+// Large enough to hold an entity tag of three hexadecimal numbers and a content coding (see worker_formatETag)
+#define WORKER_ETAG_LENGTH 64
+// Large enough to hold a Content-Range value of three 64-bit integers (see worker_formatContentRange)
+#define WORKER_CONTENT_RANGE_LENGTH 80
+// The size of each block of a worker's per-request arena
+#define WORKER_ARENA_BLOCK_SIZE 65536
+// The number of seconds clients are asked to wait before retrying a request answered with 503 (see worker_shedConnection)
+#define WORKER_RETRY_AFTER 5
+// The number of seconds clients over their request rate are asked to wait (see config_getClientRequestRate)
+#define WORKER_RATE_LIMIT_RETRY_AFTER 1
 
-// The maximum time allowed for reading the response from a CGI process
-#define CGI_READ_TIMEOUT 1000
+// Reasons for answering a connection with 503 Service Unavailable
+enum workerShedReason { WORKER_SHED_QUEUE_FULL,
+                        WORKER_SHED_QUEUE_TIMEOUT,
+                        WORKER_SHED_CGI_LIMIT,
+                        WORKER_SHED_REASONS };
 
 typedef struct {
   // Always NULL if in immediate mode
@@ -33,21 +55,27 @@ typedef struct {
   // The current status of the worker
   // Written to by the worker, consumed by parent
   uint8_t status;
-  message_queue_t *queue;
+  work_queue_t *queue;
+  // The worker's own deque of the queue (see work_queue_pop)
+  size_t queueIndex;
   int id;
   // The current connection (if any)
   connection_t *connection;
   // The current CGI process (if any)
   cgi_process_t *cgi;
+  // The config used for the current connection (see config_acquireGlobalConfig)
+  config_t *config;
+  // Allocations made while handling a connection, reset after each connection
+  arena_t *arena;
   // Whether or not the worker should run (exit condition)
   bool shouldRun;
 } worker_t;
 
 // Pass a connection to handle it directly and destroy the thread after use (immediate mode)
-// Or pass NULL and a queue in order to make the thread listen for incoming connections (pool mode)
+// Or pass NULL and a queue in order to make the thread listen for incoming connections on its own deque (pool mode)
 // Returns NULL if ran in immediate mode (the thread takes care of the memory)
 // The connection (if passed) is owned
-worker_t *worker_spawn(int id, connection_t *connection, message_queue_t *queue);
+worker_t *worker_spawn(int id, connection_t *connection, work_queue_t *queue, size_t queueIndex);
 uint8_t worker_getStatus(const worker_t *worker) __attribute__((nonnull(1)));
 // Wait for the worker to exit naturally or after killing (undefined behaviour for immediate mode)
 void worker_waitForExit(const worker_t *worker) __attribute__((nonnull(1)));
@@ -55,7 +83,20 @@ void worker_waitForExit(const worker_t *worker) __attribute__((nonnull(1)));
 void worker_kill(worker_t *worker) __attribute__((nonnull(1)));
 // Mark a worker as dead, letting it exit when ready
 void worker_closeGracefully(worker_t *worker) __attribute__((nonnull(1)));
+// Make a worker (pool mode) exit, preferably an idle one. Connections left in its deque are moved to the other workers
+void worker_retire(work_queue_t *queue) __attribute__((nonnull(1)));
+// Free the connections left in the queue once every worker has exited. Returns the number of connections freed
+size_t worker_freeQueuedConnections(work_queue_t *queue) __attribute__((nonnull(1)));
 // Undefined behaviour for immediate mode
 void worker_free(worker_t *worker) __attribute__((nonnull(1)));
+// Answer a connection that can't be handled in time with a pre-serialised 503 and Retry-After, without reading the request.
+// The socket is shut down for writing, the connection should linger before it's closed (see connection_linger).
+// Returns the number of bytes written
+size_t worker_shedConnection(const connection_t *connection, enum workerShedReason reason) __attribute__((nonnull(1)));
+// Answer the connection with 503 from the timers if it waits for a worker for more than timeout milliseconds. The worker
+// that eventually takes it only lets it linger (see worker_shedConnection)
+void worker_setQueueDeadline(connection_t *connection, uint64_t timeout) __attribute__((nonnull(1)));
+// Get the number of connections answered with 503 for a reason by this process
+size_t worker_getShedConnections(enum workerShedReason reason);
 
 #endif
@@ -68,6 +68,20 @@ page_t *page_create413() {
   return page;
 }
 
+page_t *page_create414() {
+  page_t *page = page_create();
+  if (page == 0)
+    return 0;
+
+  page_setSource(page, string_fromBufferWithLength((const char *)RESOURCES_WWW_TEMPLATE_HTML, RESOURCES_WWW_TEMPLATE_HTML_LENGTH));
+
+  page_setTemplate(page, string_fromBuffer("content"), string_fromBuffer((const char *)RESOURCES_WWW_414_HTML));
+
+  page_resolveTemplates(page);
+
+  return page;
+}
+
 page_t *page_create417() {
   page_t *page = page_create();
   if (page == 0)
@@ -82,6 +96,20 @@ page_t *page_create417() {
   return page;
 }
 
+page_t *page_create431() {
+  page_t *page = page_create();
+  if (page == 0)
+    return 0;
+
+  page_setSource(page, string_fromBufferWithLength((const char *)RESOURCES_WWW_TEMPLATE_HTML, RESOURCES_WWW_TEMPLATE_HTML_LENGTH));
+
+  page_setTemplate(page, string_fromBuffer("content"), string_fromBuffer((const char *)RESOURCES_WWW_431_HTML));
+
+  page_resolveTemplates(page);
+
+  return page;
+}
+
 page_t *page_create404(string_t *path) {
   page_t *page = page_create();
   if (page == 0)
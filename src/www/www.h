@@ -18,7 +18,9 @@ page_t *page_create();
 page_t *page_create400(string_t *description) __attribute__((nonnull(1)));
 page_t *page_create403();
 page_t *page_create413();
+page_t *page_create414();
 page_t *page_create417();
+page_t *page_create431();
 // The path is owned
 page_t *page_create404(string_t *path) __attribute__((nonnull(1)));
 // The description is owned
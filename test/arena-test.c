@@ -0,0 +1,120 @@
+#include <string.h>
+
+#include "unity/unity.h"
+
+#include "../src/datastructures/arena/arena.h"
+#include "../src/http/http.h"
+#include "../src/string/string.h"
+
+void arena_test_canAllocate() {
+  arena_t *arena = arena_create(1024);
+  TEST_ASSERT_NOT_NULL(arena);
+
+  char *first = arena_allocate(arena, 10);
+  char *second = arena_allocate(arena, 10);
+  TEST_ASSERT_NOT_NULL(first);
+  TEST_ASSERT_NOT_NULL(second);
+  TEST_ASSERT(first != second);
+  TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)first % ARENA_ALIGNMENT);
+  TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)second % ARENA_ALIGNMENT);
+  TEST_ASSERT_TRUE(arena_contains(arena, first));
+  TEST_ASSERT_TRUE(arena_contains(arena, second));
+
+  // Allocations larger than a block get a block of their own
+  char *large = arena_allocate(arena, 4096);
+  TEST_ASSERT_NOT_NULL(large);
+  memset(large, 'a', 4096);
+  TEST_ASSERT_EQUAL_UINT64(3, arena->arenaAllocations);
+  TEST_ASSERT_EQUAL_UINT64(2, arena->blockAllocations);
+
+  int value = 0;
+  TEST_ASSERT_FALSE(arena_contains(arena, &value));
+
+  arena_free(arena);
+}
+
+void arena_test_canReset() {
+  arena_t *arena = arena_create(1024);
+
+  char *first = arena_allocate(arena, 100);
+  for (size_t i = 0; i < 20; i++)
+    arena_allocate(arena, 100);
+  size_t blocks = arena->blockAllocations;
+  TEST_ASSERT(blocks > 1);
+
+  arena_reset(arena);
+  TEST_ASSERT_EQUAL_UINT64(0, arena->arenaAllocations);
+  TEST_ASSERT_EQUAL_UINT64(0, arena->blockAllocations);
+  TEST_ASSERT_FALSE(arena_contains(arena, first));
+
+  // The blocks are reused after a reset
+  TEST_ASSERT_EQUAL_PTR(first, arena_allocate(arena, 100));
+  for (size_t i = 0; i < 20; i++)
+    arena_allocate(arena, 100);
+  TEST_ASSERT_EQUAL_UINT64(0, arena->blockAllocations);
+
+  arena_free(arena);
+}
+
+void arena_test_canReallocate() {
+  arena_t *arena = arena_create(1024);
+  arena_setCurrent(arena);
+
+  // The last allocation grows in place
+  char *buffer = arena_malloc(10);
+  memcpy(buffer, "123456789", 10);
+  TEST_ASSERT_EQUAL_PTR(buffer, arena_realloc(buffer, 100));
+
+  // Other allocations are copied
+  arena_malloc(10);
+  char *copy = arena_realloc(buffer, 200);
+  TEST_ASSERT(copy != buffer);
+  TEST_ASSERT_EQUAL_STRING("123456789", copy);
+
+  // Large allocations are made on the heap
+  char *large = arena_realloc(copy, ARENA_MAX_ALLOCATION_SIZE + 1);
+  TEST_ASSERT_FALSE(arena_contains(arena, large));
+  TEST_ASSERT_EQUAL_STRING("123456789", large);
+  TEST_ASSERT_EQUAL_UINT64(1, arena->heapAllocations);
+  arena_release(large);
+
+  // Releasing memory of the arena does nothing
+  arena_release(buffer);
+
+  arena_setCurrent(0);
+  arena_free(arena);
+}
+
+void arena_test_canParseRequestInArena() {
+  arena_t *arena = arena_create(0);
+  arena_setCurrent(arena);
+
+  http_t *request = http_create();
+  string_t *line = string_fromBuffer("GET /index.html?foo=bar HTTP/1.1");
+  TEST_ASSERT_TRUE(http_parseRequestLine(request, line));
+  string_free(line);
+  line = string_fromBuffer("Host: localhost:8080");
+  TEST_ASSERT_TRUE(http_parseHeader(request, line));
+  string_free(line);
+
+  TEST_ASSERT_EQUAL_STRING("/index.html", string_getBuffer(url_getPath(http_getUrl(request))));
+  string_t *key = string_fromBuffer("Host");
+  TEST_ASSERT_EQUAL_STRING("localhost:8080", string_getBuffer(http_getHeader(request, key)));
+  string_free(key);
+  http_free(request);
+
+  // Everything was allocated from the arena
+  TEST_ASSERT(arena->arenaAllocations > 0);
+  TEST_ASSERT_EQUAL_UINT64(0, arena->heapAllocations);
+  TEST_ASSERT_EQUAL_UINT64(1, arena->blockAllocations);
+
+  arena_setCurrent(0);
+  arena_free(arena);
+}
+
+void arena_test_run() {
+  RUN_TEST(arena_test_canAllocate);
+  RUN_TEST(arena_test_canReset);
+  RUN_TEST(arena_test_canReallocate);
+  RUN_TEST(arena_test_canParseRequestInArena);
+}
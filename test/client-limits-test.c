@@ -0,0 +1,199 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#include "unity/unity.h"
+
+#include "../src/client-limits/client-limits.h"
+
+void client_limits_test_createAddress(struct sockaddr_storage *storage, int family, const char *address) {
+  memset(storage, 0, sizeof(struct sockaddr_storage));
+  if (family == AF_INET) {
+    struct sockaddr_in *ipv4 = (struct sockaddr_in *)storage;
+    ipv4->sin_family = AF_INET;
+    TEST_ASSERT_EQUAL_INT(1, inet_pton(AF_INET, address, &ipv4->sin_addr));
+  } else {
+    struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *)storage;
+    ipv6->sin6_family = AF_INET6;
+    TEST_ASSERT_EQUAL_INT(1, inet_pton(AF_INET6, address, &ipv6->sin6_addr));
+  }
+}
+
+void client_limits_test_canLimitConnections() {
+  client_limits_t *limits = client_limits_create();
+  TEST_ASSERT_NOT_NULL(limits);
+
+  struct sockaddr_storage address;
+  client_limits_test_createAddress(&address, AF_INET, "192.0.2.1");
+  struct sockaddr_storage otherAddress;
+  client_limits_test_createAddress(&otherAddress, AF_INET6, "2001:db8::1");
+
+  client_limits_client_t *first = 0;
+  client_limits_client_t *second = 0;
+  client_limits_client_t *third = 0;
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 2, 0, &first));
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 2, 0, &second));
+  TEST_ASSERT_NOT_NULL(first);
+  TEST_ASSERT_EQUAL_PTR(first, second);
+  TEST_ASSERT_FALSE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 2, 0, &third));
+  TEST_ASSERT_NULL(third);
+  TEST_ASSERT_EQUAL_UINT64(1, limits->rejectedConnections);
+
+  // Other clients are accounted separately
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&otherAddress, 2, 0, &third));
+  TEST_ASSERT_NOT_NULL(third);
+  TEST_ASSERT_EQUAL_UINT64(2, client_limits_getClients(limits));
+
+  // Closing a connection makes room for another
+  client_limits_releaseConnection(first);
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 2, 0, &first));
+
+  // Only clients without connections are forgotten
+  client_limits_releaseConnection(third);
+  TEST_ASSERT_EQUAL_UINT64(0, client_limits_expire(limits, CLIENT_LIMITS_IDLE_TIME - 1));
+  TEST_ASSERT_EQUAL_UINT64(1, client_limits_expire(limits, CLIENT_LIMITS_IDLE_TIME));
+  TEST_ASSERT_EQUAL_UINT64(1, client_limits_getClients(limits));
+
+  client_limits_free(limits);
+}
+
+void client_limits_test_canLimitRequestRate() {
+  client_limits_t *limits = client_limits_create();
+  TEST_ASSERT_NOT_NULL(limits);
+
+  struct sockaddr_storage address;
+  client_limits_test_createAddress(&address, AF_INET, "192.0.2.1");
+  client_limits_client_t *client = 0;
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 0, 1000, &client));
+  TEST_ASSERT_NOT_NULL(client);
+
+  // A full bucket allows a burst of requests
+  for (size_t i = 0; i < 3; i++)
+    TEST_ASSERT_TRUE(client_limits_consumeRequest(client, 2, 3, 1000));
+  TEST_ASSERT_FALSE(client_limits_consumeRequest(client, 2, 3, 1000));
+  TEST_ASSERT_EQUAL_UINT64(1, limits->rejectedRequests);
+
+  // Two tokens are added per second
+  TEST_ASSERT_FALSE(client_limits_consumeRequest(client, 2, 3, 1400));
+  TEST_ASSERT_TRUE(client_limits_consumeRequest(client, 2, 3, 1500));
+  TEST_ASSERT_FALSE(client_limits_consumeRequest(client, 2, 3, 1500));
+
+  // The bucket never holds more than the burst
+  for (size_t i = 0; i < 3; i++)
+    TEST_ASSERT_TRUE(client_limits_consumeRequest(client, 2, 3, 60000));
+  TEST_ASSERT_FALSE(client_limits_consumeRequest(client, 2, 3, 60000));
+
+  // A rate of 0 is not limited
+  TEST_ASSERT_TRUE(client_limits_consumeRequest(client, 0, 0, 60000));
+
+  client_limits_releaseConnection(client);
+  client_limits_free(limits);
+}
+
+void client_limits_test_canLimitIPv6Prefixes() {
+  client_limits_t *limits = client_limits_create();
+  TEST_ASSERT_NOT_NULL(limits);
+
+  struct sockaddr_storage address;
+  client_limits_test_createAddress(&address, AF_INET6, "2001:db8::1");
+  struct sockaddr_storage samePrefix;
+  client_limits_test_createAddress(&samePrefix, AF_INET6, "2001:db8::ffff:2");
+  struct sockaddr_storage otherPrefix;
+  client_limits_test_createAddress(&otherPrefix, AF_INET6, "2001:db8:0:1::1");
+
+  // Addresses of the same /64 are the same client
+  client_limits_client_t *first = 0;
+  client_limits_client_t *second = 0;
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 1, 0, &first));
+  TEST_ASSERT_FALSE(client_limits_acquireConnection(limits, (struct sockaddr *)&samePrefix, 1, 0, &second));
+  TEST_ASSERT_NULL(second);
+  TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&otherPrefix, 1, 0, &second));
+  TEST_ASSERT_NOT_NULL(second);
+  TEST_ASSERT_EQUAL_UINT64(2, client_limits_getClients(limits));
+
+  client_limits_releaseConnection(first);
+  client_limits_releaseConnection(second);
+  client_limits_free(limits);
+}
+
+void client_limits_test_canLimitClientsOfFullShards() {
+  client_limits_t *limits = client_limits_create();
+  TEST_ASSERT_NOT_NULL(limits);
+
+  // Track clients without connections until one of the shards is full
+  size_t shardClients[CLIENT_LIMITS_SHARDS];
+  memset(shardClients, 0, sizeof(shardClients));
+  struct sockaddr_storage address;
+  struct sockaddr_in *ipv4 = (struct sockaddr_in *)&address;
+  client_limits_test_createAddress(&address, AF_INET, "10.0.0.0");
+  uint32_t nextAddress = 0x0a000000;
+  size_t fullShard = CLIENT_LIMITS_SHARDS;
+  while (fullShard == CLIENT_LIMITS_SHARDS) {
+    ipv4->sin_addr.s_addr = htonl(nextAddress++);
+    client_limits_client_t *client = 0;
+    TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 1, 0, &client));
+    TEST_ASSERT_NOT_NULL(client);
+    if (++shardClients[client->shard] == CLIENT_LIMITS_MAX_CLIENTS_PER_SHARD)
+      fullShard = client->shard;
+    client_limits_releaseConnection(client);
+  }
+
+  // A new client of the full shard takes the place of an idle client and is still limited
+  client_limits_client_t *client = 0;
+  while (true) {
+    ipv4->sin_addr.s_addr = htonl(nextAddress++);
+    TEST_ASSERT_TRUE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 1, 1, &client));
+    TEST_ASSERT_NOT_NULL(client);
+    if (client->shard == fullShard)
+      break;
+    client_limits_releaseConnection(client);
+  }
+  TEST_ASSERT_EQUAL_UINT64(CLIENT_LIMITS_MAX_CLIENTS_PER_SHARD, limits->shards[fullShard].clients);
+  TEST_ASSERT_EQUAL_UINT64(0, limits->untrackedConnections);
+  client_limits_client_t *otherClient = 0;
+  TEST_ASSERT_FALSE(client_limits_acquireConnection(limits, (struct sockaddr *)&address, 1, 1, &otherClient));
+  TEST_ASSERT_EQUAL_UINT64(1, limits->rejectedConnections);
+
+  client_limits_releaseConnection(client);
+  client_limits_free(limits);
+}
+
+void client_limits_test_canMatchNetworks() {
+  client_limits_network_t networks[3];
+  TEST_ASSERT_TRUE(client_limits_parseNetwork("10.0.0.0/8", &networks[0]));
+  TEST_ASSERT_TRUE(client_limits_parseNetwork("127.0.0.1", &networks[1]));
+  TEST_ASSERT_TRUE(client_limits_parseNetwork("2001:db8::/33", &networks[2]));
+
+  client_limits_network_t invalidNetwork;
+  TEST_ASSERT_FALSE(client_limits_parseNetwork("10.0.0.0/33", &invalidNetwork));
+  TEST_ASSERT_FALSE(client_limits_parseNetwork("10.0.0.0/", &invalidNetwork));
+  TEST_ASSERT_FALSE(client_limits_parseNetwork("10.0.0.0/a", &invalidNetwork));
+  TEST_ASSERT_FALSE(client_limits_parseNetwork("localhost", &invalidNetwork));
+  TEST_ASSERT_FALSE(client_limits_parseNetwork("/8", &invalidNetwork));
+
+  struct sockaddr_storage address;
+  client_limits_test_createAddress(&address, AF_INET, "10.20.30.40");
+  TEST_ASSERT_TRUE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  client_limits_test_createAddress(&address, AF_INET, "11.0.0.1");
+  TEST_ASSERT_FALSE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  client_limits_test_createAddress(&address, AF_INET, "127.0.0.1");
+  TEST_ASSERT_TRUE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  client_limits_test_createAddress(&address, AF_INET, "127.0.0.2");
+  TEST_ASSERT_FALSE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  client_limits_test_createAddress(&address, AF_INET6, "2001:db8:7fff::1");
+  TEST_ASSERT_TRUE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  client_limits_test_createAddress(&address, AF_INET6, "2001:db8:8000::1");
+  TEST_ASSERT_FALSE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  // IPv4 networks match IPv4 addresses mapped to IPv6
+  client_limits_test_createAddress(&address, AF_INET6, "::ffff:10.1.2.3");
+  TEST_ASSERT_TRUE(client_limits_isAllowed(networks, 3, (struct sockaddr *)&address));
+  TEST_ASSERT_FALSE(client_limits_isAllowed(networks, 0, (struct sockaddr *)&address));
+}
+
+void client_limits_test_run() {
+  RUN_TEST(client_limits_test_canLimitConnections);
+  RUN_TEST(client_limits_test_canLimitRequestRate);
+  RUN_TEST(client_limits_test_canLimitIPv6Prefixes);
+  RUN_TEST(client_limits_test_canLimitClientsOfFullShards);
+  RUN_TEST(client_limits_test_canMatchNetworks);
+}
@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "unity/unity.h"
+
+#include "../src/compression/compression.h"
+
+// Write a file of repeated text, returning its path (to be freed)
+char *compression_test_writeFile(size_t size) {
+  char *path = strdup("/tmp/wsic-compression-test-XXXXXX");
+  int file = mkstemp(path);
+  TEST_ASSERT_NOT_EQUAL(-1, file);
+  for (size_t i = 0; i < size; i++)
+    TEST_ASSERT_EQUAL_INT(1, write(file, &"<p>Hello, world!</p>\n"[i % 21], 1));
+  close(file);
+  return path;
+}
+
+void compression_test_canGzip() {
+  const char *text = "Hello, world! Hello, world! Hello, world! Hello, world!";
+  size_t compressedSize = 0;
+  char *compressed = compression_gzip(text, strlen(text), &compressedSize);
+  TEST_ASSERT_NOT_NULL(compressed);
+  // The gzip magic number
+  TEST_ASSERT_EQUAL_HEX8(0x1F, (uint8_t)compressed[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x8B, (uint8_t)compressed[1]);
+
+  char decompressed[128];
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  TEST_ASSERT_EQUAL_INT(Z_OK, inflateInit2(&stream, 15 + 16));
+  stream.next_in = (Bytef *)compressed;
+  stream.avail_in = compressedSize;
+  stream.next_out = (Bytef *)decompressed;
+  stream.avail_out = sizeof(decompressed);
+  TEST_ASSERT_EQUAL_INT(Z_STREAM_END, inflate(&stream, Z_FINISH));
+  TEST_ASSERT_EQUAL_UINT64(strlen(text), stream.total_out);
+  TEST_ASSERT_EQUAL_MEMORY(text, decompressed, strlen(text));
+  inflateEnd(&stream);
+
+  free(compressed);
+}
+
+void compression_test_canCacheCompressedFiles() {
+  compression_cache_t *cache = compression_createCache(1024);
+  TEST_ASSERT_NOT_NULL(cache);
+  char *path = compression_test_writeFile(4096);
+  struct stat info;
+  TEST_ASSERT_EQUAL_INT(0, stat(path, &info));
+
+  TEST_ASSERT_NULL(compression_getCachedGzip(cache, &info));
+  compression_entry_t *entry = compression_getGzip(cache, path, &info);
+  TEST_ASSERT_NOT_NULL(entry);
+  TEST_ASSERT_TRUE(entry->length < 4096);
+  compression_entry_t *cachedEntry = compression_getGzip(cache, path, &info);
+  TEST_ASSERT_EQUAL_PTR(entry, cachedEntry);
+  TEST_ASSERT_EQUAL_UINT64(1, cache->hits);
+  TEST_ASSERT_EQUAL_UINT64(1, cache->misses);
+  compression_releaseEntry(cachedEntry);
+  cachedEntry = compression_getCachedGzip(cache, &info);
+  TEST_ASSERT_EQUAL_PTR(entry, cachedEntry);
+  TEST_ASSERT_EQUAL_UINT64(2, cache->hits);
+  compression_releaseEntry(cachedEntry);
+
+  // A changed file is compressed anew, evicting the old copy which remains valid until released
+  cache->capacity = entry->length;
+  info.st_mtime++;
+  compression_entry_t *changedEntry = compression_getGzip(cache, path, &info);
+  TEST_ASSERT_NOT_NULL(changedEntry);
+  TEST_ASSERT_NOT_EQUAL(entry, changedEntry);
+  TEST_ASSERT_EQUAL_UINT64(2, cache->misses);
+  TEST_ASSERT_EQUAL_UINT64(changedEntry->length, cache->size);
+  TEST_ASSERT_EQUAL_UINT8(0x1F, (uint8_t)entry->data[0]);
+  compression_releaseEntry(entry);
+  compression_releaseEntry(changedEntry);
+
+  unlink(path);
+  free(path);
+  compression_freeCache(cache);
+}
+
+void compression_test_run() {
+  RUN_TEST(compression_test_canGzip);
+  RUN_TEST(compression_test_canCacheCompressedFiles);
+}
@@ -194,6 +194,86 @@ void config_test_canAccessGlobalConfig() {
   config_freeGlobalConfig();
 }
 
+void config_test_keepsAcquiredConfigWhenReplaced() {
+  config_t *config = config_parse("[server]");
+  config_t *newConfig = config_parse("[server]");
+
+  config_setGlobalConfig(config);
+  TEST_ASSERT(config_acquireGlobalConfig() == config);
+
+  // The acquired config stays alive after being replaced
+  config_setGlobalConfig(newConfig);
+  TEST_ASSERT(config_getGlobalConfig() == newConfig);
+  TEST_ASSERT_EQUAL_UINT64(1, config->references);
+
+  config_releaseConfig(config);
+  config_freeGlobalConfig();
+}
+
+void config_test_canReloadConfig() {
+  char *configString = "\
+  [server]\n\
+  threads = 16\n\
+  \n\
+  [servers]\n\
+  [servers.default]\n\
+  domain = \"localhost\"\n\
+  rootDirectory = \"www\"\n\
+  port = 8080\n\
+  [servers.defaultTLS]\n\
+  domain = \"localhost\"\n\
+  rootDirectory = \"www\"\n\
+  port = 8443\n\
+  certificate = \"server.cert\"\n\
+  privateKey = \"server.key\"\n\
+  [servers.otherTLS]\n\
+  domain = \"example.com\"\n\
+  rootDirectory = \"www\"\n\
+  port = 8443\n\
+  certificate = \"server.cert\"\n\
+  privateKey = \"server.key\"\n";
+
+  char *newConfigString = "\
+  [server]\n\
+  threads = 2\n\
+  \n\
+  [servers]\n\
+  [servers.default]\n\
+  domain = \"localhost\"\n\
+  rootDirectory = \"www\"\n\
+  port = 8080\n\
+  directoryIndex = [\"index.html\"]\n\
+  [servers.defaultTLS]\n\
+  domain = \"localhost\"\n\
+  rootDirectory = \"www\"\n\
+  port = 8443\n\
+  certificate = \"server.cert\"\n\
+  privateKey = \"server.key\"\n\
+  [servers.otherTLS]\n\
+  domain = \"example.com\"\n\
+  rootDirectory = \"www\"\n\
+  port = 8443\n\
+  certificate = \"server.cert\"\n\
+  privateKey = \"server.key\"\n\
+  ellipticCurves = \"P-384\"\n";
+
+  config_t *config = config_parse(configString);
+  TEST_ASSERT_NOT_NULL(config);
+  config_t *newConfig = config_reload(newConfigString, config);
+  TEST_ASSERT_NOT_NULL(newConfig);
+
+  // Settings of the [server] table are kept
+  TEST_ASSERT_EQUAL_UINT64(16, config_getNumberOfThreads(newConfig));
+  TEST_ASSERT_NOT_NULL(config_getDirectoryIndex(config_getServerConfig(newConfig, 0)));
+
+  // Unchanged TLS contexts are reused, changed ones are rebuilt
+  TEST_ASSERT(config_getSSLContext(config_getServerConfig(newConfig, 1)) == config_getSSLContext(config_getServerConfig(config, 1)));
+  TEST_ASSERT(config_getSSLContext(config_getServerConfig(newConfig, 2)) != config_getSSLContext(config_getServerConfig(config, 2)));
+
+  config_free(config);
+  config_free(newConfig);
+}
+
 void config_test_canParseConfig() {
   char *configString = "\
   [server]\n\
@@ -201,6 +281,15 @@ void config_test_canParseConfig() {
   logfile = \"log.txt\"\n\
   loggingLevel = 5\n\
   threads = 32\n\
+  minThreads = 8\n\
+  instances = 2\n\
+  ioUring = false\n\
+  headerTimeout = 5000\n\
+  queueTimeout = 2000\n\
+  maxCGIRequests = 8\n\
+  maxClientConnections = 16\n\
+  clientRequestRate = 10\n\
+  clientAllowList = [\"127.0.0.1\", \"10.0.0.0/8\", \"::1\", \"bad\"]\n\
   backlog = 128\n\
   \n\
   [servers]\n\
@@ -208,6 +297,8 @@ void config_test_canParseConfig() {
   domain = \"localhost\"\n\
   rootDirectory = \"www\"\n\
   port = 8080\n\
+  deferAccept = 5\n\
+  fastOpen = 256\n\
   directoryIndex = [\"index.html\"]\n\
   [servers.defaultTLS]\n\
   domain = \"localhost\"\n\
@@ -217,7 +308,8 @@ void config_test_canParseConfig() {
   certificate = \"server.cert\"\n\
   privateKey = \"server.key\"\n\
   ellipticCurves = \"P-384:P-521\"\n\
-  validateCertificate = false";
+  validateCertificate = false\n\
+  kernelTLS = true";
 
   config_t *config = config_parse(configString);
   TEST_ASSERT_NOT_NULL(config);
@@ -229,6 +321,21 @@ void config_test_canParseConfig() {
   TEST_ASSERT_EQUAL_STRING("log.txt", string_getBuffer(config_getLogfile(config)));
   TEST_ASSERT_EQUAL_INT8(5, config_getLoggingLevel(config));
   TEST_ASSERT_EQUAL_UINT64(32, config_getNumberOfThreads(config));
+  TEST_ASSERT_EQUAL_UINT64(8, config_getMinimumNumberOfThreads(config));
+  TEST_ASSERT_EQUAL_UINT64(2, config_getNumberOfInstances(config));
+  TEST_ASSERT_EQUAL_INT8(0, config_getIOUring(config));
+  TEST_ASSERT_EQUAL_UINT64(5000, config_getHeaderTimeout(config));
+  TEST_ASSERT_EQUAL_UINT64(CONFIG_DEFAULT_BODY_TIMEOUT, config_getBodyTimeout(config));
+  TEST_ASSERT_EQUAL_UINT64(CONFIG_DEFAULT_MIN_BODY_RATE, config_getMinBodyRate(config));
+  TEST_ASSERT_EQUAL_UINT64(2000, config_getQueueTimeout(config));
+  TEST_ASSERT_EQUAL_UINT64(CONFIG_DEFAULT_MAX_QUEUED_CONNECTIONS, config_getMaxQueuedConnections(config));
+  TEST_ASSERT_EQUAL_UINT64(8, config_getMaxCGIRequests(config));
+  TEST_ASSERT_EQUAL_UINT64(16, config_getMaxClientConnections(config));
+  TEST_ASSERT_EQUAL_UINT64(10, config_getClientRequestRate(config));
+  TEST_ASSERT_EQUAL_UINT64(0, config_getClientRequestBurst(config));
+  size_t allowedNetworks = 0;
+  TEST_ASSERT_NOT_NULL(config_getClientAllowList(config, &allowedNetworks));
+  TEST_ASSERT_EQUAL_UINT64(3, allowedNetworks);
   TEST_ASSERT_EQUAL_UINT64(128, config_getBacklogSize(config));
 
   server_config_t *serverConfig1 = config_getServerConfig(config, 0);
@@ -238,6 +345,8 @@ void config_test_canParseConfig() {
   TEST_ASSERT_EQUAL_STRING(resolvedRootDirectory1, string_getBuffer(config_getRootDirectory(serverConfig1)));
   free(resolvedRootDirectory1);
   TEST_ASSERT_EQUAL_UINT16(8080, config_getPort(serverConfig1));
+  TEST_ASSERT_EQUAL_INT32(5, config_getDeferAccept(serverConfig1));
+  TEST_ASSERT_EQUAL_INT32(256, config_getFastOpen(serverConfig1));
   TEST_ASSERT_NOT_NULL(config_getDirectoryIndex(serverConfig1));
   TEST_ASSERT_EQUAL_UINT64(1, list_getLength(config_getDirectoryIndex(serverConfig1)));
   TEST_ASSERT_EQUAL_STRING("index.html", string_getBuffer(list_getValue(config_getDirectoryIndex(serverConfig1), 0)));
@@ -253,6 +362,8 @@ void config_test_canParseConfig() {
   TEST_ASSERT_EQUAL_UINT64(1, list_getLength(config_getDirectoryIndex(serverConfig2)));
   TEST_ASSERT_EQUAL_STRING("index.html", string_getBuffer(list_getValue(config_getDirectoryIndex(serverConfig2), 0)));
   TEST_ASSERT_NOT_NULL(config_getSSLContext(serverConfig2));
+  TEST_ASSERT_EQUAL_INT8(-1, config_getKernelTLS(serverConfig1));
+  TEST_ASSERT_EQUAL_INT8(1, config_getKernelTLS(serverConfig2));
 
   config_free(config);
 }
@@ -365,6 +476,20 @@ void config_test_cannotParseTooFewThreads() {
   config_free(config);
 }
 
+void config_test_cannotParseTooManyMinimumThreads() {
+  char *configString = "\
+  [server]\n\
+  threads = 16\n\
+  minThreads = 64\n";
+
+  config_t *config = config_parse(configString);
+  TEST_ASSERT_NOT_NULL(config);
+
+  TEST_ASSERT(config_getMinimumNumberOfThreads(config) == 16);
+
+  config_free(config);
+}
+
 void config_test_cannotParseTooSmallBacklog() {
   char *configString = "\
   [server]\n\
@@ -438,6 +563,57 @@ void config_test_cannotParseNonExistingCertificate() {
   config_free(config);
 }
 
+void config_test_canParseMIMETypes() {
+  // Extensions may be given with or without the leading dot
+  char *tableString = "[mimeTypes]\n\".wasm\" = \"application/wasm\"\nmd = \"text/markdown\"";
+  toml_table_t *toml = toml_parse(tableString, 0, 0);
+  toml_table_t *table = toml_table_in(toml, "mimeTypes");
+
+  hash_table_t *mimeTypes = config_parseExtensionTable(table);
+  TEST_ASSERT_NOT_NULL(mimeTypes);
+  TEST_ASSERT_EQUAL_INT(2, hash_table_getLength(mimeTypes));
+  TEST_ASSERT_EQUAL_STRING("application/wasm", string_getBuffer(hash_table_getValueByView(mimeTypes, string_view_fromBuffer(".wasm"))));
+  TEST_ASSERT_EQUAL_STRING("text/markdown", string_getBuffer(hash_table_getValueByView(mimeTypes, string_view_fromBuffer(".md"))));
+
+  while (hash_table_getLength(mimeTypes) > 0)
+    string_free(hash_table_removeValue(mimeTypes, hash_table_getKeyByIndex(mimeTypes, 0)));
+  hash_table_free(mimeTypes);
+  toml_free(toml);
+}
+
+void config_test_canParseCacheControl() {
+  char *configString = "[servers]\n[servers.a]\ndomain = \"a\"\nport = 8080\ncacheControl = \"no-cache\"\n[servers.b]\ndomain = \"b\"\nport = 8081\n[servers.b.cacheControl]\nHTML = \"no-cache\"\n\"*\" = \"max-age=3600\"\n[servers.c]\ndomain = \"c\"\nport = 8082\n";
+  config_t *config = config_parse(configString);
+  TEST_ASSERT_NOT_NULL(config);
+
+  // A single value applies to all files
+  string_t *name = string_fromBuffer("a");
+  server_config_t *serverConfig = config_getServerConfigByName(config, name);
+  string_free(name);
+  TEST_ASSERT_NOT_NULL(serverConfig);
+  TEST_ASSERT_EQUAL_STRING("no-cache", string_getBuffer(config_getCacheControl(serverConfig, string_view_fromBuffer(".css"))));
+  TEST_ASSERT_EQUAL_STRING("no-cache", string_getBuffer(config_getCacheControl(serverConfig, string_view_fromBuffer(""))));
+
+  // Values by extension fall back to "*"
+  name = string_fromBuffer("b");
+  serverConfig = config_getServerConfigByName(config, name);
+  string_free(name);
+  TEST_ASSERT_NOT_NULL(serverConfig);
+  TEST_ASSERT_EQUAL_STRING("no-cache", string_getBuffer(config_getCacheControl(serverConfig, string_view_fromBuffer(".html"))));
+  TEST_ASSERT_EQUAL_STRING("max-age=3600", string_getBuffer(config_getCacheControl(serverConfig, string_view_fromBuffer(".css"))));
+  // Extensions are matched ignoring case, like MIME types
+  TEST_ASSERT_EQUAL_STRING("no-cache", string_getBuffer(config_getCacheControl(serverConfig, string_view_fromBuffer(".HTML"))));
+  TEST_ASSERT_EQUAL_STRING("no-cache", string_getBuffer(config_getCacheControl(serverConfig, string_view_fromBuffer(".Html"))));
+
+  name = string_fromBuffer("c");
+  serverConfig = config_getServerConfigByName(config, name);
+  string_free(name);
+  TEST_ASSERT_NOT_NULL(serverConfig);
+  TEST_ASSERT_NULL(config_getCacheControl(serverConfig, string_view_fromBuffer(".html")));
+
+  config_free(config);
+}
+
 void config_test_run() {
   RUN_TEST(config_test_canParseString);
   RUN_TEST(config_test_cannotParseNonExistingString);
@@ -452,10 +628,14 @@ void config_test_run() {
   RUN_TEST(config_test_cannotParseInvalidBool);
 
   RUN_TEST(config_test_canParseStringArray);
+  RUN_TEST(config_test_canParseMIMETypes);
+  RUN_TEST(config_test_canParseCacheControl);
   RUN_TEST(config_test_canParseIntArray);
   RUN_TEST(config_test_canParseBoolArray);
 
   RUN_TEST(config_test_canAccessGlobalConfig);
+  RUN_TEST(config_test_keepsAcquiredConfigWhenReplaced);
+  RUN_TEST(config_test_canReloadConfig);
 
   RUN_TEST(config_test_canParseConfig);
   RUN_TEST(config_test_cannotParseInvalidConfig);
@@ -465,6 +645,7 @@ void config_test_run() {
   RUN_TEST(config_test_cannotParseInvalidPort);
   RUN_TEST(config_test_cannotParseInvalidTLSConfig);
   RUN_TEST(config_test_cannotParseTooFewThreads);
+  RUN_TEST(config_test_cannotParseTooManyMinimumThreads);
   RUN_TEST(config_test_cannotParseTooSmallBacklog);
   RUN_TEST(config_test_canParseTooLargeBacklog);
   RUN_TEST(config_test_cannotParseNonExistingPrivateKey);
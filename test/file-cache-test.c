@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+
+#include "../src/file-cache/file-cache.h"
+
+// Write a file, returning its path (to be freed)
+char *file_cache_test_writeFile(const char *content) {
+  char *path = strdup("/tmp/wsic-file-cache-test-XXXXXX");
+  int file = mkstemp(path);
+  TEST_ASSERT_NOT_EQUAL(-1, file);
+  TEST_ASSERT_EQUAL_INT(strlen(content), write(file, content, strlen(content)));
+  close(file);
+  return path;
+}
+
+void file_cache_test_canCacheOpenFiles() {
+  file_cache_t *cache = file_cache_create(2, 60, 60);
+  TEST_ASSERT_NOT_NULL(cache);
+  char *path = file_cache_test_writeFile("Hello, world!");
+
+  file_cache_entry_t *entry = file_cache_open(cache, path, strlen(path));
+  TEST_ASSERT_NOT_NULL(entry);
+  TEST_ASSERT_TRUE(file_cache_isFile(entry));
+  TEST_ASSERT_FALSE(file_cache_isExecutable(entry));
+  TEST_ASSERT_EQUAL_INT64(13, entry->info.st_size);
+  file_cache_entry_t *cachedEntry = file_cache_open(cache, path, strlen(path));
+  TEST_ASSERT_EQUAL_PTR(entry, cachedEntry);
+  TEST_ASSERT_EQUAL_UINT64(1, cache->hits);
+  TEST_ASSERT_EQUAL_UINT64(1, cache->misses);
+  file_cache_release(cachedEntry);
+
+  // Missing files and directories are cached, but not kept open
+  file_cache_entry_t *missingEntry = file_cache_open(cache, "/tmp/wsic-file-cache-test-missing", 33);
+  TEST_ASSERT_NOT_NULL(missingEntry);
+  TEST_ASSERT_FALSE(file_cache_isFile(missingEntry));
+  TEST_ASSERT_NOT_EQUAL(0, missingEntry->error);
+  file_cache_release(missingEntry);
+  file_cache_entry_t *directoryEntry = file_cache_open(cache, "/tmp", 4);
+  TEST_ASSERT_NOT_NULL(directoryEntry);
+  TEST_ASSERT_FALSE(file_cache_isFile(directoryEntry));
+  TEST_ASSERT_EQUAL_INT(0, directoryEntry->error);
+  file_cache_release(directoryEntry);
+
+  // The least recently used entry was evicted, but remains open until released
+  TEST_ASSERT_EQUAL_UINT64(2, cache->length);
+  TEST_ASSERT_FALSE(entry->isCached);
+  char buffer[5];
+  TEST_ASSERT_EQUAL_INT(5, pread(entry->file, buffer, 5, 0));
+  TEST_ASSERT_EQUAL_MEMORY("Hello", buffer, 5);
+  file_cache_release(entry);
+
+  unlink(path);
+  free(path);
+  file_cache_free(cache);
+}
+
+void file_cache_test_canReplaceChangedFiles() {
+  // Validate on every use
+  file_cache_t *cache = file_cache_create(8, 0, 60);
+  TEST_ASSERT_NOT_NULL(cache);
+  char *path = file_cache_test_writeFile("Hello");
+
+  file_cache_entry_t *entry = file_cache_open(cache, path, strlen(path));
+  TEST_ASSERT_NOT_NULL(entry);
+  file_cache_entry_t *cachedEntry = file_cache_open(cache, path, strlen(path));
+  TEST_ASSERT_EQUAL_PTR(entry, cachedEntry);
+  file_cache_release(cachedEntry);
+
+  unlink(path);
+  file_cache_entry_t *changedEntry = file_cache_open(cache, path, strlen(path));
+  TEST_ASSERT_NOT_NULL(changedEntry);
+  TEST_ASSERT_NOT_EQUAL(entry, changedEntry);
+  TEST_ASSERT_FALSE(file_cache_isFile(changedEntry));
+  TEST_ASSERT_EQUAL_UINT64(1, cache->length);
+  file_cache_release(changedEntry);
+  file_cache_release(entry);
+
+  // Entries not used within the inactivity period are closed
+  cache->inactivity = 0;
+  file_cache_expire(cache);
+  TEST_ASSERT_EQUAL_UINT64(0, cache->length);
+  TEST_ASSERT_NULL(cache->first);
+
+  free(path);
+  file_cache_free(cache);
+}
+
+void file_cache_test_run() {
+  RUN_TEST(file_cache_test_canCacheOpenFiles);
+  RUN_TEST(file_cache_test_canReplaceChangedFiles);
+}
@@ -0,0 +1,79 @@
+#include <string.h>
+
+#include "unity/unity.h"
+
+#include "../src/format/format.h"
+
+void format_test_canFormatIntegers() {
+  char buffer[FORMAT_INTEGER_LENGTH];
+
+  TEST_ASSERT_EQUAL_UINT64(1, format_integer(buffer, 0));
+  TEST_ASSERT_EQUAL_STRING("0", buffer);
+  TEST_ASSERT_EQUAL_UINT64(2, format_integer(buffer, 42));
+  TEST_ASSERT_EQUAL_STRING("42", buffer);
+  TEST_ASSERT_EQUAL_UINT64(3, format_integer(buffer, 404));
+  TEST_ASSERT_EQUAL_STRING("404", buffer);
+  TEST_ASSERT_EQUAL_UINT64(2, format_integer(buffer, -7));
+  TEST_ASSERT_EQUAL_STRING("-7", buffer);
+  TEST_ASSERT_EQUAL_UINT64(20, format_integer(buffer, INT64_MIN));
+  TEST_ASSERT_EQUAL_STRING("-9223372036854775808", buffer);
+  TEST_ASSERT_EQUAL_UINT64(20, format_unsignedInteger(buffer, UINT64_MAX));
+  TEST_ASSERT_EQUAL_STRING("18446744073709551615", buffer);
+
+  TEST_ASSERT_EQUAL_UINT64(1, format_hexadecimal(buffer, 0));
+  TEST_ASSERT_EQUAL_STRING("0", buffer);
+  TEST_ASSERT_EQUAL_UINT64(8, format_hexadecimal(buffer, 0x5e0c3f1a));
+  TEST_ASSERT_EQUAL_STRING("5e0c3f1a", buffer);
+  TEST_ASSERT_EQUAL_UINT64(16, format_hexadecimal(buffer, UINT64_MAX));
+  TEST_ASSERT_EQUAL_STRING("ffffffffffffffff", buffer);
+}
+
+void format_test_canFormatDates() {
+  char httpDate[FORMAT_HTTP_DATE_LENGTH];
+  format_httpDate(httpDate, 784111777);
+  TEST_ASSERT_EQUAL_STRING("Sun, 06 Nov 1994 08:49:37 GMT", httpDate);
+
+  // The local time zone is not known, so only check the shape
+  char commonLogDate[FORMAT_COMMON_LOG_DATE_LENGTH];
+  format_commonLogDate(commonLogDate, 784111777);
+  TEST_ASSERT_EQUAL_UINT64(FORMAT_COMMON_LOG_DATE_LENGTH - 1, strlen(commonLogDate));
+  TEST_ASSERT_EQUAL_INT8('[', commonLogDate[0]);
+  TEST_ASSERT_EQUAL_STRING_LEN("Nov/1994:", commonLogDate + 4, 9);
+  TEST_ASSERT_TRUE(commonLogDate[22] == '+' || commonLogDate[22] == '-');
+  TEST_ASSERT_EQUAL_INT8(']', commonLogDate[27]);
+
+  // The cached date has the same format as a freshly formatted one
+  char currentDate[FORMAT_HTTP_DATE_LENGTH];
+  format_getCurrentHTTPDate(currentDate);
+  TEST_ASSERT_EQUAL_UINT64(FORMAT_HTTP_DATE_LENGTH - 1, strlen(currentDate));
+  TEST_ASSERT_EQUAL_STRING(" GMT", currentDate + 25);
+}
+
+void format_test_canParseDates() {
+  time_t time = 0;
+  const char *date = "Sun, 06 Nov 1994 08:49:37 GMT";
+  TEST_ASSERT_TRUE(format_parseHTTPDate(date, strlen(date), &time));
+  TEST_ASSERT_EQUAL_INT64(784111777, time);
+
+  // Formatting and parsing are symmetric
+  char buffer[FORMAT_HTTP_DATE_LENGTH];
+  format_httpDate(buffer, 1700000000);
+  TEST_ASSERT_TRUE(format_parseHTTPDate(buffer, strlen(buffer), &time));
+  TEST_ASSERT_EQUAL_INT64(1700000000, time);
+
+  // The obsolete formats and malformed dates are not supported
+  date = "Sunday, 06-Nov-94 08:49:37 GMT";
+  TEST_ASSERT_FALSE(format_parseHTTPDate(date, strlen(date), &time));
+  date = "Sun Nov  6 08:49:37 1994";
+  TEST_ASSERT_FALSE(format_parseHTTPDate(date, strlen(date), &time));
+  date = "Sun, 06 Nox 1994 08:49:37 GMT";
+  TEST_ASSERT_FALSE(format_parseHTTPDate(date, strlen(date), &time));
+  date = "Sun, 06 Nov 1994 08:4a:37 GMT";
+  TEST_ASSERT_FALSE(format_parseHTTPDate(date, strlen(date), &time));
+}
+
+void format_test_run() {
+  RUN_TEST(format_test_canFormatIntegers);
+  RUN_TEST(format_test_canFormatDates);
+  RUN_TEST(format_test_canParseDates);
+}
@@ -44,6 +44,14 @@ void hash_table_test_canStoreValues() {
   hash_table_free(hashTable);
 }
 
+void hash_table_test_canHashValues() {
+  // Known CRC32C check values
+  TEST_ASSERT_EQUAL_HEX32(0x00000000, hash_table_hashWithLength("", 0));
+  TEST_ASSERT_EQUAL_HEX32(0xE3069283, hash_table_hash("123456789"));
+  TEST_ASSERT_EQUAL_HEX32(0x22620404, hash_table_hash("The quick brown fox jumps over the lazy dog"));
+}
+
 void hash_table_test_run() {
   RUN_TEST(hash_table_test_canStoreValues);
+  RUN_TEST(hash_table_test_canHashValues);
 }
@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "unity/unity.h"
+
+#include "../src/http/headers.h"
+#include "../src/http/http.h"
+
+void headers_test_canParseHeaderNames() {
+  // Every well-known header has a slot of its own
+  for (enum httpHeader header = HTTP_HEADER_UNKNOWN + 1; header < HTTP_HEADER_COUNT; header++) {
+    string_view_t name = http_getHeaderName(header);
+    TEST_ASSERT_TRUE(name.size > 0);
+    TEST_ASSERT_EQUAL_INT(header, http_parseHeaderName(name));
+  }
+
+  // Header names are case insensitive
+  TEST_ASSERT_EQUAL_INT(HTTP_HEADER_CONTENT_LENGTH, http_parseHeaderName(string_view_fromBuffer("content-length")));
+  TEST_ASSERT_EQUAL_INT(HTTP_HEADER_USER_AGENT, http_parseHeaderName(string_view_fromBuffer("USER-AGENT")));
+
+  TEST_ASSERT_EQUAL_INT(HTTP_HEADER_UNKNOWN, http_parseHeaderName(string_view_fromBuffer("")));
+  TEST_ASSERT_EQUAL_INT(HTTP_HEADER_UNKNOWN, http_parseHeaderName(string_view_fromBuffer("X-Custom")));
+  TEST_ASSERT_EQUAL_INT(HTTP_HEADER_UNKNOWN, http_parseHeaderName(string_view_fromBuffer("Content-Lengths")));
+  TEST_ASSERT_EQUAL_INT(0, http_getHeaderName(HTTP_HEADER_COUNT).size);
+}
+
+void headers_test_canGetHeadersById() {
+  http_t *http = http_create();
+
+  string_t *header = string_fromBuffer("accept-encoding: gzip");
+  TEST_ASSERT_TRUE(http_parseHeader(http, header));
+  string_free(header);
+  header = string_fromBuffer("X-Custom: value");
+  TEST_ASSERT_TRUE(http_parseHeader(http, header));
+  string_free(header);
+
+  // Well-known headers are resolved during parsing
+  TEST_ASSERT_EQUAL_STRING("gzip", string_getBuffer(http_getHeaderById(http, HTTP_HEADER_ACCEPT_ENCODING)));
+  TEST_ASSERT_EQUAL_STRING("gzip", string_getBuffer(http_getHeaderByView(http, string_view_fromBuffer("Accept-Encoding"))));
+  TEST_ASSERT_NULL(http_getHeaderById(http, HTTP_HEADER_HOST));
+  TEST_ASSERT_EQUAL_STRING("value", string_getBuffer(http_getHeaderByView(http, string_view_fromBuffer("X-Custom"))));
+
+  // Replacing a header updates its entry, even though it was parsed in lower case
+  http_setHeaderById(http, HTTP_HEADER_ACCEPT_ENCODING, string_fromBuffer("br"));
+  TEST_ASSERT_EQUAL_STRING("br", string_getBuffer(http_getHeaderById(http, HTTP_HEADER_ACCEPT_ENCODING)));
+  string_t *response = http_toResponseString(http);
+  TEST_ASSERT_NOT_NULL(strstr(string_getBuffer(response), "\r\nAccept-Encoding: br\r\n"));
+  TEST_ASSERT_NULL(strstr(string_getBuffer(response), "gzip"));
+  string_free(response);
+
+  http_free(http);
+}
+
+void headers_test_canReplaceHeadersIgnoringCase() {
+  http_t *http = http_create();
+
+  http_setHeader(http, string_fromBuffer("content-type"), string_fromBuffer("text/plain"));
+  http_setHeader(http, string_fromBuffer("Content-Type"), string_fromBuffer("text/html"));
+  http_setHeader(http, string_fromBuffer("x-custom"), string_fromBuffer("first"));
+  http_setHeader(http, string_fromBuffer("X-CUSTOM"), string_fromBuffer("second"));
+
+  TEST_ASSERT_EQUAL_STRING("text/html", string_getBuffer(http_getHeaderById(http, HTTP_HEADER_CONTENT_TYPE)));
+  TEST_ASSERT_EQUAL_STRING("second", string_getBuffer(http_getHeaderByView(http, string_view_fromBuffer("X-CUSTOM"))));
+  TEST_ASSERT_NULL(http_getHeaderByView(http, string_view_fromBuffer("x-custom")));
+
+  // Only the last value of each header is sent, under the name last used
+  string_t *response = http_toResponseString(http);
+  TEST_ASSERT_NOT_NULL(strstr(string_getBuffer(response), "\r\nContent-Type: text/html\r\n"));
+  TEST_ASSERT_NOT_NULL(strstr(string_getBuffer(response), "\r\nX-CUSTOM: second\r\n"));
+  TEST_ASSERT_NULL(strstr(string_getBuffer(response), "text/plain"));
+  TEST_ASSERT_NULL(strstr(string_getBuffer(response), "first"));
+  string_free(response);
+
+  http_free(http);
+}
+
+void headers_test_run() {
+  RUN_TEST(headers_test_canParseHeaderNames);
+  RUN_TEST(headers_test_canGetHeadersById);
+  RUN_TEST(headers_test_canReplaceHeadersIgnoringCase);
+}
@@ -308,6 +308,71 @@ void http_test_canGetAndSetBody() {
   http_free(http);
 }
 
+void http_test_canParseRanges() {
+  http_range_t ranges[4];
+
+  // A single range, an open ended range and a suffix
+  TEST_ASSERT_EQUAL_INT(1, http_parseRange(string_view_fromBuffer("bytes=0-99"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(0, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(100, ranges[0].length);
+  TEST_ASSERT_EQUAL_INT(3, http_parseRange(string_view_fromBuffer("bytes=500-599, -100 ,0-9"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(0, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(10, ranges[0].length);
+  TEST_ASSERT_EQUAL_UINT64(500, ranges[1].offset);
+  TEST_ASSERT_EQUAL_UINT64(100, ranges[1].length);
+  TEST_ASSERT_EQUAL_UINT64(900, ranges[2].offset);
+  TEST_ASSERT_EQUAL_UINT64(100, ranges[2].length);
+  TEST_ASSERT_EQUAL_INT(1, http_parseRange(string_view_fromBuffer("bytes=500-, -100 ,900-2000"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(500, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(500, ranges[0].length);
+
+  // Overlapping, adjacent and duplicate ranges are merged
+  TEST_ASSERT_EQUAL_INT(1, http_parseRange(string_view_fromBuffer("bytes=0-99,0-99,0-99"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(0, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(100, ranges[0].length);
+  TEST_ASSERT_EQUAL_INT(2, http_parseRange(string_view_fromBuffer("bytes=200-299,0-49,50-99,250-399"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(0, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(100, ranges[0].length);
+  TEST_ASSERT_EQUAL_UINT64(200, ranges[1].offset);
+  TEST_ASSERT_EQUAL_UINT64(200, ranges[1].length);
+  TEST_ASSERT_EQUAL_INT(1, http_parseRange(string_view_fromBuffer("bytes=100-199,300-399,0-999"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(0, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(1000, ranges[0].length);
+
+  // A suffix longer than the resource covers all of it
+  TEST_ASSERT_EQUAL_INT(1, http_parseRange(string_view_fromBuffer("bytes=-5000"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_UINT64(0, ranges[0].offset);
+  TEST_ASSERT_EQUAL_UINT64(1000, ranges[0].length);
+
+  // Unsatisfiable ranges are skipped
+  TEST_ASSERT_EQUAL_INT(1, http_parseRange(string_view_fromBuffer("bytes=1000-,0-0"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(0, http_parseRange(string_view_fromBuffer("bytes=1000-1999"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(0, http_parseRange(string_view_fromBuffer("bytes=-0"), 1000, ranges, 4));
+
+  // Invalid headers, other units and too many ranges are ignored
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("items=0-1"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("bytes="), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("bytes=-"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("bytes=5-1"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("bytes=a-1"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("bytes=0-99999999999999999999"), 1000, ranges, 4));
+  TEST_ASSERT_EQUAL_INT(-1, http_parseRange(string_view_fromBuffer("bytes=0-0,2-2,4-4,6-6,8-8"), 1000, ranges, 4));
+}
+
+void http_test_canParseAcceptEncoding() {
+  TEST_ASSERT_EQUAL_UINT8(0, http_parseAcceptEncoding(string_view_fromBuffer("")));
+  TEST_ASSERT_EQUAL_UINT8(0, http_parseAcceptEncoding(string_view_fromBuffer("identity, deflate")));
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_GZIP, http_parseAcceptEncoding(string_view_fromBuffer("gzip")));
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_GZIP, http_parseAcceptEncoding(string_view_fromBuffer("X-GZIP;q=0.5")));
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_GZIP | HTTP_ENCODING_BROTLI, http_parseAcceptEncoding(string_view_fromBuffer("gzip, deflate, br")));
+
+  // A weight of zero rejects a coding, also when matched by the wildcard
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_GZIP, http_parseAcceptEncoding(string_view_fromBuffer("gzip;q=1.0, br;q=0")));
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_BROTLI, http_parseAcceptEncoding(string_view_fromBuffer("gzip ; Q=0.000, *")));
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_GZIP | HTTP_ENCODING_BROTLI, http_parseAcceptEncoding(string_view_fromBuffer("*;q=0.001")));
+  TEST_ASSERT_EQUAL_UINT8(HTTP_ENCODING_GZIP, http_parseAcceptEncoding(string_view_fromBuffer("gzip, *;q=0")));
+}
+
 void http_test_run() {
   RUN_TEST(http_test_canParseRequestLine);
   RUN_TEST(http_test_canGetAndSetMethod);
@@ -321,4 +386,6 @@ void http_test_run() {
   RUN_TEST(http_test_canParseHttpHeaders);
   RUN_TEST(http_test_canParseHost);
   RUN_TEST(http_test_canGetAndSetBody);
+  RUN_TEST(http_test_canParseRanges);
+  RUN_TEST(http_test_canParseAcceptEncoding);
 }
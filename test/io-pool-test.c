@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+
+#include "../src/io-pool/io-pool.h"
+
+typedef struct {
+  io_pool_job_t job;
+  // How long the job takes in microseconds
+  useconds_t duration;
+  bool hasRun;
+  // Shared by the jobs of a test, counting the abandoned ones
+  size_t *abandonedJobs;
+} io_pool_test_job_t;
+
+void io_pool_test_runJob(io_pool_job_t *job) {
+  io_pool_test_job_t *testJob = (io_pool_test_job_t *)job;
+  if (testJob->duration > 0)
+    usleep(testJob->duration);
+  testJob->hasRun = true;
+}
+
+void io_pool_test_abandonJob(io_pool_job_t *job) {
+  io_pool_test_job_t *testJob = (io_pool_test_job_t *)job;
+  TEST_ASSERT_TRUE(testJob->hasRun);
+  __atomic_add_fetch(testJob->abandonedJobs, 1, __ATOMIC_ACQ_REL);
+  free(testJob);
+}
+
+io_pool_test_job_t *io_pool_test_createJob(useconds_t duration, size_t *abandonedJobs) {
+  io_pool_test_job_t *job = malloc(sizeof(io_pool_test_job_t));
+  TEST_ASSERT_NOT_NULL(job);
+  job->job.run = io_pool_test_runJob;
+  job->job.abandon = io_pool_test_abandonJob;
+  job->duration = duration;
+  job->hasRun = false;
+  job->abandonedJobs = abandonedJobs;
+  return job;
+}
+
+void io_pool_test_canRunJobs() {
+  io_pool_t *pool = io_pool_create(2);
+  TEST_ASSERT_NOT_NULL(pool);
+  TEST_ASSERT_EQUAL_UINT64(2, pool->threadCount);
+  size_t abandonedJobs = 0;
+
+  // Jobs waited for are freed by the caller
+  io_pool_test_job_t *job = io_pool_test_createJob(0, &abandonedJobs);
+  TEST_ASSERT_TRUE(io_pool_run(pool, &job->job, 1000));
+  TEST_ASSERT_TRUE(job->hasRun);
+  free(job);
+
+  // Submitted jobs are abandoned once done
+  for (size_t i = 0; i < 8; i++)
+    io_pool_submit(pool, &io_pool_test_createJob(1000, &abandonedJobs)->job);
+  TEST_ASSERT_TRUE(pool->maxQueueLength >= 1);
+
+  // Queued jobs are done before the pool is freed
+  io_pool_free(pool);
+  TEST_ASSERT_EQUAL_UINT64(8, abandonedJobs);
+}
+
+void io_pool_test_canTimeOut() {
+  io_pool_t *pool = io_pool_create(1);
+  TEST_ASSERT_NOT_NULL(pool);
+  size_t abandonedJobs = 0;
+
+  // The job is left to the I/O thread, which frees it once done
+  io_pool_test_job_t *job = io_pool_test_createJob(100000, &abandonedJobs);
+  TEST_ASSERT_FALSE(io_pool_run(pool, &job->job, 10));
+  TEST_ASSERT_EQUAL_UINT64(1, pool->timedOutJobs);
+
+  io_pool_free(pool);
+  TEST_ASSERT_EQUAL_UINT64(1, abandonedJobs);
+}
+
+void io_pool_test_run() {
+  RUN_TEST(io_pool_test_canRunJobs);
+  RUN_TEST(io_pool_test_canTimeOut);
+}
@@ -42,11 +42,9 @@ void logging_test_canLogRequest() {
   bool loggingFileOpened = logging_openOutputFile("build/logging.test.request.log");
   TEST_ASSERT_TRUE(loggingFileOpened);
 
-  string_t *remoteHost = string_fromBuffer("localhost");
   string_t *path = string_fromBuffer("/index.html");
   string_t *version = string_fromBuffer("1.1");
-  logging_request(remoteHost, HTTP_METHOD_GET, path, version, 200, 700);
-  string_free(remoteHost);
+  logging_request("localhost", HTTP_METHOD_GET, path, version, 200, 700);
   string_free(path);
   string_free(version);
 
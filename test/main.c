@@ -2,20 +2,32 @@
 
 #include "../src/logging/logging.h"
 
+#include "arena-test.c"
+#include "client-limits-test.c"
+#include "compression-test.c"
 #include "config-test.c"
+#include "file-cache-test.c"
+#include "format-test.c"
 #include "hash-table-test.c"
+#include "headers-test.c"
 #include "http-test.c"
+#include "io-pool-test.c"
 #include "list-test.c"
 #include "logging-test.c"
 #include "message-queue-test.c"
 #include "path-test.c"
+#include "pool-test.c"
 #include "queue-test.c"
 #include "resources-test.c"
 #include "response-codes-test.c"
+#include "server-test.c"
 #include "set-test.c"
 #include "string-test.c"
 #include "time-test.c"
+#include "timer-wheel-test.c"
+#include "uring-test.c"
 #include "url-test.c"
+#include "work-queue-test.c"
 #include "www-test.c"
 
 int main() {
@@ -30,12 +42,24 @@ int main() {
   set_test_run();
   hash_table_test_run();
   http_test_run();
+  headers_test_run();
   response_codes_test_run();
   www_test_run();
   config_test_run();
   time_test_run();
   path_test_run();
   message_queue_test_run();
+  work_queue_test_run();
+  timer_wheel_test_run();
+  arena_test_run();
+  pool_test_run();
+  format_test_run();
+  compression_test_run();
+  file_cache_test_run();
+  io_pool_test_run();
+  client_limits_test_run();
+  uring_test_run();
+  server_test_run();
   resources_test_run();
   logging_test_run();
 
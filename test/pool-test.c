@@ -0,0 +1,69 @@
+#include <pthread.h>
+
+#include "unity/unity.h"
+
+#include "../src/datastructures/pool/pool.h"
+
+void pool_test_canReuseObjects() {
+  pool_t *pool = pool_create(64, 16);
+  TEST_ASSERT_NOT_NULL(pool);
+
+  void *first = pool_acquire(pool);
+  TEST_ASSERT_NOT_NULL(first);
+  pool_release(pool, first);
+
+  // Released objects are reused by the same thread
+  TEST_ASSERT_EQUAL_PTR(first, pool_acquire(pool));
+  TEST_ASSERT_EQUAL_UINT64(1, pool->allocations);
+  TEST_ASSERT_EQUAL_UINT64(1, pool->reuses);
+
+  pool_release(pool, first);
+  pool_free(pool);
+}
+
+void pool_test_canShareObjectsBetweenThreads() {
+  pool_t *pool = pool_create(64, 1024);
+
+  // Objects released beyond the thread's cache are handed over to the pool
+  void *objects[POOL_THREAD_CACHE_SIZE * 2];
+  size_t count = sizeof(objects) / sizeof(objects[0]);
+  for (size_t i = 0; i < count; i++)
+    objects[i] = pool_acquire(pool);
+  for (size_t i = 0; i < count; i++)
+    pool_release(pool, objects[i]);
+  TEST_ASSERT(pool_getLength(pool) > 0);
+
+  // Another thread reuses the objects of the pool, and returns its cache when exiting
+  pthread_t thread;
+  size_t length = pool_getLength(pool);
+  pthread_create(&thread, NULL, (void *(*)(void *))pool_acquire, pool);
+  void *object = 0;
+  pthread_join(thread, &object);
+  TEST_ASSERT_NOT_NULL(object);
+  TEST_ASSERT_EQUAL_UINT64(length - 1, pool_getLength(pool));
+  TEST_ASSERT_EQUAL_UINT64(count, pool->allocations);
+
+  free(object);
+  pool_free(pool);
+}
+
+void pool_test_keepsAtMostCapacityObjects() {
+  pool_t *pool = pool_create(64, 4);
+
+  void *objects[POOL_THREAD_CACHE_SIZE * 2];
+  size_t count = sizeof(objects) / sizeof(objects[0]);
+  for (size_t i = 0; i < count; i++)
+    objects[i] = pool_acquire(pool);
+  for (size_t i = 0; i < count; i++)
+    pool_release(pool, objects[i]);
+
+  TEST_ASSERT(pool_getLength(pool) <= 4);
+
+  pool_free(pool);
+}
+
+void pool_test_run() {
+  RUN_TEST(pool_test_canReuseObjects);
+  RUN_TEST(pool_test_canShareObjectsBetweenThreads);
+  RUN_TEST(pool_test_keepsAtMostCapacityObjects);
+}
@@ -1,7 +1,9 @@
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "unity/unity.h"
 
+#include "../src/resources/mime.h"
 #include "../src/resources/resources.h"
 
 void resources_test_canLoadFile() {
@@ -29,37 +31,82 @@ void resources_test_cannotLoadFileThatDoesNotExist() {
   string_free(path);
 }
 
+void resources_test_canOpenFile() {
+  char *realPath = realpath("test/resources-test.c", NULL);
+  string_t *path = string_fromBuffer(realPath);
+  free(realPath);
+  struct stat info;
+  int file = resources_openFile(path, &info);
+
+  TEST_ASSERT(file >= 0);
+  TEST_ASSERT(info.st_size > 0);
+
+  char buffer[19] = {0};
+  TEST_ASSERT_EQUAL_INT(18, read(file, buffer, 18));
+  TEST_ASSERT_EQUAL_STRING("#include <stdlib.h", buffer);
+
+  close(file);
+  string_free(path);
+}
+
+void resources_test_cannotOpenDirectory() {
+  string_t *path = string_fromBuffer("test");
+  struct stat info;
+  TEST_ASSERT_EQUAL_INT(-1, resources_openFile(path, &info));
+  string_free(path);
+
+  string_t *path1 = string_fromBuffer("test/filedoesnotexist.c");
+  TEST_ASSERT_EQUAL_INT(-1, resources_openFile(path1, &info));
+  string_free(path1);
+}
+
 void resources_test_canGetMIMEType() {
   string_t *path = string_fromBuffer("index.html");
-  string_t *result = resources_getMIMEType(path);
+  TEST_ASSERT_EQUAL_STRING("text/html", resources_getMIMEType(path));
+  string_free(path);
 
-  TEST_ASSERT_EQUAL_STRING("text/html", string_getBuffer(result));
+  // The extension is matched case insensitively
+  path = string_fromBuffer("/srv/www/IMAGE.PNG");
+  TEST_ASSERT_EQUAL_STRING("image/png", resources_getMIMEType(path));
+  string_free(path);
 
+  // Only the last extension is used
+  path = string_fromBuffer("index.tar.gz");
+  TEST_ASSERT_EQUAL_STRING("application/gzip", resources_getMIMEType(path));
   string_free(path);
-  string_free(result);
 }
 
 void resources_test_cannotGetInvalidMIMEType() {
   string_t *path = string_fromBuffer("index");
-  string_t *result = resources_getMIMEType(path);
-  TEST_ASSERT_NULL(result);
+  TEST_ASSERT_NULL(resources_getMIMEType(path));
   string_free(path);
-  if (result != 0)
-    string_free(result);
 
-  string_t *path1 = string_fromBuffer("index.mp4");
-  string_t *result1 = resources_getMIMEType(path1);
-  TEST_ASSERT_NULL(result1);
-  string_free(path1);
-  if (result1 != 0)
-    string_free(result1);
-
-  string_t *path2 = string_fromBuffer("index.tar.gz");
-  string_t *result2 = resources_getMIMEType(path2);
-  TEST_ASSERT_NULL(result2);
-  string_free(path2);
-  if (result2 != 0)
-    string_free(result2);
+  path = string_fromBuffer("index.mp4");
+  TEST_ASSERT_NULL(resources_getMIMEType(path));
+  string_free(path);
+
+  // Dots in directories are not extensions
+  path = string_fromBuffer("/srv/www.example/index");
+  TEST_ASSERT_NULL(resources_getMIMEType(path));
+  string_free(path);
+}
+
+void resources_test_canAddMIMEType() {
+  string_t *path = string_fromBuffer("module.wasm");
+  TEST_ASSERT_NULL(resources_getMIMEType(path));
+  TEST_ASSERT_TRUE(mime_addType(".wasm", "application/wasm"));
+  TEST_ASSERT_EQUAL_STRING("application/wasm", resources_getMIMEType(path));
+  string_free(path);
+}
+
+void resources_test_canCheckIfMIMETypeIsCompressible() {
+  TEST_ASSERT_TRUE(mime_isCompressible("text/html"));
+  TEST_ASSERT_TRUE(mime_isCompressible("application/javascript"));
+  TEST_ASSERT_TRUE(mime_isCompressible("image/svg+xml"));
+  TEST_ASSERT_TRUE(mime_isCompressible("application/ld+json"));
+  TEST_ASSERT_FALSE(mime_isCompressible("image/png"));
+  TEST_ASSERT_FALSE(mime_isCompressible("application/gzip"));
+  TEST_ASSERT_FALSE(mime_isCompressible("application/epub+zip"));
 }
 
 void resources_test_canIsExecutable() {
@@ -105,8 +152,12 @@ void resources_test_canIsFile() {
 void resources_test_run() {
   RUN_TEST(resources_test_canLoadFile);
   RUN_TEST(resources_test_cannotLoadFileThatDoesNotExist);
+  RUN_TEST(resources_test_canOpenFile);
+  RUN_TEST(resources_test_cannotOpenDirectory);
   RUN_TEST(resources_test_canGetMIMEType);
   RUN_TEST(resources_test_cannotGetInvalidMIMEType);
+  RUN_TEST(resources_test_canAddMIMEType);
+  RUN_TEST(resources_test_canCheckIfMIMETypeIsCompressible);
   RUN_TEST(resources_test_canIsExecutable);
   RUN_TEST(resources_test_canIsFile);
 }
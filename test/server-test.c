@@ -0,0 +1,88 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+
+#include "../src/server/server.h"
+
+// Connect a client to a port of the loopback interface, returning its socket and local port
+int server_test_connect(uint16_t port, uint16_t *localPort) {
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+
+  int client = socket(AF_INET, SOCK_STREAM, 0);
+  TEST_ASSERT_NOT_EQUAL(-1, client);
+  TEST_ASSERT_EQUAL_INT(0, connect(client, (struct sockaddr *)&address, sizeof(address)));
+
+  socklen_t addressLength = sizeof(address);
+  TEST_ASSERT_EQUAL_INT(0, getsockname(client, (struct sockaddr *)&address, &addressLength));
+  *localPort = ntohs(address.sin_port);
+  return client;
+}
+
+void server_test_canAcceptTheBacklog() {
+  // Listen on any free port
+  int listeningSocket = server_listen(0, 8, 0, 0);
+  TEST_ASSERT_NOT_EQUAL(0, listeningSocket);
+  struct sockaddr_in address;
+  socklen_t addressLength = sizeof(address);
+  TEST_ASSERT_EQUAL_INT(0, getsockname(listeningSocket, (struct sockaddr *)&address, &addressLength));
+  uint16_t port = ntohs(address.sin_port);
+
+  // Nothing to accept yet
+  struct sockaddr_storage peerAddress;
+  socklen_t peerAddressLength = sizeof(peerAddress);
+  TEST_ASSERT_EQUAL_INT(-1, server_acceptNextSocket(listeningSocket, &peerAddress, &peerAddressLength));
+  TEST_ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+
+  // A client resetting its connection while it waits in the backlog doesn't keep the ones after it from being accepted
+  uint16_t clientPorts[3];
+  int clients[3];
+  for (size_t i = 0; i < 3; i++)
+    clients[i] = server_test_connect(port, &clientPorts[i]);
+  struct linger reset = {1, 0};
+  TEST_ASSERT_EQUAL_INT(0, setsockopt(clients[1], SOL_SOCKET, SO_LINGER, &reset, sizeof(reset)));
+  close(clients[1]);
+
+  bool acceptedClients[3] = {false, false, false};
+  for (size_t i = 0; i < 3; i++) {
+    peerAddressLength = sizeof(peerAddress);
+    int socket = server_acceptNextSocket(listeningSocket, &peerAddress, &peerAddressLength);
+    if (socket == -1)
+      break;
+
+    // Accepted sockets are non-blocking and not inherited by CGI scripts
+    TEST_ASSERT_TRUE((fcntl(socket, F_GETFL) & O_NONBLOCK) != 0);
+    TEST_ASSERT_TRUE((fcntl(socket, F_GETFD) & FD_CLOEXEC) != 0);
+    TEST_ASSERT_EQUAL_INT(AF_INET, peerAddress.ss_family);
+    TEST_ASSERT_EQUAL_UINT(sizeof(struct sockaddr_in), peerAddressLength);
+
+    uint16_t peerPort = ntohs(((struct sockaddr_in *)&peerAddress)->sin_port);
+    for (size_t j = 0; j < 3; j++) {
+      if (clientPorts[j] == peerPort)
+        acceptedClients[j] = true;
+    }
+    close(socket);
+  }
+  TEST_ASSERT_TRUE(acceptedClients[0]);
+  TEST_ASSERT_TRUE(acceptedClients[2]);
+
+  // The backlog is empty again
+  peerAddressLength = sizeof(peerAddress);
+  TEST_ASSERT_EQUAL_INT(-1, server_acceptNextSocket(listeningSocket, &peerAddress, &peerAddressLength));
+  TEST_ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+
+  close(clients[0]);
+  close(clients[2]);
+  close(listeningSocket);
+}
+
+void server_test_run() {
+  RUN_TEST(server_test_canAcceptTheBacklog);
+}
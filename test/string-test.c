@@ -501,8 +501,102 @@ void string_test_canCopyStringToNothing() {
   // kopiera något till en tom sträng
 }
 
+void string_test_storesShortStringsInline() {
+  string_t *string = string_fromBuffer("GET");
+  TEST_ASSERT_EQUAL_PTR(string->inlineBuffer, string_getBuffer(string));
+
+  // Growing beyond the inline buffer moves the content to an allocated buffer
+  string_appendBuffer(string, " /a/path/longer/than/the/inline/buffer");
+  TEST_ASSERT(string_getBuffer(string) != string->inlineBuffer);
+  TEST_ASSERT_EQUAL_STRING("GET /a/path/longer/than/the/inline/buffer", string_getBuffer(string));
+
+  // Shrinking moves it back
+  string_setBufferSize(string, 3);
+  TEST_ASSERT_EQUAL_PTR(string->inlineBuffer, string_getBuffer(string));
+  TEST_ASSERT_EQUAL_STRING("GET", string_getBuffer(string));
+
+  string_free(string);
+}
+
+void string_test_canUseViews() {
+  string_t *string = string_fromBuffer("Content-Length: 42");
+  string_view_t view = string_getView(string);
+  TEST_ASSERT_EQUAL_UINT64(18, view.size);
+
+  ssize_t colon = string_view_findChar(view, 0, ':');
+  TEST_ASSERT_EQUAL_INT64(14, colon);
+  TEST_ASSERT_EQUAL_INT64(-1, string_view_findChar(view, colon + 1, ':'));
+
+  string_view_t key = string_view_substring(view, 0, colon);
+  TEST_ASSERT_TRUE(string_view_equalsBuffer(key, "Content-Length"));
+  TEST_ASSERT_FALSE(string_view_equalsBuffer(key, "Content"));
+  TEST_ASSERT_TRUE(string_view_startsWithBuffer(key, "Content"));
+  TEST_ASSERT_TRUE(string_view_equals(string_getSubview(string, 16, 18), string_view_fromBuffer("42")));
+
+  // Out of bounds views are empty
+  TEST_ASSERT_NULL(string_getSubview(string, 10, 19).buffer);
+
+  string_t *copy = string_fromView(key);
+  TEST_ASSERT_EQUAL_STRING("Content-Length", string_getBuffer(copy));
+
+  string_free(copy);
+  string_free(string);
+}
+
+void string_test_canFindCharAtAnyPosition() {
+  char buffer[100];
+  for (size_t size = 0; size <= sizeof(buffer); size++) {
+    for (size_t position = 0; position < size; position++) {
+      memset(buffer, 'a', sizeof(buffer));
+      buffer[position] = ':';
+      string_view_t view = {buffer, size};
+      TEST_ASSERT_EQUAL_INT64(position, string_view_findChar(view, 0, ':'));
+      TEST_ASSERT_EQUAL_INT64(position, string_view_findChar(view, position, ':'));
+      TEST_ASSERT_EQUAL_INT64(-1, string_view_findChar(view, position + 1, ':'));
+    }
+
+    // Matches beyond the size are ignored
+    memset(buffer, 'a', sizeof(buffer));
+    if (size < sizeof(buffer))
+      buffer[size] = ':';
+    string_view_t view = {buffer, size};
+    TEST_ASSERT_EQUAL_INT64(-1, string_view_findChar(view, 0, ':'));
+  }
+}
+
+void string_test_canCompareCaseInsensitive() {
+  const char *lower = "content-type: text/html; charset=utf-8 @[`{ \x80\xc1\xe1 content-length";
+  const char *upper = "CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8 @[`{ \x80\xc1\xe1 Content-Length";
+  size_t size = strlen(lower);
+
+  for (size_t i = 0; i <= size; i++) {
+    string_view_t view = {lower, i};
+    string_view_t view2 = {upper, i};
+    TEST_ASSERT_TRUE(string_view_equalsCaseInsensitive(view, view2));
+  }
+
+  // Only letters are folded - the characters next to them in ASCII are not
+  TEST_ASSERT_FALSE(string_view_equalsBufferCaseInsensitive(string_view_fromBuffer("@[`{"), "`{@["));
+  TEST_ASSERT_FALSE(string_view_equalsBufferCaseInsensitive(string_view_fromBuffer("\xc1"), "\xe1"));
+  // Differences at any position are found, including after null characters
+  char modified[100];
+  for (size_t i = 0; i < size; i++) {
+    memcpy(modified, upper, size);
+    modified[i] = '#';
+    TEST_ASSERT_FALSE(string_view_equalsCaseInsensitive((string_view_t){lower, size}, (string_view_t){modified, size}));
+  }
+  TEST_ASSERT_FALSE(string_view_equalsCaseInsensitive((string_view_t){"Host\0a", 6}, (string_view_t){"host\0b", 6}));
+
+  TEST_ASSERT_TRUE(string_view_equalsBufferCaseInsensitive(string_view_fromBuffer("Host"), "host"));
+  TEST_ASSERT_FALSE(string_view_equalsBufferCaseInsensitive(string_view_fromBuffer("Host"), "hosts"));
+}
+
 void string_test_run() {
   RUN_TEST(string_test_canCreateStringFromBuffer);
+  RUN_TEST(string_test_storesShortStringsInline);
+  RUN_TEST(string_test_canUseViews);
+  RUN_TEST(string_test_canFindCharAtAnyPosition);
+  RUN_TEST(string_test_canCompareCaseInsensitive);
   RUN_TEST(string_test_canCreateStringFromBufferWithLength);
   RUN_TEST(string_test_canClearString);
   RUN_TEST(string_test_canCreateStringFromPositiveInt);
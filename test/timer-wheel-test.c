@@ -0,0 +1,100 @@
+#include "unity/unity.h"
+
+#include "../src/datastructures/timer-wheel/timer-wheel.h"
+
+void timer_wheel_test_countExpiration(size_t *expirations) {
+  (*expirations)++;
+}
+
+void timer_wheel_test_canScheduleAndExpire() {
+  timer_wheel_t *wheel = timer_wheel_create(10, 0);
+  TEST_ASSERT_NOT_NULL(wheel);
+
+  size_t expirations = 0;
+  timer_wheel_entry_t entry;
+  timer_wheel_initializeEntry(&entry, (timer_wheel_callback_t)timer_wheel_test_countExpiration, &expirations);
+
+  timer_wheel_schedule(wheel, &entry, 50);
+  TEST_ASSERT_EQUAL_UINT64(1, timer_wheel_getLength(wheel));
+
+  TEST_ASSERT_EQUAL_UINT64(0, timer_wheel_advance(wheel, 49));
+  TEST_ASSERT_EQUAL_UINT64(0, expirations);
+
+  TEST_ASSERT_EQUAL_UINT64(1, timer_wheel_advance(wheel, 50));
+  TEST_ASSERT_EQUAL_UINT64(1, expirations);
+  TEST_ASSERT_EQUAL_UINT64(0, timer_wheel_getLength(wheel));
+
+  timer_wheel_free(wheel);
+}
+
+void timer_wheel_test_canCancel() {
+  timer_wheel_t *wheel = timer_wheel_create(10, 0);
+
+  size_t expirations = 0;
+  timer_wheel_entry_t entry;
+  timer_wheel_initializeEntry(&entry, (timer_wheel_callback_t)timer_wheel_test_countExpiration, &expirations);
+
+  timer_wheel_schedule(wheel, &entry, 50);
+  timer_wheel_cancel(wheel, &entry);
+  TEST_ASSERT_EQUAL_UINT64(0, timer_wheel_getLength(wheel));
+
+  timer_wheel_advance(wheel, 1000);
+  TEST_ASSERT_EQUAL_UINT64(0, expirations);
+
+  // Cancelling an entry that is not scheduled does nothing
+  timer_wheel_cancel(wheel, &entry);
+
+  timer_wheel_free(wheel);
+}
+
+void timer_wheel_test_canReschedule() {
+  timer_wheel_t *wheel = timer_wheel_create(10, 0);
+
+  size_t expirations = 0;
+  timer_wheel_entry_t entry;
+  timer_wheel_initializeEntry(&entry, (timer_wheel_callback_t)timer_wheel_test_countExpiration, &expirations);
+
+  timer_wheel_schedule(wheel, &entry, 50);
+  timer_wheel_schedule(wheel, &entry, 100000);
+  TEST_ASSERT_EQUAL_UINT64(1, timer_wheel_getLength(wheel));
+
+  timer_wheel_advance(wheel, 99990);
+  TEST_ASSERT_EQUAL_UINT64(0, expirations);
+  timer_wheel_advance(wheel, 100000);
+  TEST_ASSERT_EQUAL_UINT64(1, expirations);
+
+  timer_wheel_free(wheel);
+}
+
+void timer_wheel_test_canExpireEntriesOnAllLevels() {
+  timer_wheel_t *wheel = timer_wheel_create(1, 7);
+
+  // Spread entries over every level of the wheel, including the boundaries between them
+  uint64_t expires[] = {8, 70, 71, 4103, 4104, 5000, 262151, 300000, 16777000};
+  size_t entries = sizeof(expires) / sizeof(expires[0]);
+  size_t expirations[sizeof(expires) / sizeof(expires[0])];
+  timer_wheel_entry_t timers[sizeof(expires) / sizeof(expires[0])];
+  for (size_t i = 0; i < entries; i++) {
+    expirations[i] = 0;
+    timer_wheel_initializeEntry(&timers[i], (timer_wheel_callback_t)timer_wheel_test_countExpiration, &expirations[i]);
+    timer_wheel_schedule(wheel, &timers[i], expires[i]);
+  }
+
+  // Each entry expires exactly at its tick
+  for (size_t i = 0; i < entries; i++) {
+    timer_wheel_advance(wheel, expires[i] - 1);
+    TEST_ASSERT_EQUAL_UINT64(0, expirations[i]);
+    timer_wheel_advance(wheel, expires[i]);
+    TEST_ASSERT_EQUAL_UINT64(1, expirations[i]);
+  }
+
+  TEST_ASSERT_EQUAL_UINT64(0, timer_wheel_getLength(wheel));
+  timer_wheel_free(wheel);
+}
+
+void timer_wheel_test_run() {
+  RUN_TEST(timer_wheel_test_canScheduleAndExpire);
+  RUN_TEST(timer_wheel_test_canCancel);
+  RUN_TEST(timer_wheel_test_canReschedule);
+  RUN_TEST(timer_wheel_test_canExpireEntriesOnAllLevels);
+}
@@ -0,0 +1,102 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+
+#include "../src/uring/uring.h"
+
+void uring_test_canAcceptConnections() {
+  uring_t *ring = uring_create(8);
+  // Kernels without io_uring (or with it disabled) use poll instead
+  if (ring == 0)
+    TEST_IGNORE_MESSAGE("io_uring is not supported");
+
+  // Listen on any free port of the loopback interface
+  int listeningSocket = socket(AF_INET, SOCK_STREAM, 0);
+  TEST_ASSERT_NOT_EQUAL(-1, listeningSocket);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addressLength = sizeof(address);
+  TEST_ASSERT_EQUAL_INT(0, bind(listeningSocket, (struct sockaddr *)&address, addressLength));
+  TEST_ASSERT_EQUAL_INT(0, listen(listeningSocket, 8));
+  TEST_ASSERT_EQUAL_INT(0, getsockname(listeningSocket, (struct sockaddr *)&address, &addressLength));
+
+  TEST_ASSERT_TRUE(uring_acceptMultishot(ring, listeningSocket, 42, SOCK_NONBLOCK | SOCK_CLOEXEC));
+  // Nothing to accept yet
+  TEST_ASSERT_EQUAL_INT(0, uring_wait(ring, 10));
+
+  int clients[2];
+  for (size_t i = 0; i < 2; i++) {
+    clients[i] = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL_INT(0, connect(clients[i], (struct sockaddr *)&address, addressLength));
+  }
+
+  // One accept produces a completion per connection
+  size_t acceptedSockets = 0;
+  for (size_t i = 0; i < 10 && acceptedSockets < 2; i++) {
+    if (uring_wait(ring, 100) < 0)
+      break;
+
+    uring_completion_t completion;
+    while (uring_getCompletion(ring, &completion)) {
+      // Multishot accepts are not supported before Linux 5.19
+      if (completion.result == -EINVAL) {
+        uring_free(ring);
+        close(listeningSocket);
+        TEST_IGNORE_MESSAGE("Multishot accepts are not supported");
+      }
+
+      TEST_ASSERT_EQUAL_UINT64(42, completion.userData);
+      TEST_ASSERT_TRUE(completion.result >= 0);
+      TEST_ASSERT_TRUE(completion.hasMore);
+      TEST_ASSERT_TRUE((fcntl(completion.result, F_GETFL) & O_NONBLOCK) != 0);
+      close(completion.result);
+      acceptedSockets++;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT64(2, acceptedSockets);
+
+  for (size_t i = 0; i < 2; i++)
+    close(clients[i]);
+  uring_free(ring);
+  close(listeningSocket);
+}
+
+void uring_test_canPollSockets() {
+  uring_t *ring = uring_create(8);
+  if (ring == 0)
+    TEST_IGNORE_MESSAGE("io_uring is not supported");
+
+  int sockets[2];
+  TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+  TEST_ASSERT_TRUE(uring_pollAdd(ring, sockets[0], POLLIN, 7));
+  TEST_ASSERT_TRUE(uring_submit(ring));
+  // Nothing to read yet
+  TEST_ASSERT_EQUAL_INT(0, uring_wait(ring, 10));
+
+  TEST_ASSERT_EQUAL_INT(1, write(sockets[1], "x", 1));
+  TEST_ASSERT_EQUAL_INT(1, uring_wait(ring, 100));
+
+  uring_completion_t completion;
+  TEST_ASSERT_TRUE(uring_getCompletion(ring, &completion));
+  TEST_ASSERT_EQUAL_UINT64(7, completion.userData);
+  TEST_ASSERT_TRUE((completion.result & POLLIN) != 0);
+  TEST_ASSERT_FALSE(completion.hasMore);
+  TEST_ASSERT_FALSE(uring_getCompletion(ring, &completion));
+
+  close(sockets[0]);
+  close(sockets[1]);
+  uring_free(ring);
+}
+
+void uring_test_run() {
+  RUN_TEST(uring_test_canAcceptConnections);
+  RUN_TEST(uring_test_canPollSockets);
+}
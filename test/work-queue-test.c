@@ -0,0 +1,118 @@
+#include <unistd.h>
+
+#include "unity/unity.h"
+
+#include "../src/datastructures/work-queue/work-queue.h"
+
+void *work_queue_test_popFirstOwner(work_queue_t *queue) {
+  return work_queue_pop(queue, 0);
+}
+
+void work_queue_test_canPushAndSteal() {
+  work_queue_t *queue = work_queue_create(3);
+  TEST_ASSERT_NOT_NULL(queue);
+  for (size_t i = 0; i < 3; i++)
+    work_queue_open(queue, i);
+
+  int value0 = 10;
+  int value1 = 20;
+
+  // With every owner busy, values are pushed to the owner hinted at
+  TEST_ASSERT_TRUE(work_queue_push(queue, &value0, 4));
+  TEST_ASSERT_TRUE(work_queue_push(queue, &value1, 4));
+  TEST_ASSERT_EQUAL_UINT64(2, queue->deques[1].length);
+  TEST_ASSERT_EQUAL_UINT64(2, work_queue_getLength(queue));
+
+  // Owners take their own values first, oldest first, and steal from others once they have none
+  TEST_ASSERT_EQUAL_PTR(&value0, work_queue_pop(queue, 1));
+  TEST_ASSERT_EQUAL_PTR(&value1, work_queue_pop(queue, 2));
+  TEST_ASSERT_EQUAL_UINT64(1, work_queue_getSteals(queue));
+  TEST_ASSERT_EQUAL_UINT64(0, work_queue_getLength(queue));
+
+  work_queue_free(queue);
+}
+
+void work_queue_test_canMoveValuesWhenClosed() {
+  work_queue_t *queue = work_queue_create(2);
+  TEST_ASSERT_NOT_NULL(queue);
+  work_queue_open(queue, 0);
+  work_queue_open(queue, 1);
+
+  int values[WORK_QUEUE_INITIAL_CAPACITY + 1];
+  for (size_t i = 0; i < WORK_QUEUE_INITIAL_CAPACITY + 1; i++)
+    TEST_ASSERT_TRUE(work_queue_push(queue, &values[i], 0));
+  TEST_ASSERT_EQUAL_UINT64(WORK_QUEUE_INITIAL_CAPACITY + 1, queue->deques[0].length);
+
+  // Values left in a closed deque are moved, and values hinted at it are pushed to open ones
+  work_queue_close(queue, 0);
+  TEST_ASSERT_EQUAL_UINT64(0, queue->deques[0].length);
+  TEST_ASSERT_TRUE(work_queue_push(queue, &values[0], 0));
+  TEST_ASSERT_EQUAL_UINT64(WORK_QUEUE_INITIAL_CAPACITY + 2, queue->deques[1].length);
+
+  for (size_t i = 0; i < WORK_QUEUE_INITIAL_CAPACITY + 1; i++)
+    TEST_ASSERT_EQUAL_PTR(&values[i], work_queue_pop(queue, 1));
+  TEST_ASSERT_EQUAL_PTR(&values[0], work_queue_pop(queue, 1));
+  TEST_ASSERT_EQUAL_UINT64(0, work_queue_getSteals(queue));
+
+  work_queue_free(queue);
+}
+
+void work_queue_test_canTakeValuesLeftWhenUnlocked() {
+  work_queue_t *queue = work_queue_create(2);
+  TEST_ASSERT_NOT_NULL(queue);
+  work_queue_open(queue, 0);
+  work_queue_open(queue, 1);
+
+  int values[3];
+  TEST_ASSERT_TRUE(work_queue_push(queue, &values[0], 0));
+  TEST_ASSERT_TRUE(work_queue_push(queue, &values[1], 1));
+  TEST_ASSERT_TRUE(work_queue_push(queue, &values[2], 1));
+
+  // Owners no longer pop values once unlocked, but they can still be taken to be freed
+  work_queue_unlock(queue);
+  TEST_ASSERT_NULL(work_queue_pop(queue, 0));
+  TEST_ASSERT_EQUAL_PTR(&values[0], work_queue_takeAny(queue));
+  TEST_ASSERT_EQUAL_PTR(&values[1], work_queue_takeAny(queue));
+  TEST_ASSERT_EQUAL_PTR(&values[2], work_queue_takeAny(queue));
+  TEST_ASSERT_NULL(work_queue_takeAny(queue));
+  TEST_ASSERT_EQUAL_UINT64(0, work_queue_getLength(queue));
+
+  work_queue_free(queue);
+}
+
+void work_queue_test_canWakeWaitingOwners() {
+  work_queue_t *queue = work_queue_create(2);
+  TEST_ASSERT_NOT_NULL(queue);
+  work_queue_open(queue, 0);
+  work_queue_open(queue, 1);
+
+  pthread_t thread;
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, (void *(*)(void *))work_queue_test_popFirstOwner, queue));
+  while (!__atomic_load_n(&queue->deques[0].isWaiting, __ATOMIC_SEQ_CST))
+    usleep(1000);
+
+  // A waiting owner is preferred over the busy owner hinted at
+  int value = 10;
+  TEST_ASSERT_TRUE(work_queue_push(queue, &value, 1));
+  int *result = 0;
+  pthread_join(thread, (void **)&result);
+  TEST_ASSERT_EQUAL_PTR(&value, result);
+
+  // Unlocking wakes waiting owners without a value
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, (void *(*)(void *))work_queue_test_popFirstOwner, queue));
+  while (!__atomic_load_n(&queue->deques[0].isWaiting, __ATOMIC_SEQ_CST))
+    usleep(1000);
+  work_queue_unlock(queue);
+  pthread_join(thread, (void **)&result);
+  TEST_ASSERT_NULL(result);
+  TEST_ASSERT_NULL(work_queue_pop(queue, 1));
+
+  work_queue_free(queue);
+}
+
+void work_queue_test_run() {
+  RUN_TEST(work_queue_test_canPushAndSteal);
+  RUN_TEST(work_queue_test_canMoveValuesWhenClosed);
+  RUN_TEST(work_queue_test_canTakeValuesLeftWhenUnlocked);
+  RUN_TEST(work_queue_test_canWakeWaitingOwners);
+}